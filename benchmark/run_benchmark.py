@@ -0,0 +1,250 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2009-2013, The University of British Columbia
+# All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 
+# Redistributions of source code must retain the above copyright notice, this
+# list of conditions and the following disclaimer.
+# Redistributions in binary form must reproduce the above copyright notice, this
+# list of conditions and the following disclaimer in the documentation and/or
+# other materials provided with the distribution.
+# Neither the name of The University of British Columbia nor the names of its
+# contributors may be used to endorse or promote products derived from this
+# software without specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+# SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+# CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+# OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Simulator throughput benchmark. Runs every kernel of the suite (kernels/, 
+# launched by simbench) on every selected configuration from configs/ and 
+# reports how fast the simulator itself ran: simulated instructions and 
+# cycles per host second, the peak resident set size of the process and the 
+# share of host time spent in each subsystem (from -gpgpu_self_profile).
+#
+#   run_benchmark.py [options]      see --help
+#
+# Each run gets its own directory under --dir holding a copy of the 
+# configuration, with the options below appended to gpgpusim.config, and 
+# the simulator output (sim.log). Inputs and launch sizes are fixed, so the 
+# simulated instruction and cycle counts and the checksum only change when 
+# the model changes. -o saves the results as JSON; -b compares against such 
+# a file and exits with status 1 when a run got slower than --threshold.
+
+import json
+import optparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+
+# name: (n, iters, ctas, threads per cta)
+SUITE = [
+    ('compute',   (8192,      128, 32, 256)),
+    ('memory',    (1 << 20,    64, 32, 256)),
+    ('divergent', (8192,      128, 32, 256)),
+    ('atomic',    (8192,       32, 32, 256)),
+    ('texture',   (1 << 16,    64, 32, 256)),
+]
+
+DEFAULT_CONFIGS = ['GTX480', 'QuadroFX5800']
+
+OVERRIDES = [
+    '-gpgpu_ptx_use_cuobjdump 0',        # simbench registers plain PTX
+    '-gpgpu_ptx_force_max_capability 0',
+    '-gpgpu_self_profile 1',
+    '-visualizer_enabled 0',
+]
+
+BENCH_DIR = os.path.dirname(os.path.abspath(__file__))
+CONFIG_DIR = os.path.join(BENCH_DIR, '..', 'configs')
+
+def prepare(rundir, config, power):
+    if os.path.isdir(rundir):
+        shutil.rmtree(rundir)
+    os.makedirs(rundir)
+    src = os.path.join(CONFIG_DIR, config)
+    for f in os.listdir(src):
+        if os.path.isfile(os.path.join(src, f)):
+            shutil.copy(os.path.join(src, f), rundir)
+    cfg = open(os.path.join(rundir, 'gpgpusim.config'), 'a')
+    cfg.write('\n# appended by run_benchmark.py\n')
+    for o in OVERRIDES + ([] if power else ['-power_simulation_enabled 0']):
+        cfg.write(o + '\n')
+    cfg.close()
+
+def parse_log(filename):
+    r = {'insn': None, 'cycles': None, 'checksum': None, 'profile': []}
+    in_profile = False
+    for line in open(filename):
+        m = re.match(r'gpu_tot_sim_insn = (\d+)', line)
+        if m:
+            r['insn'] = int(m.group(1))
+        m = re.match(r'gpu_tot_sim_cycle = (\d+)', line)
+        if m:
+            r['cycles'] = int(m.group(1))
+        m = re.match(r'simbench: .* checksum=(\w+)', line)
+        if m:
+            r['checksum'] = m.group(1)
+        if line.startswith('GPGPU-Sim: self profile'):
+            in_profile = True
+            r['profile'] = []
+            continue
+        if in_profile:
+            # zone names contain spaces; the seconds column follows them
+            m = re.match(r'(.+?)\s+(\d+\.\d+)(\s|$)', line)
+            if line.startswith('zone'):
+                continue
+            if not m or m.group(1) == 'total':
+                in_profile = False
+                continue
+            r['profile'].append((m.group(1), float(m.group(2))))
+    return r
+
+def run_one(simbench, kernel, params, rundir):
+    ptx = os.path.join(BENCH_DIR, 'kernels', kernel + '.ptx')
+    cmd = [simbench, ptx] + [str(p) for p in params]
+    log = open(os.path.join(rundir, 'sim.log'), 'w')
+    start = time.time()
+    p = subprocess.Popen(cmd, cwd=rundir, stdout=log, stderr=subprocess.STDOUT)
+    _, status, rusage = os.wait4(p.pid, 0)
+    wall = time.time() - start
+    log.close()
+    if status != 0:
+        sys.exit('%s failed (status %d), see %s' % (' '.join(cmd), status, 
+                 os.path.join(rundir, 'sim.log')))
+    r = parse_log(os.path.join(rundir, 'sim.log'))
+    if r['insn'] is None or r['checksum'] is None:
+        sys.exit('%s: no statistics in %s' % (kernel, os.path.join(rundir, 'sim.log')))
+    r['wall'] = wall
+    r['maxrss_mb'] = rusage.ru_maxrss / 1024.0  # kilobytes on Linux
+    return r
+
+def rate(count, seconds):
+    return count / seconds if seconds > 0 else 0.0
+
+def print_results(results):
+    print('%-14s %-10s %12s %10s %8s %11s %10s %8s %10s' % ('config', 'kernel', 
+          'sim insn', 'sim cycles', 'host s', 'insn/s', 'cycle/s', 'RSS MB', 'checksum'))
+    for r in results:
+        print('%-14s %-10s %12d %10d %8.2f %11.0f %10.0f %8.1f %10s' % (r['config'], 
+              r['kernel'], r['insn'], r['cycles'], r['wall'], r['insn_per_sec'], 
+              r['cycles_per_sec'], r['maxrss_mb'], r['checksum']))
+    zones = []
+    for r in results:
+        for z, _ in r['profile']:
+            if z not in zones:
+                zones.append(z)
+    if not zones:
+        return
+    print('')
+    print('host time per subsystem (%):')
+    for i, z in enumerate(zones):
+        print('  [%d] %s' % (i, z))
+    print('%-14s %-10s ' % ('config', 'kernel') + ''.join('%6s' % ('[%d]' % i) for i in range(len(zones))))
+    for r in results:
+        t = dict(r['profile'])
+        total = sum(t.values())
+        print('%-14s %-10s ' % (r['config'], r['kernel']) + 
+              ''.join('%6.1f' % (100.0 * t.get(z, 0.0) / total if total else 0.0) for z in zones))
+
+def compare(results, baseline, threshold):
+    base = dict(((b['config'], b['kernel']), b) for b in baseline)
+    regressed = False
+    print('')
+    print('compared with the baseline (insn/s):')
+    for r in results:
+        b = base.get((r['config'], r['kernel']))
+        if b is None:
+            print('%-14s %-10s  not in the baseline' % (r['config'], r['kernel']))
+            continue
+        speedup = rate(r['insn_per_sec'], b['insn_per_sec'])
+        notes = []
+        if speedup < 1.0 - threshold / 100.0:
+            notes.append('REGRESSION')
+            regressed = True
+        if r['insn'] != b['insn'] or r['cycles'] != b['cycles'] or r['checksum'] != b['checksum']:
+            notes.append('simulated result changed (cycles %d -> %d)' % (b['cycles'], r['cycles']))
+        print('%-14s %-10s %6.3fx  %s' % (r['config'], r['kernel'], speedup, ' '.join(notes)))
+    return regressed
+
+def main():
+    parser = optparse.OptionParser(usage='%prog [options]')
+    parser.add_option('-c', '--configs', default=','.join(DEFAULT_CONFIGS),
+                      help='comma separated directories of configs/ [%default]')
+    parser.add_option('-k', '--kernels', default=','.join(k for k, _ in SUITE),
+                      help='comma separated kernels of the suite [%default]')
+    parser.add_option('-s', '--scale', type='int', default=1,
+                      help='multiply the iteration count of every kernel by this')
+    parser.add_option('-r', '--repeat', type='int', default=1,
+                      help='run each benchmark this many times and keep the fastest')
+    parser.add_option('-d', '--dir', default='runs', help='directory for the runs [%default]')
+    parser.add_option('-o', '--output', help='save the results to this JSON file')
+    parser.add_option('-b', '--baseline', help='compare against results saved with -o')
+    parser.add_option('-t', '--threshold', type='float', default=5.0,
+                      help='insn/s loss (in percent) reported as a regression [%default]')
+    parser.add_option('--power', action='store_true', default=False,
+                      help='keep the power model of the configuration enabled')
+    parser.add_option('--simbench', default=os.path.join(BENCH_DIR, 'simbench'),
+                      help='simbench executable [%default]')
+    opts, args = parser.parse_args()
+    if args:
+        parser.error('unexpected arguments')
+    if not os.access(opts.simbench, os.X_OK):
+        sys.exit('%s not found, run make in %s first' % (opts.simbench, BENCH_DIR))
+    suite = dict(SUITE)
+    kernels = opts.kernels.split(',')
+    for k in kernels:
+        if k not in suite:
+            sys.exit('unknown kernel %s' % k)
+    configs = opts.configs.split(',')
+    for c in configs:
+        if not os.path.isfile(os.path.join(CONFIG_DIR, c, 'gpgpusim.config')):
+            sys.exit('unknown configuration %s' % c)
+
+    results = []
+    for config in configs:
+        for kernel in kernels:
+            n, iters, ctas, threads = suite[kernel]
+            params = (n, iters * opts.scale, ctas, threads)
+            rundir = os.path.abspath(os.path.join(opts.dir, config, kernel))
+            best = None
+            maxrss = 0.0
+            for i in range(opts.repeat):
+                prepare(rundir, config, opts.power)
+                r = run_one(opts.simbench, kernel, params, rundir)
+                maxrss = max(maxrss, r['maxrss_mb'])
+                if best is None or r['wall'] < best['wall']:
+                    best = r
+            best['maxrss_mb'] = maxrss
+            best['config'] = config
+            best['kernel'] = kernel
+            best['params'] = list(params)
+            best['insn_per_sec'] = rate(best['insn'], best['wall'])
+            best['cycles_per_sec'] = rate(best['cycles'], best['wall'])
+            results.append(best)
+            sys.stderr.write('%s/%s: %.2f s\n' % (config, kernel, best['wall']))
+
+    print_results(results)
+    if opts.output:
+        f = open(opts.output, 'w')
+        json.dump(results, f, indent=1)
+        f.close()
+    if opts.baseline:
+        if compare(results, json.load(open(opts.baseline)), opts.threshold):
+            sys.exit(1)
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,179 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Host side of the simulator throughput benchmark (see run_benchmark.py).
+// Loads the PTX of one kernel from kernels/ and registers it with the 
+// simulator's CUDA runtime the way the stub code nvcc generates registers an 
+// embedded fat binary, so the suite builds with the host compiler alone.
+//
+//   simbench <kernel.ptx> <n> <iters> <ctas> <threads per cta>
+//
+// Every kernel takes (u32 *a, u32 *b, u32 n, u32 iters). 'a' holds n 
+// deterministic pseudo random words and is also bound to the 1D texture 
+// bench_tex when the PTX declares it, 'b' holds n zeroed words. The sum of 
+// 'b' after the launch is printed as a checksum so runs can be compared.
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <cuda_runtime_api.h>
+#include "__cudaFatFormat.h"
+
+extern "C" {
+void** __cudaRegisterFatBinary( void *fatCubin );
+void __cudaRegisterFunction( void **fatCubinHandle, const char *hostFun, char *deviceFun, 
+                             const char *deviceName, int thread_limit, uint3 *tid, 
+                             uint3 *bid, dim3 *bDim, dim3 *gDim );
+void __cudaRegisterTexture( void **fatCubinHandle, const struct textureReference *hostVar, 
+                            const void **deviceAddress, const char *deviceName, 
+                            int dim, int norm, int ext );
+}
+
+// stands in for the host stub of the kernel; only its address is used
+static char bench_kernel_stub;
+static struct textureReference bench_texref;
+
+static void check( cudaError_t err, const char *what )
+{
+   if( err != cudaSuccess ) {
+      printf("simbench: ERROR ** %s failed (%d)\n", what, (int)err);
+      exit(1);
+   }
+}
+
+static std::string read_file( const char *filename )
+{
+   FILE *fp = fopen(filename, "r");
+   if( fp == NULL ) {
+      printf("simbench: ERROR ** could not open %s\n", filename);
+      exit(1);
+   }
+   std::string text;
+   char buf[4096];
+   size_t n;
+   while( (n = fread(buf, 1, sizeof(buf), fp)) > 0 ) 
+      text.append(buf, n);
+   fclose(fp);
+   return text;
+}
+
+// name of the first .entry in the PTX
+static std::string entry_name( const std::string &ptx )
+{
+   size_t pos = ptx.find(".entry");
+   if( pos == std::string::npos ) 
+      return "";
+   pos += strlen(".entry");
+   while( pos < ptx.size() && isspace(ptx[pos]) ) 
+      pos++;
+   size_t end = pos;
+   while( end < ptx.size() && (isalnum(ptx[end]) || ptx[end] == '_') ) 
+      end++;
+   return ptx.substr(pos, end - pos);
+}
+
+int main( int argc, char **argv )
+{
+   if( argc != 6 ) {
+      printf("usage: simbench <kernel.ptx> <n> <iters> <ctas> <threads per cta>\n");
+      return 1;
+   }
+   std::string ptx = read_file(argv[1]);
+   unsigned n = strtoul(argv[2], NULL, 0);
+   unsigned iters = strtoul(argv[3], NULL, 0);
+   unsigned ctas = strtoul(argv[4], NULL, 0);
+   unsigned threads = strtoul(argv[5], NULL, 0);
+   std::string entry = entry_name(ptx);
+   if( entry.empty() || n == 0 || ctas == 0 || threads == 0 ) {
+      printf("simbench: ERROR ** no .entry in %s or empty launch\n", argv[1]);
+      return 1;
+   }
+
+   __cudaFatPtxEntry ptx_entries[2];
+   ptx_entries[0].gpuProfileName = (char*)"compute_20";
+   ptx_entries[0].ptx = (char*)ptx.c_str();
+   ptx_entries[1].gpuProfileName = NULL;
+   ptx_entries[1].ptx = NULL;
+   __cudaFatCudaBinary fatbin;
+   memset(&fatbin, 0, sizeof(fatbin));
+   fatbin.magic = __cudaFatMAGIC;
+   fatbin.version = __cudaFatVERSION;
+   fatbin.ident = (char*)argv[1];
+   fatbin.ptx = ptx_entries;
+
+   void **handle = __cudaRegisterFatBinary(&fatbin);
+   __cudaRegisterFunction(handle, &bench_kernel_stub, (char*)entry.c_str(), entry.c_str(), 
+                          -1, NULL, NULL, NULL, NULL);
+   bool textured = ptx.find("bench_tex") != std::string::npos;
+   if( textured ) 
+      __cudaRegisterTexture(handle, &bench_texref, NULL, "bench_tex", 1, 0, 0);
+
+   std::vector<unsigned> host(n);
+   unsigned x = 12345;
+   for( unsigned i=0; i < n; i++ ) {
+      x = x * 1103515245 + 12345;
+      host[i] = x >> 8;
+   }
+   unsigned *a, *b;
+   size_t bytes = (size_t)n * sizeof(unsigned);
+   check(cudaMalloc((void**)&a, bytes), "cudaMalloc");
+   check(cudaMalloc((void**)&b, bytes), "cudaMalloc");
+   check(cudaMemcpy(a, &host[0], bytes, cudaMemcpyHostToDevice), "cudaMemcpy");
+   check(cudaMemset(b, 0, bytes), "cudaMemset");
+   if( textured ) {
+      struct cudaChannelFormatDesc desc;
+      memset(&desc, 0, sizeof(desc));
+      desc.x = 32;
+      desc.f = cudaChannelFormatKindUnsigned;
+      bench_texref.channelDesc = desc;
+      size_t offset = 0;
+      check(cudaBindTexture(&offset, &bench_texref, a, &desc, bytes), "cudaBindTexture");
+   }
+
+   check(cudaConfigureCall(dim3(ctas), dim3(threads), 0, 0), "cudaConfigureCall");
+   unsigned long long pa = (unsigned long long)(size_t)a;
+   unsigned long long pb = (unsigned long long)(size_t)b;
+   check(cudaSetupArgument(&pa, sizeof(pa), 0), "cudaSetupArgument");
+   check(cudaSetupArgument(&pb, sizeof(pb), 8), "cudaSetupArgument");
+   check(cudaSetupArgument(&n, sizeof(n), 16), "cudaSetupArgument");
+   check(cudaSetupArgument(&iters, sizeof(iters), 20), "cudaSetupArgument");
+   check(cudaLaunch(&bench_kernel_stub), "cudaLaunch");
+   check(cudaThreadSynchronize(), "cudaThreadSynchronize");
+
+   check(cudaMemcpy(&host[0], b, bytes, cudaMemcpyDeviceToHost), "cudaMemcpy");
+   unsigned checksum = 0;
+   for( unsigned i=0; i < n; i++ ) 
+      checksum += host[i];
+   printf("simbench: %s n=%u iters=%u grid=%u block=%u checksum=0x%08x\n", 
+          entry.c_str(), n, iters, ctas, threads, checksum);
+   return 0;
+}
@@ -0,0 +1,89 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2009-2013, The University of British Columbia
+# All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 
+# Redistributions of source code must retain the above copyright notice, this
+# list of conditions and the following disclaimer.
+# Redistributions in binary form must reproduce the above copyright notice, this
+# list of conditions and the following disclaimer in the documentation and/or
+# other materials provided with the distribution.
+# Neither the name of The University of British Columbia nor the names of its
+# contributors may be used to endorse or promote products derived from this
+# software without specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+# SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+# CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+# OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Reads the statistics written by -gpgpu_stat_dump (binary format, see 
+# src/gpgpu-sim/stat_registry.h).
+#
+#   stat_dump.py <dump>           print the records as JSON, one per line
+#   stat_dump.py <dump> <dump>    print the stats that differ between two 
+#                                 runs, record by record
+
+import json
+import struct
+import sys
+
+def read_string(f):
+    (n,) = struct.unpack('=H', f.read(2))
+    return f.read(n).decode('latin-1')
+
+def read_dump(filename):
+    """Returns the list of records; each is (kind, cycle, label, {name: value})"""
+    f = open(filename, 'rb')
+    magic, version, n_stats = struct.unpack('=III', f.read(12))
+    if magic != 0x54535047 or version != 1:
+        sys.exit('%s: not a version 1 GPGPU-Sim statistics dump' % filename)
+    stats = []
+    for i in range(n_stats):
+        t = f.read(1).decode('latin-1')
+        (n,) = struct.unpack('=I', f.read(4))
+        stats.append((read_string(f), {'u': 'Q', 'i': 'q', 'f': 'd'}[t], n))
+    records = []
+    while True:
+        kind = f.read(1)
+        if not kind:
+            break
+        (cycle,) = struct.unpack('=Q', f.read(8))
+        label = read_string(f)
+        values = {}
+        for name, fmt, n in stats:
+            v = struct.unpack('=%d%s' % (n, fmt), f.read(8 * n))
+            if fmt == 'd':  # like the JSON format: null for inf and nan
+                v = [x if x - x == 0 else None for x in v]
+            values[name] = v[0] if n == 1 else list(v)
+        records.append((kind.decode('latin-1'), cycle, label, values))
+    return records
+
+def kind_name(kind):
+    return 'kernel' if kind == 'K' else 'sample'
+
+if len(sys.argv) == 2:
+    for kind, cycle, label, values in read_dump(sys.argv[1]):
+        print(json.dumps({'kind': kind_name(kind), 'cycle': cycle, 'label': label, 'stats': values}))
+elif len(sys.argv) == 3:
+    a = read_dump(sys.argv[1])
+    b = read_dump(sys.argv[2])
+    if len(a) != len(b):
+        print('number of records differs: %d vs %d' % (len(a), len(b)))
+    for i, (ra, rb) in enumerate(zip(a, b)):
+        for name in sorted(set(ra[3]) | set(rb[3])):
+            va = ra[3].get(name)
+            vb = rb[3].get(name)
+            if va != vb:
+                print('%d %s %s: %s -> %s' % (i, kind_name(ra[0]), name, va, vb))
+else:
+    sys.exit('usage: %s <dump> [<dump to compare with>]' % sys.argv[0])
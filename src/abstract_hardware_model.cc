@@ -72,6 +72,14 @@ void gpgpu_functional_sim_config::reg_options(class OptionParser * opp)
                  &m_ptx_force_max_capability,
                  "Force maximum compute capability",
                  "0");
+    option_parser_register(opp, "-gpgpu_ptx_warp_exec", OPT_BOOL,
+                 &m_ptx_warp_exec,
+                 "Execute simple ALU instructions for a whole warp at once in the functional model",
+                 "1");
+    option_parser_register(opp, "-gpgpu_ptx_mmap_global_mem", OPT_BOOL,
+                 &m_ptx_mmap_global_mem,
+                 "Keep global memory in one lazily committed mmap of the address space instead of a hash map of blocks",
+                 "0");
    option_parser_register(opp, "-gpgpu_ptx_inst_debug_to_file", OPT_BOOL, 
                 &g_ptx_inst_debug_to_file, 
                 "Dump executed instructions' debug information to file", 
@@ -92,11 +100,23 @@ void gpgpu_functional_sim_config::ptx_set_tex_cache_linesize(unsigned linesize)
 gpgpu_t::gpgpu_t( const gpgpu_functional_sim_config &config )
     : m_function_model_config(config)
 {
-   m_global_mem = new memory_space_impl<8192>("global",64*1024);
+   m_global_mem = NULL;
+   if( m_function_model_config.mmap_global_mem() ) {
+      memory_space_mmap *global_mem = new memory_space_mmap("global");
+      if( global_mem->mapped() ) {
+         m_global_mem = global_mem;
+      } else {
+         printf("GPGPU-Sim PTX: WARNING ** could not reserve the global address space with mmap, using a hash map\n");
+         delete global_mem;
+      }
+   }
+   if( m_global_mem == NULL ) 
+      m_global_mem = new memory_space_impl<8192>("global",64*1024);
    m_tex_mem = new memory_space_impl<8192>("tex",64*1024);
    m_surf_mem = new memory_space_impl<8192>("surf",64*1024);
 
    m_dev_malloc=GLOBAL_HEAP_START; 
+   m_skipped_kernel=0;
 
    if(m_function_model_config.get_ptx_inst_debug_to_file() != 0) 
       ptx_inst_debug_file = fopen(m_function_model_config.get_ptx_inst_debug_file(), "w");
@@ -786,6 +806,23 @@ void simt_stack::update( simt_mask_t &thread_done, addr_vector_t &next_pc, addre
 
 void core_t::execute_warp_inst_t(warp_inst_t &inst, unsigned warpId)
 {
+    if( inst.active_count() ) {
+        if(warpId==(unsigned (-1)))
+            warpId = inst.warp_id();
+        active_mask_t active = inst.get_active_mask();
+        active_mask_t skipped;
+        if( ptx_thread_info::ptx_exec_warp_inst(inst,&m_thread[m_warp_size*warpId],m_warp_size,skipped) ) {
+            for ( unsigned t=0; t < m_warp_size; t++ ) {
+                if( active.test(t) ) {
+                    if( skipped.test(t) ) 
+                        inst.set_not_active(t);
+                    //virtual function
+                    checkExecutionStatusAndUpdate(inst,t,m_warp_size*warpId+t);
+                }
+            }
+            return;
+        }
+    }
     for ( unsigned t=0; t < m_warp_size; t++ ) {
         if( inst.active(t) ) {
             if(warpId==(unsigned (-1)))
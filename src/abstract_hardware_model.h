@@ -423,6 +423,8 @@ public:
     bool convert_to_ptxplus() const { return m_ptx_convert_to_ptxplus; }
     bool use_cuobjdump() const { return m_ptx_use_cuobjdump; }
     bool experimental_lib_support() const { return m_experimental_lib_support; }
+    bool ptx_warp_exec() const { return m_ptx_warp_exec; }
+    bool mmap_global_mem() const { return m_ptx_mmap_global_mem; }
 
     int         get_ptx_inst_debug_to_file() const { return g_ptx_inst_debug_to_file; }
     const char* get_ptx_inst_debug_file() const  { return g_ptx_inst_debug_file; }
@@ -435,6 +437,8 @@ private:
     int m_ptx_use_cuobjdump;
     int m_experimental_lib_support;
     unsigned m_ptx_force_max_capability;
+    int m_ptx_warp_exec;
+    int m_ptx_mmap_global_mem;
 
     int   g_ptx_inst_debug_to_file;
     char* g_ptx_inst_debug_file;
@@ -457,6 +461,14 @@ public:
     class memory_space *get_tex_memory() { return m_tex_mem; }
     class memory_space *get_surf_memory() { return m_surf_mem; }
 
+    // checkpoint support (see gpgpu_sim::save_checkpoint())
+    void save_memory( FILE *fp ) const;
+    void load_memory( FILE *fp );
+    // a kernel skipped by -resume_kernel leaves device memory out of date 
+    // until the checkpoint is restored; the host must not read it until then
+    void mark_skipped_kernel( unsigned uid ) { m_skipped_kernel = uid; }
+    void check_memory_current( const char *copy ) const;
+
     void gpgpu_ptx_sim_bindTextureToArray(const struct textureReference* texref, const struct cudaArray* array);
     void gpgpu_ptx_sim_bindNameToTexture(const char* name, const struct textureReference* texref, int dim, int readmode, int ext);
     const char* gpgpu_ptx_sim_findNamefromTexture(const struct textureReference* texref);
@@ -499,6 +511,7 @@ protected:
     class memory_space *m_surf_mem;
     
     unsigned long long m_dev_malloc;
+    unsigned m_skipped_kernel; // uid of the last kernel skipped since memory was restored (0 = none)
     
     std::map<std::string, const struct textureReference*> m_NameToTextureRef;
     std::map<const struct textureReference*,const struct cudaArray*> m_TextureRefToCudaArray;
@@ -1041,8 +1054,8 @@ class core_t {
         virtual void checkExecutionStatusAndUpdate(warp_inst_t &inst, unsigned t, unsigned tid)=0;
         class gpgpu_sim * get_gpu() {return m_gpu;}
         void execute_warp_inst_t(warp_inst_t &inst, unsigned warpId =(unsigned)-1);
-        bool  ptx_thread_done( unsigned hw_thread_id ) const ;
-        void updateSIMTStack(unsigned warpId, warp_inst_t * inst);
+        virtual bool  ptx_thread_done( unsigned hw_thread_id ) const ;
+        virtual void updateSIMTStack(unsigned warpId, warp_inst_t * inst);
         void initilizeSIMTStack(unsigned warp_count, unsigned warps_size);
         void deleteSIMTStack();
         warp_inst_t getExecuteWarp(unsigned warpId);
@@ -48,6 +48,7 @@
 #include "../gpgpusim_entrypoint.h"
 #include "decuda_pred_table/decuda_pred_table.h"
 #include "../stream_manager.h"
+#include "../gpgpu-sim/checkpoint.h"
 
 int gpgpu_ptx_instruction_classification;
 void ** g_inst_classification_stat = NULL;
@@ -381,9 +382,7 @@ void gpgpu_t::memcpy_to_gpu( size_t dst_start_addr, const void *src, size_t coun
       printf("GPGPU-Sim PTX: copying %zu bytes from CPU[0x%Lx] to GPU[0x%Lx] ... ", count, (unsigned long long) src, (unsigned long long) dst_start_addr );
       fflush(stdout);
    }
-   char *src_data = (char*)src;
-   for (unsigned n=0; n < count; n ++ ) 
-      m_global_mem->write(dst_start_addr+n,1, src_data+n,NULL,NULL);
+   m_global_mem->write(dst_start_addr,count,src,NULL,NULL);
    if(g_debug_execution >= 3) {
       printf( " done.\n");
       fflush(stdout);
@@ -392,13 +391,12 @@ void gpgpu_t::memcpy_to_gpu( size_t dst_start_addr, const void *src, size_t coun
 
 void gpgpu_t::memcpy_from_gpu( void *dst, size_t src_start_addr, size_t count )
 {
+   check_memory_current("copies device memory to the host");
    if(g_debug_execution >= 3) {
       printf("GPGPU-Sim PTX: copying %zu bytes from GPU[0x%Lx] to CPU[0x%Lx] ...", count, (unsigned long long) src_start_addr, (unsigned long long) dst );
       fflush(stdout);
    }
-   unsigned char *dst_data = (unsigned char*)dst;
-   for (unsigned n=0; n < count; n ++ ) 
-      m_global_mem->read(src_start_addr+n,1,dst_data+n);
+   m_global_mem->read(src_start_addr,count,dst);
    if(g_debug_execution >= 3) {
       printf( " done.\n");
       fflush(stdout);
@@ -412,10 +410,11 @@ void gpgpu_t::memcpy_gpu_to_gpu( size_t dst, size_t src, size_t count )
           (unsigned long long) src, (unsigned long long) dst );
       fflush(stdout);
    }
-   for (unsigned n=0; n < count; n ++ ) {
-      unsigned char tmp;
-      m_global_mem->read(src+n,1,&tmp); 
-      m_global_mem->write(dst+n,1, &tmp,NULL,NULL);
+   unsigned char buf[MEM_BLOCK_SIZE];
+   for (size_t n=0; n < count; n += MEM_BLOCK_SIZE ) {
+      size_t nbytes = (count-n < MEM_BLOCK_SIZE) ? count-n : MEM_BLOCK_SIZE;
+      m_global_mem->read(src+n,nbytes,buf); 
+      m_global_mem->write(dst+n,nbytes,buf,NULL,NULL);
    }
    if(g_debug_execution >= 3) {
       printf( " done.\n");
@@ -430,15 +429,53 @@ void gpgpu_t::gpu_memset( size_t dst_start_addr, int c, size_t count )
           count, (unsigned char) c, (unsigned long long) dst_start_addr );
       fflush(stdout);
    }
-   unsigned char c_value = (unsigned char)c;
-   for (unsigned n=0; n < count; n ++ ) 
-      m_global_mem->write(dst_start_addr+n,1,&c_value,NULL,NULL);
+   unsigned char buf[MEM_BLOCK_SIZE];
+   memset(buf,c,MEM_BLOCK_SIZE);
+   for (size_t n=0; n < count; n += MEM_BLOCK_SIZE ) {
+      size_t nbytes = (count-n < MEM_BLOCK_SIZE) ? count-n : MEM_BLOCK_SIZE;
+      m_global_mem->write(dst_start_addr+n,nbytes,buf,NULL,NULL);
+   }
    if(g_debug_execution >= 3) {
       printf( " done.\n");
       fflush(stdout);
    }
 }
 
+void gpgpu_t::save_memory( FILE *fp ) const
+{
+   checkpoint_write(fp,m_dev_malloc);
+   m_global_mem->save(fp);
+   m_tex_mem->save(fp);
+   m_surf_mem->save(fp);
+}
+
+void gpgpu_t::check_memory_current( const char *copy ) const
+{
+   // the skipped kernels' results only exist in the checkpoint, so the 
+   // host would read stale data and could take a different path
+   if( m_skipped_kernel ) {
+      printf("GPGPU-Sim PTX: ERROR ** the application %s after kernel %u was skipped by -resume_kernel; "
+             "this application cannot be resumed from a later kernel\n", copy, m_skipped_kernel );
+      exit(1);
+   }
+}
+
+void gpgpu_t::load_memory( FILE *fp )
+{
+   unsigned long long dev_malloc;
+   checkpoint_read(fp,dev_malloc);
+   // the application redoes its allocations before the resumed kernel, so 
+   // a different heap top means it did not take the same path
+   if( dev_malloc != m_dev_malloc ) {
+      printf("GPGPU-Sim PTX: WARNING ** device heap ended at 0x%Lx when the checkpoint was taken, at 0x%Lx now\n",
+             dev_malloc, m_dev_malloc );
+   }
+   m_global_mem->load(fp);
+   m_tex_mem->load(fp);
+   m_surf_mem->load(fp);
+   m_skipped_kernel = 0;
+}
+
 void ptx_print_insn( address_type pc, FILE *fp )
 {
    std::map<unsigned,function_info*>::iterator f = g_pc_to_finfo.find(pc);
@@ -1377,6 +1414,95 @@ void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
       
 }
 
+// Execute one instruction for all active lanes of a warp at once. Only
+// instructions accepted by ptx_warp_exec_supported() take this path, and only
+// when no per-thread debug output or classification is requested; otherwise
+// false is returned and the caller falls back to ptx_exec_inst() per lane.
+// Lanes whose guard predicate is false are returned in 'skipped'.
+bool ptx_thread_info::ptx_exec_warp_inst( warp_inst_t &inst, ptx_thread_info **lane_thread, unsigned warp_size, active_mask_t &skipped )
+{
+   ptx_thread_info *thread[MAX_WARP_SIZE];
+   unsigned lane[MAX_WARP_SIZE];
+   unsigned n = 0;
+
+   for ( unsigned t=0; t < warp_size; t++ ) {
+      if( !inst.active(t) ) 
+         continue;
+      ptx_thread_info *thd = lane_thread[t];
+      if( thd == NULL || thd->is_done() ) 
+         return false;
+      thread[n] = thd;
+      lane[n] = t;
+      n++;
+   }
+   if( n == 0 ) 
+      return false;
+
+   const gpgpu_functional_sim_config &config = thread[0]->m_gpu->get_config();
+   if( !config.ptx_warp_exec() || g_debug_execution >= 5 || 
+       config.get_ptx_inst_debug_to_file() || gpgpu_ptx_instruction_classification ) 
+      return false;
+
+   const function_info *finfo = thread[0]->m_func_info;
+   for ( unsigned l=0; l < n; l++ ) {
+      if( thread[l]->m_func_info != finfo || thread[l]->m_PC != inst.pc ) 
+         return false;
+   }
+   const ptx_instruction *pI = finfo->get_instruction(inst.pc);
+   if( !ptx_warp_exec_supported(pI) ) 
+      return false;
+
+   ptx_thread_info *exec_thread[MAX_WARP_SIZE];
+   unsigned n_exec = 0;
+   bool skip[MAX_WARP_SIZE];
+   for ( unsigned l=0; l < n; l++ ) {
+      ptx_thread_info *thd = thread[l];
+      addr_t pc = thd->next_instr();
+      thd->set_npc( pc + pI->inst_size() );
+      thd->clearRPC();
+      thd->m_last_set_operand_value.u64 = 0;
+
+      skip[l] = false;
+      if( pI->has_pred() ) {
+         const operand_info &pred = pI->get_pred();
+         ptx_reg_t pred_value = thd->get_operand_value(pred, pred, PRED_TYPE, thd, 0);
+         if(pI->get_pred_mod() == -1) {
+               skip[l] = (pred_value.pred & 0x0001) ^ pI->get_pred_neg(); //ptxplus inverts the zero flag
+         } else {
+               skip[l] = !pred_lookup(pI->get_pred_mod(), pred_value.pred & 0x000F);
+         }
+      }
+      if( skip[l] ) 
+         skipped.set(lane[l]);
+      else 
+         exec_thread[n_exec++] = thd;
+   }
+
+   if( n_exec ) 
+      ptx_warp_exec(pI, exec_thread, n_exec);
+
+   for ( unsigned l=0; l < n; l++ ) {
+      ptx_thread_info *thd = thread[l];
+      thd->update_pc();
+      g_ptx_sim_num_insn++;
+
+      //not using it with functional simulation mode
+      if(!(thd->m_functionalSimulationMode))
+          ptx_file_line_stats_add_exec_count(pI);
+      if ( (g_ptx_sim_num_insn % 10000000) == 0 ) 
+         fflush(stdout);
+
+      // "Return values"
+      if( !skip[l] ) {
+         inst.space = memory_space_t(undefined_space);
+         inst.set_addr(lane[l], 0xFEEBDAED);
+         inst.data_size = 0;
+         assert( inst.memory_op == no_memory_op );
+      }
+   }
+   return true;
+}
+
 void set_param_gpgpu_num_shaders(int num_shaders)
 {
    gpgpu_param_num_shaders = num_shaders;
@@ -1650,6 +1776,8 @@ void gpgpu_ptx_sim_memcpy_symbol(const char *hostVar, const void *src, size_t co
    default:
       abort();
    }
+   if( !to ) 
+      gpu->check_memory_current("copies a device symbol to the host");
    printf("GPGPU-Sim PTX: gpgpu_ptx_sim_memcpy_symbol: copying %s memory %zu bytes %s symbol %s+%zu @0x%x ...\n", 
           mem_name, count, (to?" to ":"from"), sym_name.c_str(), offset, dst );
    for ( unsigned n=0; n < count; n++ ) {
@@ -1844,6 +1972,7 @@ void functionalCoreSim::executeWarp(unsigned i, bool &allAtBarrier, bool & someO
     if(!m_warpAtBarrier[i] && m_liveThreadCount[i]!=0){
         warp_inst_t inst =getExecuteWarp(i);
         execute_warp_inst_t(inst,i);
+        m_gpu->fast_forward_record(m_cta_id,inst);
         if(inst.isatomic()) inst.do_atomic(true);
         if(inst.op==BARRIER_OP || inst.op==MEMORY_BARRIER_OP ) m_warpAtBarrier[i]=true;
         updateSIMTStack( i, &inst );
@@ -90,6 +90,9 @@ public:
     {
         m_warpAtBarrier =  new bool [m_warp_count];
         m_liveThreadCount = new unsigned [m_warp_count];
+        dim3 cta = kernel->get_next_cta_id();
+        dim3 grid = kernel->get_grid_dim();
+        m_cta_id = cta.x + grid.x*(cta.y + grid.y*cta.z);
     }
     virtual ~functionalCoreSim(){
         warp_exit(0);
@@ -121,6 +124,8 @@ private:
     //each warp live thread count and barrier indicator
     unsigned * m_liveThreadCount;
     bool* m_warpAtBarrier;
+    // linear id of the CTA, used to place its memory accesses for cache warm-up
+    unsigned m_cta_id;
 };
 
 #define RECONVERGE_RETURN_PC ((address_type)-2)
@@ -56,13 +56,20 @@ ptx_reg_t srcOperandModifiers(ptx_reg_t opData, operand_info opInfo, operand_inf
 
 void sign_extend( ptx_reg_t &data, unsigned src_size, const operand_info &dst );
 
+// value of reg in the current call frame, zero initialized if not written yet
+ptx_reg_t &ptx_thread_info::frame_reg( const symbol *reg )
+{
+   unsigned n_slots = m_func_info? m_func_info->num_reg_frame_slots() : 0;
+   return m_regs.back().lookup( reg, reg->frame_slot(), n_slots );
+}
+
 void ptx_thread_info::set_reg( const symbol *reg, const ptx_reg_t &value ) 
 {
    assert( reg != NULL );
    if( reg->name() == "_" ) return;
    assert( !m_regs.empty() );
    assert( reg->uid() > 0 );
-   m_regs.back()[ reg ] = value;
+   frame_reg(reg) = value;
    if (m_enable_debug_trace ) 
       m_debug_trace_regs_modified.back()[ reg ] = value;
    m_last_set_operand_value = value;
@@ -73,8 +80,8 @@ ptx_reg_t ptx_thread_info::get_reg( const symbol *reg )
    static bool unfound_register_warned = false;
    assert( reg != NULL );
    assert( !m_regs.empty() );
-   reg_map_t::iterator regs_iter = m_regs.back().find(reg);
-   if (regs_iter == m_regs.back().end()) {
+   ptx_reg_t *value = m_regs.back().find( reg, reg->frame_slot() );
+   if (value == NULL) {
       assert( reg->type()->get_key().is_reg() );
       const std::string &name = reg->name();
       unsigned call_uid = m_callstack.back().m_call_uid;
@@ -88,11 +95,11 @@ ptx_reg_t ptx_thread_info::get_reg( const symbol *reg )
                  file_loc.c_str(), name.c_str(), call_uid );
           unfound_register_warned = true;
       }
-      regs_iter = m_regs.back().find(reg);
+      value = m_regs.back().find( reg, reg->frame_slot() );
    }
    if (m_enable_debug_trace ) 
-      m_debug_trace_regs_read.back()[ reg ] = regs_iter->second;
-   return regs_iter->second;
+      m_debug_trace_regs_read.back()[ reg ] = *value;
+   return *value;
 }
 
 ptx_reg_t ptx_thread_info::get_operand_value( const operand_info &op, operand_info dstInfo, unsigned opType, ptx_thread_info *thread, int derefFlag )
@@ -333,9 +340,9 @@ void ptx_thread_info::get_vector_operand_values( const operand_info &op, ptx_reg
       const symbol *sym = NULL;
       sym = op.vec_symbol(idx);
       if( strcmp(sym->name().c_str(),"_") != 0) {
-         reg_map_t::iterator reg_iter = m_regs.back().find(sym);
-         assert( reg_iter != m_regs.back().end() );
-         ptx_regs[idx] = reg_iter->second;
+         ptx_reg_t *value = m_regs.back().find( sym, sym->frame_slot() );
+         assert( value != NULL );
+         ptx_regs[idx] = *value;
       }
    }
 }
@@ -371,7 +378,7 @@ void ptx_thread_info::set_operand_value( const operand_info &dst, const ptx_reg_
         ptx_reg_t predValue;
         
         const symbol *sym = dst.vec_symbol(0);
-        predValue.u64 = (m_regs.back()[ sym ].u64) & ~(0x0C);
+        predValue.u64 = (frame_reg(sym).u64) & ~(0x0C);
         predValue.u64 |= ((overflow & 0x01)<<3);
         predValue.u64 |= ((carry & 0x01)<<2);
 
@@ -498,11 +505,11 @@ void ptx_thread_info::set_operand_value( const operand_info &dst, const ptx_reg_
 
           if(dst.get_operand_lohi() == 1)
           {
-              setValue.u64 = ((m_regs.back()[ regName ].u64) & (~(0xFFFF))) + (data.u64 & 0xFFFF);
+              setValue.u64 = ((frame_reg(regName).u64) & (~(0xFFFF))) + (data.u64 & 0xFFFF);
           }
           else if(dst.get_operand_lohi() == 2)
           {
-              setValue.u64 = ((m_regs.back()[ regName ].u64) & (~(0xFFFF0000))) + ((data.u64<<16) & 0xFFFF0000);
+              setValue.u64 = ((frame_reg(regName).u64) & (~(0xFFFF0000))) + ((data.u64<<16) & 0xFFFF0000);
           }
 
           set_reg(predName,predValue);
@@ -555,11 +562,11 @@ void ptx_thread_info::set_operand_value( const operand_info &dst, const ptx_reg_
       {
           if(dst.get_operand_lohi() == 1)
           {
-              setValue.u64 = ((m_regs.back()[ dst.get_symbol() ].u64) & (~(0xFFFF))) + (data.u64 & 0xFFFF);
+              setValue.u64 = ((frame_reg(dst.get_symbol()).u64) & (~(0xFFFF))) + (data.u64 & 0xFFFF);
           }
           else if(dst.get_operand_lohi() == 2)
           {
-              setValue.u64 = ((m_regs.back()[ dst.get_symbol() ].u64) & (~(0xFFFF0000))) + ((data.u64<<16) & 0xFFFF0000);
+              setValue.u64 = ((frame_reg(dst.get_symbol()).u64) & (~(0xFFFF0000))) + ((data.u64<<16) & 0xFFFF0000);
           }
           set_reg(dst.get_symbol(),setValue);
       }
@@ -4329,3 +4336,302 @@ ptx_reg_t srcOperandModifiers(ptx_reg_t opData, operand_info opInfo, operand_inf
    return result;
 }
 
+
+// Warp-level execution of common ALU instructions
+//
+// ptx_warp_exec_supported() checks, once per warp instruction, that the 
+// instruction only reads plain registers, literals or builtins and writes a 
+// single plain register. ptx_warp_exec() then gathers the source operands of
+// all executing lanes into per-operand arrays, computes every lane in one 
+// loop per opcode/type and writes the results back. The arithmetic below 
+// mirrors the corresponding *_impl functions for the types it accepts.
+
+static bool warp_exec_operand_ok( const operand_info &op, bool is_dst )
+{
+   if( op.get_double_operand_type() != 0 || op.get_addr_space() != undefined_space ||
+       op.get_operand_lohi() != 0 || op.get_operand_neg() || op.is_vector() ) 
+      return false;
+   if( is_dst ) 
+      return op.is_reg();
+   return op.is_reg() || op.is_literal() || op.is_builtin();
+}
+
+static bool warp_exec_type_ok( int opcode, unsigned type, unsigned rounding_mode )
+{
+   switch( opcode ) {
+   case ADD_OP:
+      switch( type ) {
+      case S32_TYPE: case S64_TYPE: case U32_TYPE: case U64_TYPE: return true;
+      case F32_TYPE: case F64_TYPE: return rounding_mode == RN_OPTION;
+      default: return false;
+      }
+   case SUB_OP:
+      switch( type ) {
+      case S32_TYPE: case S64_TYPE: case U32_TYPE: case B32_TYPE: case U64_TYPE: case B64_TYPE: 
+      case F32_TYPE: case F64_TYPE: return true;
+      default: return false;
+      }
+   case MUL_OP:
+      switch( type ) {
+      case S32_TYPE: case U32_TYPE: case S64_TYPE: case U64_TYPE: return true;
+      case F32_TYPE: case F64_TYPE: return rounding_mode == RN_OPTION;
+      default: return false;
+      }
+   case MIN_OP: case MAX_OP:
+      switch( type ) {
+      case U16_TYPE: case U32_TYPE: case U64_TYPE: case S16_TYPE: case S32_TYPE: case S64_TYPE:
+      case F32_TYPE: case F64_TYPE: return true;
+      default: return false;
+      }
+   case AND_OP: case OR_OP: case XOR_OP: case MOV_OP: case SETP_OP:
+      return type != BB64_TYPE && type != BB128_TYPE && type != FF64_TYPE;
+   case NOT_OP:
+      return type == PRED_TYPE || type == B16_TYPE || type == B32_TYPE || type == B64_TYPE;
+   case SHL_OP:
+      switch( type ) {
+      case B16_TYPE: case U16_TYPE: case B32_TYPE: case U32_TYPE: case B64_TYPE: case U64_TYPE: return true;
+      default: return false;
+      }
+   case SHR_OP:
+      switch( type ) {
+      case B16_TYPE: case U16_TYPE: case B32_TYPE: case U32_TYPE: case B64_TYPE: case U64_TYPE:
+      case S16_TYPE: case S32_TYPE: case S64_TYPE: return true;
+      default: return false;
+      }
+   default:
+      return false;
+   }
+}
+
+bool ptx_warp_exec_supported( const ptx_instruction *pI )
+{
+   int opcode = pI->get_opcode();
+   if( pI->is_exit() ) 
+      return false;
+   if( !warp_exec_type_ok(opcode, pI->get_type(), pI->rounding_mode()) ) 
+      return false;
+   unsigned n_src = (opcode == NOT_OP || opcode == MOV_OP)? 1 : 2;
+   if( pI->get_num_operands() != n_src + 1 ) 
+      return false;
+   if( opcode == MUL_OP && !pI->is_lo() && 
+       (pI->get_type() == S64_TYPE || pI->get_type() == U64_TYPE) ) 
+      return false;
+   if( !warp_exec_operand_ok(pI->dst(), true) || !warp_exec_operand_ok(pI->src1(), false) ) 
+      return false;
+   if( n_src == 2 && !warp_exec_operand_ok(pI->src2(), false) ) 
+      return false;
+   return true;
+}
+
+static void warp_exec_read_operand( const operand_info &op, ptx_thread_info **thread, unsigned n, ptx_reg_t *v )
+{
+   if( op.is_reg() ) {
+      const symbol *reg = op.get_symbol();
+      for( unsigned l=0; l < n; l++ ) 
+         v[l] = thread[l]->get_reg(reg);
+   } else if( op.is_builtin() ) {
+      int builtin_id = op.get_int();
+      unsigned dim_mod = op.get_addr_offset();
+      for( unsigned l=0; l < n; l++ ) 
+         v[l].u32 = thread[l]->get_builtin(builtin_id, dim_mod);
+   } else {
+      ptx_reg_t literal = op.get_literal_value();
+      for( unsigned l=0; l < n; l++ ) 
+         v[l] = literal;
+   }
+}
+
+// apply 'expr' to every lane; a, b are the source values and d the result
+#define WARP_EXEC_LOOP(expr) \
+   for( unsigned l=0; l < n; l++ ) { \
+      const ptx_reg_t &a = src1[l]; const ptx_reg_t &b = src2[l]; ptx_reg_t &d = dst[l]; \
+      (void)a; (void)b; expr; \
+   }
+
+static void warp_exec_add( unsigned type, unsigned n, const ptx_reg_t *src1, const ptx_reg_t *src2, ptx_reg_t *dst )
+{
+   switch( type ) {
+   case S32_TYPE: WARP_EXEC_LOOP( d.s64 = (a.s64 & 0x0FFFFFFFF) + (b.s64 & 0x0FFFFFFFF) ) break;
+   case S64_TYPE: WARP_EXEC_LOOP( d.s64 = a.s64 + b.s64 ) break;
+   case U32_TYPE: WARP_EXEC_LOOP( d.u64 = (a.u64 & 0xFFFFFFFF) + (b.u64 & 0xFFFFFFFF) ) break;
+   case U64_TYPE: WARP_EXEC_LOOP( d.u64 = a.u64 + b.u64 ) break;
+   case F32_TYPE: WARP_EXEC_LOOP( d.f32 = a.f32 + b.f32 ) break;
+   case F64_TYPE: WARP_EXEC_LOOP( d.f64 = a.f64 + b.f64 ) break;
+   default: assert(0); break;
+   }
+}
+
+static void warp_exec_sub( unsigned type, unsigned n, const ptx_reg_t *src1, const ptx_reg_t *src2, ptx_reg_t *dst )
+{
+   switch( type ) {
+   case S32_TYPE: WARP_EXEC_LOOP( d.s64 = (a.s64 & 0xFFFFFFFF) - (b.s64 & 0xFFFFFFFF) + 0x100000000 ) break;
+   case S64_TYPE: WARP_EXEC_LOOP( d.s64 = a.s64 - b.s64 ) break;
+   case B32_TYPE: 
+   case U32_TYPE: WARP_EXEC_LOOP( d.u64 = (a.u64 & 0xFFFFFFFF) - (b.u64 & 0xFFFFFFFF) + 0x100000000 ) break;
+   case B64_TYPE: 
+   case U64_TYPE: WARP_EXEC_LOOP( d.u64 = a.u64 - b.u64 ) break;
+   case F32_TYPE: WARP_EXEC_LOOP( d.f32 = a.f32 - b.f32 ) break;
+   case F64_TYPE: WARP_EXEC_LOOP( d.f64 = a.f64 - b.f64 ) break;
+   default: assert(0); break;
+   }
+}
+
+static void warp_exec_mul( const ptx_instruction *pI, unsigned n, const ptx_reg_t *src1, const ptx_reg_t *src2, ptx_reg_t *dst )
+{
+   switch( pI->get_type() ) {
+   case S32_TYPE: 
+      if( pI->is_wide() ) WARP_EXEC_LOOP( d.s64 = ((long long)a.s32) * ((long long)b.s32) )
+      else if( pI->is_hi() ) WARP_EXEC_LOOP( d.s32 = ((((long long)a.s32) * ((long long)b.s32))>>32) )
+      else if( pI->is_lo() ) WARP_EXEC_LOOP( ptx_reg_t t; t.s64 = ((long long)a.s32) * ((long long)b.s32); d.s32 = t.s32 )
+      else assert(0);
+      break;
+   case U32_TYPE: 
+      if( pI->is_wide() ) WARP_EXEC_LOOP( d.u64 = ((unsigned long long)a.u32) * ((unsigned long long)b.u32) )
+      else if( pI->is_lo() ) WARP_EXEC_LOOP( d.u32 = (unsigned)(((unsigned long long)a.u32) * ((unsigned long long)b.u32)) )
+      else if( pI->is_hi() ) WARP_EXEC_LOOP( d.u32 = ((((unsigned long long)a.u32) * ((unsigned long long)b.u32))>>32) )
+      else assert(0);
+      break;
+   case S64_TYPE: WARP_EXEC_LOOP( d.s64 = a.s64 * b.s64 ) break;
+   case U64_TYPE: WARP_EXEC_LOOP( d.u64 = a.u64 * b.u64 ) break;
+   case F32_TYPE: 
+      WARP_EXEC_LOOP( d.f32 = a.f32 * b.f32 )
+      if( pI->saturation_mode() ) 
+         WARP_EXEC_LOOP( if ( d.f32 < 0 ) d.f32 = 0; else if ( d.f32 > 1.0f ) d.f32 = 1.0f; )
+      break;
+   case F64_TYPE: 
+      WARP_EXEC_LOOP( d.f64 = a.f64 * b.f64 )
+      if( pI->saturation_mode() ) 
+         WARP_EXEC_LOOP( if ( d.f64 < 0 ) d.f64 = 0; else if ( d.f64 > 1.0f ) d.f64 = 1.0; )
+      break;
+   default: assert(0); break;
+   }
+}
+
+static void warp_exec_min_max( bool is_min, unsigned type, unsigned n, const ptx_reg_t *src1, const ptx_reg_t *src2, ptx_reg_t *dst )
+{
+   if( is_min ) {
+      switch ( type ) {
+      case U16_TYPE: WARP_EXEC_LOOP( d.u16 = MY_MIN_I(a.u16,b.u16) ) break;
+      case U32_TYPE: WARP_EXEC_LOOP( d.u32 = MY_MIN_I(a.u32,b.u32) ) break;
+      case U64_TYPE: WARP_EXEC_LOOP( d.u64 = MY_MIN_I(a.u64,b.u64) ) break;
+      case S16_TYPE: WARP_EXEC_LOOP( d.s16 = MY_MIN_I(a.s16,b.s16) ) break;
+      case S32_TYPE: WARP_EXEC_LOOP( d.s32 = MY_MIN_I(a.s32,b.s32) ) break;
+      case S64_TYPE: WARP_EXEC_LOOP( d.s64 = MY_MIN_I(a.s64,b.s64) ) break;
+      case F32_TYPE: WARP_EXEC_LOOP( d.f32 = MY_MIN_F(a.f32,b.f32) ) break;
+      case F64_TYPE: WARP_EXEC_LOOP( d.f64 = MY_MIN_F(a.f64,b.f64) ) break;
+      default: assert(0); break;
+      }
+   } else {
+      switch ( type ) {
+      case U16_TYPE: WARP_EXEC_LOOP( d.u16 = MY_MAX_I(a.u16,b.u16) ) break;
+      case U32_TYPE: WARP_EXEC_LOOP( d.u32 = MY_MAX_I(a.u32,b.u32) ) break;
+      case U64_TYPE: WARP_EXEC_LOOP( d.u64 = MY_MAX_I(a.u64,b.u64) ) break;
+      case S16_TYPE: WARP_EXEC_LOOP( d.s16 = MY_MAX_I(a.s16,b.s16) ) break;
+      case S32_TYPE: WARP_EXEC_LOOP( d.s32 = MY_MAX_I(a.s32,b.s32) ) break;
+      case S64_TYPE: WARP_EXEC_LOOP( d.s64 = MY_MAX_I(a.s64,b.s64) ) break;
+      case F32_TYPE: WARP_EXEC_LOOP( d.f32 = MY_MAX_F(a.f32,b.f32) ) break;
+      case F64_TYPE: WARP_EXEC_LOOP( d.f64 = MY_MAX_F(a.f64,b.f64) ) break;
+      default: assert(0); break;
+      }
+   }
+}
+
+static void warp_exec_shift( bool is_left, unsigned type, unsigned n, const ptx_reg_t *src1, const ptx_reg_t *src2, ptx_reg_t *dst )
+{
+   if( is_left ) {
+      switch ( type ) {
+      case B16_TYPE: 
+      case U16_TYPE: WARP_EXEC_LOOP( if ( b.u16 >= 16 ) d.u16 = 0; else d.u16 = (unsigned short) ((a.u16 << b.u16) & 0xFFFF); ) break;
+      case B32_TYPE: 
+      case U32_TYPE: WARP_EXEC_LOOP( if ( b.u32 >= 32 ) d.u32 = 0; else d.u32 = (unsigned) ((a.u32 << b.u32) & 0xFFFFFFFF); ) break;
+      case B64_TYPE: 
+      case U64_TYPE: WARP_EXEC_LOOP( if ( b.u32 >= 64 ) d.u64 = 0; else d.u64 = (a.u64 << b.u64); ) break;
+      default: assert(0); break;
+      }
+   } else {
+      switch ( type ) {
+      case U16_TYPE: 
+      case B16_TYPE: WARP_EXEC_LOOP( if ( b.u16 < 16 ) d.u16 = (unsigned short) ((a.u16 >> b.u16) & 0xFFFF); else d.u16 = 0; ) break;
+      case U32_TYPE: 
+      case B32_TYPE: WARP_EXEC_LOOP( if ( b.u32 < 32 ) d.u32 = (unsigned) ((a.u32 >> b.u32) & 0xFFFFFFFF); else d.u32 = 0; ) break;
+      case U64_TYPE: 
+      case B64_TYPE: WARP_EXEC_LOOP( if ( b.u32 < 64 ) d.u64 = (a.u64 >> b.u64); else d.u64 = 0; ) break;
+      case S16_TYPE: WARP_EXEC_LOOP( if ( b.u16 < 16 ) d.s64 = (a.s16 >> b.s16); else d.s64 = (a.s16 < 0)? -1 : 0; ) break;
+      case S32_TYPE: WARP_EXEC_LOOP( if ( b.u32 < 32 ) d.s64 = (a.s32 >> b.s32); else d.s64 = (a.s32 < 0)? -1 : 0; ) break;
+      case S64_TYPE: 
+         WARP_EXEC_LOOP( 
+            if ( b.u64 < 64 ) d.s64 = (a.s64 >> b.u64);
+            else if ( a.s64 < 0 ) { if ( b.s32 < 0 ) { d.u64 = -1; d.s32 = 0; } else { d.s64 = -1; } }
+            else d.s64 = 0; 
+         ) 
+         break;
+      default: assert(0); break;
+      }
+   }
+}
+
+void ptx_warp_exec( const ptx_instruction *pI, ptx_thread_info **thread, unsigned n )
+{
+   ptx_reg_t src1[MAX_WARP_SIZE], src2[MAX_WARP_SIZE], dst[MAX_WARP_SIZE];
+   int opcode = pI->get_opcode();
+   unsigned type = pI->get_type();
+
+   assert( n <= MAX_WARP_SIZE );
+   warp_exec_read_operand(pI->src1(), thread, n, src1);
+   if( opcode != NOT_OP && opcode != MOV_OP ) 
+      warp_exec_read_operand(pI->src2(), thread, n, src2);
+
+   switch( opcode ) {
+   case ADD_OP: warp_exec_add(type, n, src1, src2, dst); break;
+   case SUB_OP: warp_exec_sub(type, n, src1, src2, dst); break;
+   case MUL_OP: warp_exec_mul(pI, n, src1, src2, dst); break;
+   case MIN_OP: warp_exec_min_max(true, type, n, src1, src2, dst); break;
+   case MAX_OP: warp_exec_min_max(false, type, n, src1, src2, dst); break;
+   case SHL_OP: warp_exec_shift(true, type, n, src1, src2, dst); break;
+   case SHR_OP: warp_exec_shift(false, type, n, src1, src2, dst); break;
+   case AND_OP:
+      //the way ptxplus handles predicates: 1 = false and 0 = true
+      if( type == PRED_TYPE ) WARP_EXEC_LOOP( d.pred = ~(~(a.pred) & ~(b.pred)) )
+      else WARP_EXEC_LOOP( d.u64 = a.u64 & b.u64 )
+      break;
+   case OR_OP:
+      if( type == PRED_TYPE ) WARP_EXEC_LOOP( d.pred = ~(~(a.pred) | ~(b.pred)) )
+      else WARP_EXEC_LOOP( d.u64 = a.u64 | b.u64 )
+      break;
+   case XOR_OP:
+      if( type == PRED_TYPE ) WARP_EXEC_LOOP( d.pred = ~(~(a.pred) ^ ~(b.pred)) )
+      else WARP_EXEC_LOOP( d.u64 = a.u64 ^ b.u64 )
+      break;
+   case NOT_OP:
+      switch( type ) {
+      case PRED_TYPE: WARP_EXEC_LOOP( d.pred = (~(a.pred) & 0x000F) ) break;
+      case B16_TYPE:  WARP_EXEC_LOOP( d.u16  = ~a.u16 ) break;
+      case B32_TYPE:  WARP_EXEC_LOOP( d.u32  = ~a.u32 ) break;
+      case B64_TYPE:  WARP_EXEC_LOOP( d.u64  = ~a.u64 ) break;
+      default: assert(0); break;
+      }
+      break;
+   case MOV_OP:
+      // in ptx, literal input translate to predicate as 0 = false and 1 = true 
+      // (see mov_impl)
+      if( type == PRED_TYPE && pI->src1().is_literal() ) WARP_EXEC_LOOP( d.pred = (a.u32 == 0)? 1 : 0 )
+      else WARP_EXEC_LOOP( d = a )
+      break;
+   case SETP_OP: {
+      unsigned cmpop = pI->get_cmpop();
+      WARP_EXEC_LOOP( d.pred = (CmpOp(type,a,b,cmpop)==0) )
+      } break;
+   default: 
+      assert(0); 
+      break;
+   }
+
+   // same as the plain register destination case of set_operand_value: only 
+   // the low 64 bits of the result are written
+   const symbol *dst_reg = pI->dst().get_symbol();
+   for( unsigned l=0; l < n; l++ ) {
+      ptx_reg_t value;
+      value.u64 = dst[l].u64;
+      thread[l]->set_reg(dst_reg, value);
+   }
+}
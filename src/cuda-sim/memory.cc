@@ -27,7 +27,9 @@
 
 #include "memory.h"
 #include <stdlib.h>
+#include <sys/mman.h>
 #include "../debug.h"
+#include "../gpgpu-sim/checkpoint.h"
 
 template<unsigned BSIZE> memory_space_impl<BSIZE>::memory_space_impl( std::string name, unsigned hash_size )
 {
@@ -153,11 +155,174 @@ template<unsigned BSIZE> void memory_space_impl<BSIZE>::set_watch( addr_t addr,
    m_watchpoints[watchpoint]=addr;
 }
 
+template<unsigned BSIZE> void memory_space_impl<BSIZE>::save( FILE *fp ) const
+{
+   checkpoint_write_string(fp,m_name);
+   checkpoint_write(fp,BSIZE);
+   unsigned long long nblocks = m_data.size();
+   checkpoint_write(fp,nblocks);
+   unsigned char buf[BSIZE];
+   typename map_t::const_iterator i_page;
+   for (i_page = m_data.begin(); i_page != m_data.end(); ++i_page) {
+      checkpoint_write(fp,i_page->first);
+      i_page->second.read(0,BSIZE,buf);
+      checkpoint_write_bytes(fp,buf,BSIZE);
+   }
+}
+
+template<unsigned BSIZE> void memory_space_impl<BSIZE>::load( FILE *fp )
+{
+   std::string name = checkpoint_read_string(fp);
+   unsigned bsize;
+   checkpoint_read(fp,bsize);
+   if( name != m_name || bsize != BSIZE ) {
+      printf("GPGPU-Sim PTX: ERROR ** checkpoint holds memory space \'%s\' (%u byte blocks), expected \'%s\' (%u byte blocks)\n",
+             name.c_str(), bsize, m_name.c_str(), BSIZE);
+      exit(1);
+   }
+   unsigned long long nblocks;
+   checkpoint_read(fp,nblocks);
+   m_data.clear();
+   unsigned char buf[BSIZE];
+   for( unsigned long long n=0; n < nblocks; n++ ) {
+      mem_addr_t blk_idx;
+      checkpoint_read(fp,blk_idx);
+      checkpoint_read_bytes(fp,buf,BSIZE);
+      m_data[blk_idx].write(0,BSIZE,buf);
+   }
+}
+
 template class memory_space_impl<32>;
 template class memory_space_impl<64>;
 template class memory_space_impl<8192>;
 template class memory_space_impl<16*1024>;
 
+// size of the space addressed by a mem_addr_t
+static const unsigned long long mmap_space_size = 1ULL << (8*sizeof(mem_addr_t));
+
+memory_space_mmap::memory_space_mmap( std::string name )
+{
+   m_name = name;
+   // MAP_NORESERVE: only the pages that get written count against the host
+   void *base = mmap(NULL, mmap_space_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+   if( base == MAP_FAILED ) {
+      m_base = NULL;
+   } else {
+      m_base = (unsigned char*)base;
+      m_written.resize(mmap_space_size/MMAP_BLOCK_SIZE,false);
+   }
+}
+
+memory_space_mmap::~memory_space_mmap()
+{
+   if( m_base ) 
+      munmap(m_base, mmap_space_size);
+}
+
+void memory_space_mmap::check_range( mem_addr_t addr, size_t length ) const
+{
+   if( (unsigned long long)addr + length > mmap_space_size ) {
+      printf("GPGPU-Sim PTX: ERROR * access to memory \'%s\' is out of range : addr=0x%x, length=%zu\n",
+             m_name.c_str(), addr, length);
+      throw 1;
+   }
+}
+
+void memory_space_mmap::write( mem_addr_t addr, size_t length, const void *data, class ptx_thread_info *thd, const ptx_instruction *pI)
+{
+   if( length == 0 ) 
+      return;
+   check_range(addr,length);
+   memcpy(m_base+addr,data,length);
+   unsigned long long last = ((unsigned long long)addr + length - 1) / MMAP_BLOCK_SIZE;
+   for( unsigned long long blk = addr / MMAP_BLOCK_SIZE; blk <= last; blk++ ) 
+      m_written[blk] = true;
+   if( !m_watchpoints.empty() ) {
+      std::map<unsigned,mem_addr_t>::iterator i;
+      for( i=m_watchpoints.begin(); i!=m_watchpoints.end(); i++ ) {
+         mem_addr_t wa = i->second;
+         if( ((addr<=wa) && ((addr+length)>wa)) || ((addr>wa) && (addr < (wa+4))) ) 
+            hit_watchpoint(i->first,thd,pI);
+      }
+   }
+}
+
+void memory_space_mmap::read( mem_addr_t addr, size_t length, void *data ) const
+{
+   if( length == 0 ) 
+      return;
+   check_range(addr,length);
+   // pages never written read back as zero, like missing blocks of memory_space_impl
+   memcpy(data,m_base+addr,length);
+}
+
+void memory_space_mmap::print( const char *format, FILE *fout ) const
+{
+   for( unsigned long long blk=0; blk < m_written.size(); blk++ ) {
+      if( !m_written[blk] ) 
+         continue;
+      fprintf(fout, "%s - %#llx:", m_name.c_str(), blk);
+      const unsigned int *i_data = (const unsigned int*)(m_base + blk*MMAP_BLOCK_SIZE);
+      for (unsigned d = 0; d < (MMAP_BLOCK_SIZE / sizeof(unsigned int)); d++) {
+         if (d % 8 == 0) {
+            fprintf(fout, "\n");
+         }
+         fprintf(fout, format, i_data[d]);
+         fprintf(fout, " ");
+      }
+      fprintf(fout, "\n");
+      fflush(fout);
+   }
+}
+
+void memory_space_mmap::set_watch( addr_t addr, unsigned watchpoint ) 
+{
+   m_watchpoints[watchpoint]=addr;
+}
+
+void memory_space_mmap::save( FILE *fp ) const
+{
+   checkpoint_write_string(fp,m_name);
+   unsigned bsize = MMAP_BLOCK_SIZE;
+   checkpoint_write(fp,bsize);
+   unsigned long long nblocks = 0;
+   for( unsigned long long blk=0; blk < m_written.size(); blk++ ) 
+      if( m_written[blk] ) nblocks++;
+   checkpoint_write(fp,nblocks);
+   for( unsigned long long blk=0; blk < m_written.size(); blk++ ) {
+      if( !m_written[blk] ) 
+         continue;
+      mem_addr_t blk_idx = blk;
+      checkpoint_write(fp,blk_idx);
+      checkpoint_write_bytes(fp,m_base + blk*MMAP_BLOCK_SIZE,MMAP_BLOCK_SIZE);
+   }
+}
+
+void memory_space_mmap::load( FILE *fp )
+{
+   std::string name = checkpoint_read_string(fp);
+   unsigned bsize;
+   checkpoint_read(fp,bsize);
+   if( name != m_name || bsize != MMAP_BLOCK_SIZE ) {
+      printf("GPGPU-Sim PTX: ERROR ** checkpoint holds memory space \'%s\' (%u byte blocks), expected \'%s\' (%u byte blocks)\n",
+             name.c_str(), bsize, m_name.c_str(), MMAP_BLOCK_SIZE);
+      exit(1);
+   }
+   // drop every committed page; they read back as zero afterwards
+   madvise(m_base, mmap_space_size, MADV_DONTNEED);
+   m_written.assign(m_written.size(),false);
+   unsigned long long nblocks;
+   checkpoint_read(fp,nblocks);
+   for( unsigned long long n=0; n < nblocks; n++ ) {
+      mem_addr_t blk_idx;
+      checkpoint_read(fp,blk_idx);
+      if( blk_idx >= m_written.size() ) 
+         checkpoint_fail("read");
+      checkpoint_read_bytes(fp,m_base + (unsigned long long)blk_idx*MMAP_BLOCK_SIZE,MMAP_BLOCK_SIZE);
+      m_written[blk_idx] = true;
+   }
+}
+
 void g_print_memory_space(memory_space *mem, const char *format = "%08x", FILE *fout = stdout) 
 {
     mem->print(format,fout);
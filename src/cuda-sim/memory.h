@@ -43,6 +43,7 @@
 #include <stdio.h>
 #include <string>
 #include <map>
+#include <vector>
 #include <stdlib.h>
 
 typedef address_type mem_addr_t;
@@ -107,6 +108,10 @@ public:
    virtual void read( mem_addr_t addr, size_t length, void *data ) const = 0;
    virtual void print( const char *format, FILE *fout ) const = 0;
    virtual void set_watch( addr_t addr, unsigned watchpoint ) = 0;
+
+   // checkpoint support: load() replaces the whole contents of the space
+   virtual void save( FILE *fp ) const = 0;
+   virtual void load( FILE *fp ) = 0;
 };
 
 template<unsigned BSIZE> class memory_space_impl : public memory_space {
@@ -117,6 +122,8 @@ public:
    virtual void read( mem_addr_t addr, size_t length, void *data ) const;
    virtual void print( const char *format, FILE *fout ) const;
    virtual void set_watch( addr_t addr, unsigned watchpoint ); 
+   virtual void save( FILE *fp ) const;
+   virtual void load( FILE *fp );
 
 private:
    void read_single_block( mem_addr_t blk_idx, mem_addr_t addr, size_t length, void *data) const; 
@@ -127,4 +134,34 @@ private:
    std::map<unsigned,mem_addr_t> m_watchpoints;
 };
 
+// Backing store for the whole 32-bit address space reserved with a single 
+// anonymous mmap.  The host kernel commits pages on first write, so address 
+// translation is an add and bulk copies are plain memcpy.  The blocks written 
+// so far are tracked to print and checkpoint only the touched parts; the 
+// checkpoint format is the one of memory_space_impl<MMAP_BLOCK_SIZE>.
+#define MMAP_BLOCK_SIZE (8*1024)
+
+class memory_space_mmap : public memory_space {
+public:
+   memory_space_mmap( std::string name );
+   virtual ~memory_space_mmap();
+
+   // false if the address space could not be reserved
+   bool mapped() const { return m_base != NULL; }
+
+   virtual void write( mem_addr_t addr, size_t length, const void *data, ptx_thread_info *thd, const ptx_instruction *pI );
+   virtual void read( mem_addr_t addr, size_t length, void *data ) const;
+   virtual void print( const char *format, FILE *fout ) const;
+   virtual void set_watch( addr_t addr, unsigned watchpoint ); 
+   virtual void save( FILE *fp ) const;
+   virtual void load( FILE *fp );
+
+private:
+   void check_range( mem_addr_t addr, size_t length ) const;
+   std::string m_name;
+   unsigned char *m_base;
+   std::vector<bool> m_written; // one flag per MMAP_BLOCK_SIZE block
+   std::map<unsigned,mem_addr_t> m_watchpoints;
+};
+
 #endif
@@ -1248,6 +1248,7 @@ function_info::function_info(int entry_point )
    m_kernel_info.regs = 0;
    m_kernel_info.smem = 0;
    m_local_mem_framesize = 0;
+   m_n_reg_frame_slots = 0;
 }
 
 unsigned function_info::print_insn( unsigned pc, FILE * fp ) const
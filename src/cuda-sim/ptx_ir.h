@@ -169,6 +169,7 @@ public:
       m_function = NULL;
       m_reg_num=(unsigned)-1;
       m_arch_reg_num=(unsigned)-1;
+      m_frame_slot=(unsigned)-1;
       m_address=(unsigned)-1;
       m_initializer.clear();
       if ( type ) m_is_shared = type->get_key().is_shared();
@@ -262,6 +263,10 @@ public:
       assert( m_reg_num_valid );
       return m_arch_reg_num; 
    }
+   // dense index of a register in the register frame of the function that 
+   // declares it, (unsigned)-1 for registers declared outside a function
+   void set_frame_slot( unsigned slot ) { m_frame_slot = slot; }
+   unsigned frame_slot() const { return m_frame_slot; }
    void print_info(FILE *fp) const;
    unsigned uid() const { return m_uid; }
 
@@ -287,6 +292,7 @@ private:
    bool m_is_func_addr;
    unsigned m_reg_num; 
    unsigned m_arch_reg_num; 
+   unsigned m_frame_slot;
    bool m_reg_num_valid; 
 
    std::list<operand_info> m_initializer;
@@ -1259,11 +1265,15 @@ public:
    {
       m_local_mem_framesize = sz;
    }
+   // register frame slots are handed out as registers are declared
+   unsigned alloc_reg_frame_slot() { return m_n_reg_frame_slots++; }
+   unsigned num_reg_frame_slots() const { return m_n_reg_frame_slots; }
    bool is_entry_point() const { return m_entry_point; }
 
 private:
    unsigned m_uid;
    unsigned m_local_mem_framesize;
+   unsigned m_n_reg_frame_slots;
    bool m_entry_point;
    bool m_extern;
    bool m_assembled;
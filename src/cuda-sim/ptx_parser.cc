@@ -400,6 +400,8 @@ void add_identifier( const char *identifier, int array_dim, unsigned array_ident
          arch_regnum = 0;
       }
       g_last_symbol->set_regno(regnum, arch_regnum);
+      if( g_func_info ) 
+         g_last_symbol->set_frame_slot( g_func_info->alloc_reg_frame_slot() );
       } break;
    case shared_space:
       printf("GPGPU-Sim PTX: allocating shared region for \"%s\" ",
@@ -162,7 +162,7 @@ ptx_thread_info::ptx_thread_info( kernel_info_t &kernel )
    m_hw_sid = -1;
    m_last_dram_callback.function = NULL;
    m_last_dram_callback.instruction = NULL;
-   m_regs.push_back( reg_map_t() );
+   m_regs.push_back( reg_frame_t() );
    m_debug_trace_regs_modified.push_back( reg_map_t() );
    m_debug_trace_regs_read.push_back( reg_map_t() );
    m_callstack.push_back( stack_entry() );
@@ -355,7 +355,7 @@ void ptx_thread_info::callstack_push( unsigned pc, unsigned rpc, const symbol *r
    m_last_was_call = true;
    assert( m_func_info != NULL );
    m_callstack.push_back( stack_entry(m_symbol_table,m_func_info,pc,rpc,return_var_src,return_var_dst,call_uid) );
-   m_regs.push_back( reg_map_t() );
+   m_regs.push_back( reg_frame_t() );
    m_debug_trace_regs_modified.push_back( reg_map_t() );
    m_debug_trace_regs_read.push_back( reg_map_t() );
    m_local_mem_stack_pointer += m_func_info->local_mem_framesize(); 
@@ -369,7 +369,7 @@ void ptx_thread_info::callstack_push_plus( unsigned pc, unsigned rpc, const symb
    m_last_was_call = true;
    assert( m_func_info != NULL );
    m_callstack.push_back( stack_entry(m_symbol_table,m_func_info,pc,rpc,return_var_src,return_var_dst,call_uid) );
-   //m_regs.push_back( reg_map_t() );
+   //m_regs.push_back( reg_frame_t() );
    //m_debug_trace_regs_modified.push_back( reg_map_t() );
    //m_debug_trace_regs_read.push_back( reg_map_t() );
    m_local_mem_stack_pointer += m_func_info->local_mem_framesize();
@@ -446,13 +446,13 @@ bool ptx_thread_info::callstack_pop_plus()
 void ptx_thread_info::dump_callstack() const
 {
    std::list<stack_entry>::const_iterator c=m_callstack.begin();
-   std::list<reg_map_t>::const_iterator r=m_regs.begin();
+   std::list<reg_frame_t>::const_iterator r=m_regs.begin();
 
    printf("\n\n");
    printf("Call stack for thread uid = %u (sc=%u, hwtid=%u)\n", m_uid, m_hw_sid, m_hw_tid );
    while( c != m_callstack.end() && r != m_regs.end() ) {
       const stack_entry &c_e = *c;
-      const reg_map_t &regs = *r;
+      const reg_frame_t &regs = *r;
       if( !c_e.m_valid ) {
          printf("  <entry>                              #regs = %zu\n", regs.size() );
       } else {
@@ -495,8 +495,10 @@ void ptx_thread_info::dump_regs( FILE *fp )
    if(m_regs.back().empty()) return;
    fprintf(fp,"Register File Contents:\n");
    fflush(fp);
-   reg_map_t::const_iterator r;
-   for ( r=m_regs.back().begin(); r != m_regs.back().end(); ++r ) {
+   std::list<std::pair<const symbol*,ptx_reg_t> > regs;
+   m_regs.back().get_regs(regs);
+   std::list<std::pair<const symbol*,ptx_reg_t> >::const_iterator r;
+   for ( r=regs.begin(); r != regs.end(); ++r ) {
       const symbol *sym = r->first;
       ptx_reg_t value = r->second;
       std::string name = sym->name();
@@ -39,6 +39,7 @@
 #include <map>
 #include <set>
 #include <list>
+#include <vector>
 
 #include "memory.h"
 
@@ -202,6 +203,75 @@ struct stack_entry {
    unsigned       m_call_uid;
 };
 
+// Register values of one call frame. Registers declared inside a function 
+// carry a dense per-function slot index (symbol::frame_slot()), so the common
+// case is a direct array access. Registers without a slot, or whose slot is 
+// already held by another register (e.g., ptxplus calls execute in the 
+// caller's frame), are kept in m_overflow.
+class reg_frame_t {
+public:
+   reg_frame_t() { m_n_slots_used = 0; }
+
+   // returns NULL if reg has not been written in this frame
+   ptx_reg_t *find( const symbol *reg, unsigned slot )
+   {
+      if( slot < m_owner.size() && m_owner[slot] == reg ) 
+         return &m_value[slot];
+      if( m_overflow.empty() ) 
+         return NULL;
+      overflow_map_t::iterator r = m_overflow.find(reg);
+      if( r == m_overflow.end() ) 
+         return NULL;
+      return &r->second;
+   }
+   // returns the value of reg, adding it (zero initialized) if it is not in 
+   // the frame yet; n_slots is the number of slots of the current function
+   ptx_reg_t &lookup( const symbol *reg, unsigned slot, unsigned n_slots )
+   {
+      ptx_reg_t *value = find(reg,slot);
+      if( value ) 
+         return *value;
+      return insert(reg,slot,n_slots);
+   }
+   size_t size() const { return m_n_slots_used + m_overflow.size(); }
+   bool empty() const { return size() == 0; }
+   // all registers written in this frame (for debug dumps)
+   void get_regs( std::list<std::pair<const symbol*,ptx_reg_t> > &regs ) const
+   {
+      for( unsigned i=0; i < m_owner.size(); i++ ) {
+         if( m_owner[i] ) 
+            regs.push_back( std::make_pair(m_owner[i],m_value[i]) );
+      }
+      overflow_map_t::const_iterator r;
+      for( r=m_overflow.begin(); r != m_overflow.end(); ++r ) 
+         regs.push_back( *r );
+   }
+
+private:
+   ptx_reg_t &insert( const symbol *reg, unsigned slot, unsigned n_slots )
+   {
+      if( slot != (unsigned)-1 ) {
+         if( slot >= m_owner.size() ) {
+            size_t n = (n_slots > slot)? n_slots : 2*slot+1;
+            m_owner.resize(n,NULL);
+            m_value.resize(n);
+         }
+         if( m_owner[slot] == NULL ) {
+            m_owner[slot] = reg;
+            m_n_slots_used++;
+            return m_value[slot];
+         }
+      }
+      return m_overflow[reg];
+   }
+
+   typedef tr1_hash_map<const symbol*,ptx_reg_t> overflow_map_t;
+   std::vector<const symbol*> m_owner; // NULL = slot not written yet
+   std::vector<ptx_reg_t> m_value;
+   unsigned m_n_slots_used;
+   overflow_map_t m_overflow;
+};
+
 class ptx_version {
 public:
       ptx_version()
@@ -275,6 +345,7 @@ public:
 
    void ptx_fetch_inst( inst_t &inst ) const;
    void ptx_exec_inst( warp_inst_t &inst, unsigned lane_id );
+   static bool ptx_exec_warp_inst( warp_inst_t &inst, ptx_thread_info **lane_thread, unsigned warp_size, active_mask_t &skipped );
 
    const ptx_version &get_ptx_version() const;
    void set_reg( const symbol *reg, const ptx_reg_t &value );
@@ -429,6 +500,7 @@ public:
    ptx_reg_t m_last_set_operand_value;
 
 private:
+   ptx_reg_t &frame_reg( const symbol *reg );
 
    bool m_functionalSimulationMode; 
    unsigned m_uid;
@@ -465,7 +537,7 @@ private:
    unsigned m_local_mem_stack_pointer;
 
    typedef tr1_hash_map<const symbol*,ptx_reg_t> reg_map_t;
-   std::list<reg_map_t> m_regs;
+   std::list<reg_frame_t> m_regs;
    std::list<reg_map_t> m_debug_trace_regs_modified;
    std::list<reg_map_t> m_debug_trace_regs_read;
    bool m_enable_debug_trace;
@@ -484,6 +556,9 @@ bool isspace_shared( unsigned smid, addr_t addr );
 bool isspace_global( addr_t addr );
 memory_space_t whichspace( addr_t addr );
 
+bool ptx_warp_exec_supported( const ptx_instruction *pI );
+void ptx_warp_exec( const ptx_instruction *pI, ptx_thread_info **thread, unsigned n );
+
 extern unsigned g_ptx_thread_info_uid_next;
 
 #endif
@@ -0,0 +1,391 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "analytical_icnt.h"
+#include "../intersim2/intersim_config.hpp"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+
+// subnet_selection values of the intersim2 configuration
+enum { SUBNET_PCKT_TYPE = 0, SUBNET_ROUND_ROBIN, SUBNET_RANDOM, SUBNET_PCKT_SIZE };
+
+analytical_icnt::analytical_icnt( const char *config_file, int latency_offset )
+{
+   if (!config_file) {
+      printf("GPGPU-Sim uArch: ERROR ** the analytical interconnect model needs -inter_config_file\n");
+      exit(1);
+   }
+   IntersimConfig config;
+   config.ParseFile(config_file);
+
+   m_k = config.GetInt("k");
+   m_n = config.GetInt("n");
+   m_s = config.GetInt("s");
+   m_c = config.GetInt("c");
+   const std::string topology = config.GetStr("topology");
+   if (topology == "mesh3D") {
+      // planar links are +x,-x,+y,-y per router, then one up and one down 
+      // bus per column of the stack
+      m_topology = TOPO_MESH3D;
+      m_c = 1;
+      m_routers = m_k * m_n * m_s;
+      m_links = m_routers * 4 + m_k * m_n * 2;
+   } else if (topology == "mesh" || topology == "torus" || topology == "cmesh") {
+      m_topology = (topology == "torus")? TOPO_TORUS : TOPO_MESH;
+      if (topology != "cmesh") 
+         m_c = 1;
+      m_routers = 1;
+      for (unsigned d = 0; d < m_n; d++) 
+         m_routers *= m_k;
+      m_links = m_routers * 2 * m_n;
+   } else {
+      // anything else is timed as a single-hop crossbar
+      m_topology = TOPO_CROSSBAR;
+      m_c = 1;
+      m_routers = 0;
+      m_links = 0;
+   }
+
+   m_subnets = config.GetInt("subnets");
+   m_subnet_selection = (m_subnets > 1)? config.GetInt("subnet_selection") : SUBNET_ROUND_ROBIN;
+   m_flit_size = config.GetInt("flit_size");
+   m_asym_flit_size = config.GetInt("asym_flit_size");
+   m_input_buffer = config.GetInt("input_buffer_size");
+   if (m_input_buffer == 0) 
+      m_input_buffer = 16;
+   unsigned vc_alloc_delay = config.GetInt("vc_alloc_delay");
+   unsigned sw_alloc_delay = config.GetInt("sw_alloc_delay");
+   unsigned alloc_delay = config.GetInt("speculative")? std::max(vc_alloc_delay, sw_alloc_delay) 
+                                                      : (vc_alloc_delay + sw_alloc_delay);
+   m_router_delay = config.GetInt("routing_delay") + alloc_delay 
+                  + config.GetInt("st_prepare_delay") + config.GetInt("st_final_delay");
+   if (m_router_delay == 0) 
+      m_router_delay = 1;
+   m_channel_latency = config.GetInt("channel_latency");
+   m_vchannel_latency = config.GetInt("vchannel_latency");
+   m_use_map = config.GetInt("use_map") != 0;
+   m_memory_node_map = config.GetIntArray("memory_node_map");
+   m_latency_offset = latency_offset;
+
+   m_n_shader = m_n_mem = 0;
+   m_next_subnet = 0;
+   m_cycle = 0;
+   m_seq = 0;
+   m_in_flight = 0;
+   m_packets = m_flits = 0;
+   m_total_latency = m_total_zero_load = m_total_hops = m_max_latency = 0;
+   m_last_zero_load = 0;
+   m_last_hops = 0;
+   m_calib_packets = 0;
+   m_calib_icnt_latency = m_calib_model_latency = m_calib_abs_error = m_calib_error = 0;
+}
+
+void analytical_icnt::create( unsigned n_shader, unsigned n_mem )
+{
+   m_n_shader = n_shader;
+   m_n_mem = n_mem;
+   unsigned nodes = n_shader + n_mem;
+   if (m_topology != TOPO_CROSSBAR && nodes > m_routers * m_c) {
+      printf("GPGPU-Sim uArch: ERROR ** analytical interconnect: %u nodes do not fit on %u routers\n", 
+             nodes, m_routers * m_c);
+      exit(1);
+   }
+
+   // same device to node placement as InterconnectInterface::_CreateNodeMap
+   m_node_map.resize(nodes);
+   if (m_use_map && !m_memory_node_map.empty()) {
+      if (m_memory_node_map.size() != n_mem) {
+         printf("GPGPU-Sim uArch: ERROR ** memory_node_map lists %u nodes for %u memory ports\n", 
+                (unsigned)m_memory_node_map.size(), n_mem);
+         exit(1);
+      }
+      std::vector<bool> is_memory(nodes, false);
+      for (unsigned m = 0; m < n_mem; m++) {
+         m_node_map[n_shader + m] = m_memory_node_map[m];
+         if ((unsigned)m_memory_node_map[m] < nodes) 
+            is_memory[m_memory_node_map[m]] = true;
+      }
+      unsigned next_node = 0;
+      for (unsigned i = 0; i < n_shader; i++) {
+         while (is_memory[next_node]) 
+            next_node++;
+         m_node_map[i] = next_node++;
+      }
+   } else {
+      for (unsigned i = 0; i < nodes; i++) 
+         m_node_map[i] = i;
+   }
+
+   unsigned ports = std::max(nodes, m_routers * m_c);
+   m_inject_free.assign(m_subnets, std::vector<unsigned long long>(ports, 0));
+   m_eject_free.assign(m_subnets, std::vector<unsigned long long>(ports, 0));
+   m_link_free.assign(m_subnets, std::vector<unsigned long long>(m_links, 0));
+   m_delivery.resize(nodes);
+}
+
+unsigned analytical_icnt::packet_flits( unsigned size, unsigned flit_size ) const
+{
+   // flit sizes are in bits, as in intersim2
+   unsigned size_n_bits = size * 8;
+   return size_n_bits / flit_size + ((size_n_bits % flit_size)? 1 : 0);
+}
+
+unsigned analytical_icnt::select_subnet( unsigned input, unsigned size, unsigned &n_flits )
+{
+   n_flits = packet_flits(size, m_flit_size);
+   switch (m_subnet_selection) {
+   case SUBNET_PCKT_TYPE:
+      return (input < m_n_shader)? 0 : 1;
+   case SUBNET_PCKT_SIZE:
+      if (size * 8 <= m_flit_size) 
+         return 0;
+      n_flits = packet_flits(size, m_asym_flit_size);
+      return 1;
+   default: {
+      // round robin and random selection both spread the load evenly, take 
+      // the subnet whose injection port frees up first
+      unsigned node = m_node_map[input];
+      unsigned best = m_next_subnet;
+      for (unsigned i = 1; i < m_subnets; i++) {
+         unsigned s = (m_next_subnet + i) % m_subnets;
+         if (m_inject_free[s][node] < m_inject_free[best][node]) 
+            best = s;
+      }
+      m_next_subnet = (best + 1) % m_subnets;
+      return best;
+   }
+   }
+}
+
+bool analytical_icnt::has_buffer( unsigned input, unsigned size ) const
+{
+   unsigned node = m_node_map[input];
+   unsigned n_flits = packet_flits(size, m_flit_size);
+   for (unsigned s = 0; s < m_subnets; s++) {
+      if (m_subnet_selection == SUBNET_PCKT_TYPE && s != ((input < m_n_shader)? 0u : 1u)) 
+         continue;
+      if (m_subnet_selection == SUBNET_PCKT_SIZE) {
+         if (s != ((size * 8 <= m_flit_size)? 0u : 1u)) 
+            continue;
+         if (s == 1) 
+            n_flits = packet_flits(size, m_asym_flit_size);
+      }
+      // flits still waiting to leave the injection port
+      unsigned long long backlog = (m_inject_free[s][node] > m_cycle)? m_inject_free[s][node] - m_cycle : 0;
+      if (backlog + n_flits <= m_input_buffer) 
+         return true;
+   }
+   return false;
+}
+
+// links crossed from router src to router dst with dimension-order routing
+void analytical_icnt::route( unsigned src, unsigned dst, std::vector<unsigned> &links ) const
+{
+   links.clear();
+   if (m_topology == TOPO_MESH3D) {
+      unsigned stack_size = m_k * m_n;
+      unsigned x = src % m_k, y = (src % stack_size) / m_k, z = src / stack_size;
+      unsigned dx = dst % m_k, dy = (dst % stack_size) / m_k, dz = dst / stack_size;
+      while (x != dx) {
+         unsigned r = z * stack_size + y * m_k + x;
+         links.push_back(r * 4 + ((x < dx)? 0 : 1));
+         x = (x < dx)? x + 1 : x - 1;
+      }
+      while (y != dy) {
+         unsigned r = z * stack_size + y * m_k + x;
+         links.push_back(r * 4 + ((y < dy)? 2 : 3));
+         y = (y < dy)? y + 1 : y - 1;
+      }
+      if (z != dz) {
+         // the vertical channel is a bus spanning the whole stack
+         unsigned column = y * m_k + x;
+         links.push_back(m_routers * 4 + column * 2 + ((z < dz)? 0 : 1));
+      }
+      return;
+   }
+
+   unsigned cur = src;
+   unsigned stride = 1;
+   for (unsigned d = 0; d < m_n; d++, stride *= m_k) {
+      unsigned c = (cur / stride) % m_k;
+      unsigned t = (dst / stride) % m_k;
+      bool up = c < t;
+      unsigned dist = up? t - c : c - t;
+      if (m_topology == TOPO_TORUS && dist > m_k / 2) {
+         // the wrap-around link is shorter
+         up = !up;
+         dist = m_k - dist;
+      }
+      for (unsigned h = 0; h < dist; h++) {
+         links.push_back(cur * 2 * m_n + d * 2 + (up? 0 : 1));
+         unsigned next = up? (c + 1) % m_k : (c + m_k - 1) % m_k;
+         cur = cur - c * stride + next * stride;
+         c = next;
+      }
+   }
+}
+
+unsigned long long analytical_icnt::schedule( unsigned input, unsigned output, unsigned size )
+{
+   unsigned n_flits;
+   unsigned subnet = select_subnet(input, size, n_flits);
+   unsigned src = m_node_map[input];
+   unsigned dst = m_node_map[output];
+
+   // every queue is held for the n_flits cycles the packet takes to pass, 
+   // the head moves on after the router pipeline and channel latency
+   unsigned long long head = std::max(m_cycle, m_inject_free[subnet][src]);
+   m_inject_free[subnet][src] = head + n_flits;
+   head += 1; // injection channel
+   unsigned long long zero_load = 1;
+
+   unsigned hops = 0;
+   if (m_topology != TOPO_CROSSBAR) {
+      route(src / m_c, dst / m_c, m_route);
+      hops = m_route.size();
+      for (unsigned h = 0; h < hops; h++) {
+         unsigned link = m_route[h];
+         unsigned latency = m_router_delay 
+            + ((m_topology == TOPO_MESH3D && link >= m_routers * 4)? m_vchannel_latency : m_channel_latency);
+         head += m_router_delay;
+         head = std::max(head, m_link_free[subnet][link]);
+         m_link_free[subnet][link] = head + n_flits;
+         head += latency - m_router_delay;
+         zero_load += latency;
+      }
+   }
+   // router at the destination and the ejection channel
+   head += m_router_delay;
+   head = std::max(head, m_eject_free[subnet][dst]);
+   m_eject_free[subnet][dst] = head + n_flits;
+   zero_load += m_router_delay + 1 + (n_flits - 1);
+
+   long long ready = (long long)(head + 1 + (n_flits - 1)) + m_latency_offset;
+   if (ready <= (long long)m_cycle) 
+      ready = m_cycle + 1;
+
+   unsigned long long latency = ready - m_cycle;
+   m_packets++;
+   m_flits += n_flits;
+   m_total_latency += latency;
+   m_total_zero_load += zero_load;
+   m_total_hops += hops;
+   m_max_latency = std::max(m_max_latency, latency);
+   return ready;
+}
+
+void analytical_icnt::push( unsigned input, unsigned output, void *data, unsigned size )
+{
+   assert(has_buffer(input, size));
+   packet p;
+   p.ready = schedule(input, output, size);
+   p.seq = m_seq++;
+   p.data = data;
+   m_delivery[output].push(p);
+   m_in_flight++;
+}
+
+void *analytical_icnt::pop( unsigned output )
+{
+   std::priority_queue<packet> &q = m_delivery[output];
+   if (q.empty() || q.top().ready > m_cycle) 
+      return NULL;
+   void *data = q.top().data;
+   q.pop();
+   m_in_flight--;
+   return data;
+}
+
+void analytical_icnt::display_overall_stats() const
+{
+   printf("icnt_analytical_packets = %llu\n", m_packets);
+   printf("icnt_analytical_flits = %llu\n", m_flits);
+   if (m_packets == 0) 
+      return;
+   double latency = (double)m_total_latency / m_packets;
+   double zero_load = (double)m_total_zero_load / m_packets;
+   printf("icnt_analytical_avg_latency = %.4f\n", latency);
+   printf("icnt_analytical_avg_zero_load_latency = %.4f\n", zero_load);
+   printf("icnt_analytical_avg_contention = %.4f\n", latency - zero_load);
+   printf("icnt_analytical_max_latency = %llu\n", m_max_latency);
+   printf("icnt_analytical_avg_hops = %.4f\n", (double)m_total_hops / m_packets);
+}
+
+void analytical_icnt::display_state( FILE *fp ) const
+{
+   fprintf(fp, "GPGPU-Sim uArch: analytical interconnect has %llu packets in flight\n", m_in_flight);
+   for (unsigned n = 0; n < m_delivery.size(); n++) {
+      if (!m_delivery[n].empty()) 
+         fprintf(fp, "   node %u: %u packets, next ready at cycle %llu\n", 
+                 n, (unsigned)m_delivery[n].size(), m_delivery[n].top().ready);
+   }
+}
+
+void analytical_icnt::calibrate_push( unsigned input, unsigned output, void *data, unsigned size )
+{
+   unsigned long long ready = schedule(input, output, size);
+   m_calib_pending[data] = std::make_pair(m_cycle, ready - m_cycle);
+}
+
+void analytical_icnt::calibrate_pop( void *data )
+{
+   std::map<void*, std::pair<unsigned long long, unsigned long long> >::iterator i = m_calib_pending.find(data);
+   if (i == m_calib_pending.end()) 
+      return;
+   double icnt_latency = (double)(m_cycle - i->second.first);
+   double model_latency = (double)i->second.second;
+   m_calib_pending.erase(i);
+
+   m_calib_packets++;
+   m_calib_icnt_latency += icnt_latency;
+   m_calib_model_latency += model_latency;
+   m_calib_error += icnt_latency - model_latency;
+   m_calib_abs_error += fabs(icnt_latency - model_latency);
+}
+
+void analytical_icnt::print_calibration( FILE *fp ) const
+{
+   fprintf(fp, "icnt_calibration_packets = %llu\n", m_calib_packets);
+   if (m_calib_packets == 0) 
+      return;
+   double icnt_latency = m_calib_icnt_latency / m_calib_packets;
+   double model_latency = m_calib_model_latency / m_calib_packets;
+   double abs_error = m_calib_abs_error / m_calib_packets;
+   fprintf(fp, "icnt_calibration_intersim_avg_latency = %.4f\n", icnt_latency);
+   fprintf(fp, "icnt_calibration_analytical_avg_latency = %.4f\n", model_latency);
+   fprintf(fp, "icnt_calibration_avg_latency_error = %.4f%%\n", 
+           (icnt_latency > 0)? 100.0 * (model_latency - icnt_latency) / icnt_latency : 0.0);
+   fprintf(fp, "icnt_calibration_mean_abs_error = %.4f (%.2f%%)\n", abs_error, 
+           (icnt_latency > 0)? 100.0 * abs_error / icnt_latency : 0.0);
+   // offset that removes the mean error, to pass as -icnt_analytical_latency_offset 
+   // on top of the one used for this run
+   fprintf(fp, "icnt_calibration_suggested_latency_offset = %d\n", 
+           m_latency_offset + (int)floor(m_calib_error / m_calib_packets + 0.5));
+}
@@ -0,0 +1,140 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef ANALYTICAL_ICNT_H
+#define ANALYTICAL_ICNT_H
+
+#include <stdio.h>
+#include <vector>
+#include <queue>
+#include <map>
+#include <string>
+
+// Fast interconnect model selected with -network_mode 2. Instead of moving 
+// flits through intersim2's routers every cycle, a packet is timed once when 
+// it is pushed: it walks its dimension-order route, and every injection port, 
+// link and ejection port along the way is a queue serving one flit per cycle. 
+// Per-hop latency comes from the router pipeline and channel latencies of the 
+// intersim2 configuration file, and contention comes from the queues. 
+// icnt_transfer() only advances the clock, so its cost does not depend on the 
+// network size or load.
+//
+// With -icnt_analytical_calibrate the model runs next to intersim2 on the 
+// same packet stream and reports how far its latencies are from intersim2's.
+class analytical_icnt {
+public:
+   analytical_icnt( const char *config_file, int latency_offset );
+
+   void create( unsigned n_shader, unsigned n_mem );
+   void init() {}
+   bool has_buffer( unsigned input, unsigned size ) const;
+   void push( unsigned input, unsigned output, void *data, unsigned size );
+   void *pop( unsigned output );
+   void transfer() { m_cycle++; }
+   bool busy() const { return m_in_flight != 0; }
+   void display_stats() const {}
+   void display_overall_stats() const;
+   void display_state( FILE *fp ) const;
+   unsigned get_flit_size() const { return m_flit_size; }
+
+   // calibration against intersim2: the packet is only timed here, 
+   // delivery is left to the cycle-level network
+   void calibrate_push( unsigned input, unsigned output, void *data, unsigned size );
+   void calibrate_pop( void *data );
+   void print_calibration( FILE *fp ) const;
+
+private:
+   enum topology_type { TOPO_CROSSBAR, TOPO_MESH, TOPO_TORUS, TOPO_MESH3D };
+
+   struct packet {
+      unsigned long long ready;  // cycle the tail flit is ejected
+      unsigned long long seq;
+      void *data;
+      bool operator<( const packet &p ) const 
+      { 
+         // min-heap on (ready, seq) with std::priority_queue
+         return (ready > p.ready) || ((ready == p.ready) && (seq > p.seq));
+      }
+   };
+
+   unsigned select_subnet( unsigned input, unsigned size, unsigned &n_flits );
+   unsigned packet_flits( unsigned size, unsigned flit_size ) const;
+   void route( unsigned src, unsigned dst, std::vector<unsigned> &links ) const;
+   unsigned long long schedule( unsigned input, unsigned output, unsigned size );
+
+   // configuration, from the intersim2 configuration file
+   topology_type m_topology;
+   unsigned m_k, m_n, m_s, m_c;
+   unsigned m_routers;
+   unsigned m_links;
+   unsigned m_subnets;
+   int m_subnet_selection;
+   unsigned m_flit_size;
+   unsigned m_asym_flit_size;
+   unsigned m_input_buffer;
+   unsigned m_router_delay;
+   unsigned m_channel_latency;
+   unsigned m_vchannel_latency;
+   int m_latency_offset;
+   std::vector<int> m_memory_node_map;
+   bool m_use_map;
+
+   unsigned m_n_shader, m_n_mem;
+   std::vector<unsigned> m_node_map;  // device id -> network node
+
+   // cycle each queue can accept the next flit, [subnet][port or link]
+   std::vector<std::vector<unsigned long long> > m_inject_free;
+   std::vector<std::vector<unsigned long long> > m_link_free;
+   std::vector<std::vector<unsigned long long> > m_eject_free;
+   unsigned m_next_subnet;
+
+   unsigned long long m_cycle;
+   unsigned long long m_seq;
+   unsigned long long m_in_flight;
+   std::vector<std::priority_queue<packet> > m_delivery;
+   std::vector<unsigned> m_route;
+
+   // statistics
+   unsigned long long m_packets;
+   unsigned long long m_flits;
+   unsigned long long m_total_latency;
+   unsigned long long m_total_zero_load;
+   unsigned long long m_total_hops;
+   unsigned long long m_max_latency;
+   unsigned long long m_last_zero_load;
+   unsigned m_last_hops;
+
+   // calibration: push cycle and predicted latency of packets in intersim2
+   std::map<void*, std::pair<unsigned long long, unsigned long long> > m_calib_pending;
+   unsigned long long m_calib_packets;
+   double m_calib_icnt_latency;
+   double m_calib_model_latency;
+   double m_calib_abs_error;
+   double m_calib_error;
+};
+
+#endif
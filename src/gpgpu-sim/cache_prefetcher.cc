@@ -0,0 +1,185 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "cache_prefetcher.h"
+#include "gpu-cache.h"
+#include "mem_fetch.h"
+#include <assert.h>
+
+// appends base + k*delta for k = 1..degree, stopping at address wrap-around
+static void push_strided( new_addr_type base, long long delta, unsigned degree, 
+                          std::vector<new_addr_type> &candidates )
+{
+    new_addr_type addr = base;
+    for (unsigned k=0; k < degree; k++) {
+        new_addr_type next = addr + (new_addr_type)delta;
+        if ( (delta > 0 && next < addr) || (delta < 0 && next > addr) ) 
+            break;
+        candidates.push_back(next);
+        addr = next;
+    }
+}
+
+class next_line_prefetcher : public cache_prefetcher {
+public:
+    next_line_prefetcher( unsigned line_sz, unsigned degree )
+    : m_line_sz(line_sz), m_degree(degree) {}
+
+    virtual void observe( new_addr_type block_addr, bool miss, const mem_fetch *mf, 
+                          std::vector<new_addr_type> &candidates )
+    {
+        if ( miss ) 
+            push_strided(block_addr,m_line_sz,m_degree,candidates);
+    }
+
+private:
+    unsigned m_line_sz;
+    unsigned m_degree;
+};
+
+// Both PC based prefetchers keep a small direct mapped table, tagged with the 
+// PC and the shader core (an L2 slice sees the loads of every core).  
+// Requests without an instruction (writebacks, prefetches of the level 
+// above) carry no PC and do not train them.
+class pc_table_prefetcher : public cache_prefetcher {
+protected:
+    static const unsigned TABLE_SIZE = 64;
+    static const unsigned CONF_MAX = 3;
+    static const unsigned CONF_PREDICT = 1; // the delta repeated at least once
+
+    struct entry {
+        entry() : m_valid(false) {}
+        bool m_valid;
+        address_type m_pc;
+        unsigned m_sid;
+        unsigned m_wid;
+        new_addr_type m_last_block;
+        long long m_delta;
+        unsigned m_conf;
+    };
+
+    pc_table_prefetcher( unsigned degree ) : m_degree(degree), m_table(TABLE_SIZE) {}
+
+    // the entry of the PC behind mf, or NULL if mf has none; a new entry 
+    // replaces whatever was in the slot
+    entry *lookup( const mem_fetch *mf, new_addr_type block_addr, bool &is_new )
+    {
+        address_type pc = mf->get_pc();
+        if ( pc == (address_type)-1 ) 
+            return NULL;
+        unsigned sid = mf->get_sid();
+        entry &e = m_table[((pc >> 2) ^ (sid * 0x9E37U)) % TABLE_SIZE];
+        is_new = !e.m_valid || e.m_pc != pc || e.m_sid != sid;
+        if ( is_new ) {
+            e.m_valid = true;
+            e.m_pc = pc;
+            e.m_sid = sid;
+            e.m_wid = mf->get_wid();
+            e.m_last_block = block_addr;
+            e.m_delta = 0;
+            e.m_conf = 0;
+        }
+        return &e;
+    }
+
+    // train e on a new delta; returns true once the delta is trusted
+    static bool train( entry &e, long long delta )
+    {
+        if ( delta == e.m_delta ) {
+            if ( e.m_conf < CONF_MAX ) 
+                e.m_conf++;
+        } else {
+            e.m_delta = delta;
+            e.m_conf = 0;
+        }
+        return e.m_conf >= CONF_PREDICT;
+    }
+
+    unsigned m_degree;
+    std::vector<entry> m_table;
+};
+
+class stride_prefetcher : public pc_table_prefetcher {
+public:
+    stride_prefetcher( unsigned degree ) : pc_table_prefetcher(degree) {}
+
+    virtual void observe( new_addr_type block_addr, bool miss, const mem_fetch *mf, 
+                          std::vector<new_addr_type> &candidates )
+    {
+        bool is_new;
+        entry *e = lookup(mf,block_addr,is_new);
+        if ( !e || is_new ) 
+            return;
+        long long delta = (long long)(block_addr - e->m_last_block);
+        if ( delta == 0 ) 
+            return; // another access to the same line tells nothing
+        e->m_last_block = block_addr;
+        if ( train(*e,delta) ) 
+            push_strided(block_addr,delta,m_degree,candidates);
+    }
+};
+
+class warp_stride_prefetcher : public pc_table_prefetcher {
+public:
+    warp_stride_prefetcher( unsigned degree ) : pc_table_prefetcher(degree) {}
+
+    virtual void observe( new_addr_type block_addr, bool miss, const mem_fetch *mf, 
+                          std::vector<new_addr_type> &candidates )
+    {
+        unsigned wid = mf->get_wid();
+        if ( wid == (unsigned)-1 ) 
+            return;
+        bool is_new;
+        entry *e = lookup(mf,block_addr,is_new);
+        if ( !e || is_new || wid == e->m_wid ) 
+            return; // only the first line a warp touches is compared
+        long long dw = (long long)wid - (long long)e->m_wid;
+        long long delta = (long long)(block_addr - e->m_last_block);
+        e->m_wid = wid;
+        e->m_last_block = block_addr;
+        if ( delta == 0 || delta % dw != 0 ) {
+            e->m_conf = 0;
+            return;
+        }
+        if ( train(*e,delta/dw) ) 
+            push_strided(block_addr,e->m_delta,m_degree,candidates);
+    }
+};
+
+cache_prefetcher *create_prefetcher( const cache_config &config )
+{
+    unsigned degree = config.get_prefetch_degree();
+    switch ( config.get_prefetcher() ) {
+    case PREFETCH_NONE:        return NULL;
+    case PREFETCH_NEXT_LINE:   return new next_line_prefetcher(config.get_line_sz(),degree);
+    case PREFETCH_STRIDE_PC:   return new stride_prefetcher(degree);
+    case PREFETCH_WARP_STRIDE: return new warp_stride_prefetcher(degree);
+    default: abort();
+    }
+    return NULL;
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef CACHE_PREFETCHER_H
+#define CACHE_PREFETCHER_H
+
+#include <vector>
+#include "../abstract_hardware_model.h"
+
+class cache_config;
+class mem_fetch;
+
+// Hardware prefetcher of a data_cache, selected with -gpgpu_l1d_prefetcher / 
+// -gpgpu_l2_prefetcher "<type>:<degree>:<max in flight>" where type is
+//   N = next-line: on a miss, the next <degree> lines
+//   S = stride per PC: a reference prediction table of (pc, last block, 
+//       stride, confidence) entries; once a PC repeats its stride the next 
+//       <degree> strides ahead are fetched
+//   W = inter-warp stride: the warps of a CTA tend to run the same load on 
+//       consecutive chunks, so the table keeps, per PC, the last warp and the 
+//       block distance per warp id; once confirmed, the lines the next 
+//       <degree> warps will ask for are fetched
+// The cache only trains the prefetcher on demand reads and only issues a 
+// candidate that is neither cached nor already in the MSHRs.
+class cache_prefetcher {
+public:
+    virtual ~cache_prefetcher() {}
+
+    // demand read of block_addr (a hit or a miss); appends the block 
+    // addresses worth fetching to 'candidates'
+    virtual void observe( new_addr_type block_addr, bool miss, const mem_fetch *mf, 
+                          std::vector<new_addr_type> &candidates ) = 0;
+};
+
+cache_prefetcher *create_prefetcher( const cache_config &config );
+
+#endif
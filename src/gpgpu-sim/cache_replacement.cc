@@ -0,0 +1,257 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "cache_replacement.h"
+#include "gpu-cache.h"
+#include "mem_fetch.h"
+#include <assert.h>
+#include <algorithm>
+
+// LRU and FIFO replace the valid line with the oldest access or allocation 
+// time, which tag_array keeps in cache_block_t
+class timestamp_policy : public cache_replacement_policy {
+public:
+    timestamp_policy( const cache_block_t *lines, unsigned assoc, bool fifo )
+    : m_lines(lines), m_assoc(assoc), m_fifo(fifo) {}
+
+    virtual unsigned victim( unsigned base, const unsigned long long *valid ) const
+    {
+        unsigned valid_line = (unsigned)-1;
+        unsigned valid_timestamp = (unsigned)-1;
+        for (unsigned w=0; w*64 < m_assoc; w++) {
+            for (unsigned long long v = valid[w]; v; v &= v-1) {
+                unsigned index = base + w*64 + __builtin_ctzll(v);
+                const cache_block_t &line = m_lines[index];
+                unsigned t = m_fifo? line.m_alloc_time : line.m_last_access_time;
+                if ( t < valid_timestamp ) {
+                    valid_timestamp = t;
+                    valid_line = index;
+                }
+            }
+        }
+        if ( valid_line == (unsigned)-1 ) 
+            abort(); // if an unreserved block exists, it is either invalid or replaceable 
+        return valid_line;
+    }
+
+private:
+    const cache_block_t *m_lines;
+    unsigned m_assoc;
+    bool m_fifo;
+};
+
+// Re-reference interval prediction (Jaleel et al., ISCA 2010) with 2-bit 
+// RRPVs and hit priority promotion.  Subclasses choose the insertion RRPV.
+class rrip_policy : public cache_replacement_policy {
+public:
+    rrip_policy( unsigned n_lines, unsigned assoc )
+    : m_assoc(assoc), m_rrpv(n_lines,RRPV_MAX) {}
+
+    // SRRIP ages the set until some line reaches RRPV_MAX; the first line to 
+    // get there is the first one with the largest RRPV.  The ageing itself is 
+    // applied in on_insert() so that victim() can stay const.
+    virtual unsigned victim( unsigned base, const unsigned long long *valid ) const
+    {
+        unsigned victim_line = (unsigned)-1;
+        int max_rrpv = -1;
+        for (unsigned w=0; w*64 < m_assoc; w++) {
+            for (unsigned long long v = valid[w]; v; v &= v-1) {
+                unsigned index = base + w*64 + __builtin_ctzll(v);
+                if ( m_rrpv[index] > max_rrpv ) {
+                    max_rrpv = m_rrpv[index];
+                    victim_line = index;
+                }
+            }
+        }
+        assert( victim_line != (unsigned)-1 );
+        return victim_line;
+    }
+    virtual void on_hit( unsigned idx, const mem_fetch *mf ) 
+    { 
+        m_rrpv[idx] = 0; 
+    }
+    virtual void on_insert( unsigned idx, bool evict, const mem_fetch *mf )
+    {
+        if ( evict ) 
+            age(idx);
+        m_rrpv[idx] = insert_rrpv(idx,mf);
+    }
+    virtual void reset()
+    {
+        std::fill(m_rrpv.begin(), m_rrpv.end(), RRPV_MAX-1);
+    }
+
+protected:
+    static const unsigned char RRPV_MAX = 3;
+
+    virtual unsigned char insert_rrpv( unsigned idx, const mem_fetch *mf ) = 0;
+
+    void age( unsigned victim_line )
+    {
+        unsigned delta = RRPV_MAX - m_rrpv[victim_line];
+        if ( delta == 0 ) 
+            return;
+        unsigned base = victim_line - victim_line % m_assoc;
+        for (unsigned way=0; way < m_assoc; way++) {
+            unsigned r = m_rrpv[base+way] + delta;
+            m_rrpv[base+way] = (r > RRPV_MAX)? RRPV_MAX : r;
+        }
+    }
+
+    unsigned m_assoc;
+    std::vector<unsigned char> m_rrpv;
+};
+
+const unsigned char rrip_policy::RRPV_MAX;
+
+// Static RRIP: insert with a long re-reference interval
+class srrip_policy : public rrip_policy {
+public:
+    srrip_policy( unsigned n_lines, unsigned assoc ) : rrip_policy(n_lines,assoc) {}
+protected:
+    virtual unsigned char insert_rrpv( unsigned idx, const mem_fetch *mf ) { return RRPV_MAX-1; }
+};
+
+// Bimodal RRIP: insert with a distant re-reference interval, except for one
+// in BRRIP_EPSILON insertions (deterministic so that runs are repeatable)
+class brrip_policy : public rrip_policy {
+public:
+    brrip_policy( unsigned n_lines, unsigned assoc ) : rrip_policy(n_lines,assoc), m_count(0) {}
+protected:
+    static const unsigned BRRIP_EPSILON = 32;
+
+    virtual unsigned char insert_rrpv( unsigned idx, const mem_fetch *mf ) { return brrip_rrpv(); }
+    unsigned char brrip_rrpv()
+    {
+        if ( ++m_count == BRRIP_EPSILON ) {
+            m_count = 0;
+            return RRPV_MAX-1;
+        }
+        return RRPV_MAX;
+    }
+    unsigned m_count;
+};
+
+// Dynamic RRIP: one set in every DUEL_PERIOD always uses SRRIP and another 
+// always uses BRRIP; misses in them move a saturating selector that decides
+// the insertion policy of all other sets
+class drrip_policy : public brrip_policy {
+public:
+    drrip_policy( unsigned n_lines, unsigned assoc ) 
+    : brrip_policy(n_lines,assoc), m_psel(PSEL_MAX/2) {}
+protected:
+    static const unsigned DUEL_PERIOD = 32;
+    static const unsigned PSEL_MAX = 1023;
+
+    virtual unsigned char insert_rrpv( unsigned idx, const mem_fetch *mf )
+    {
+        unsigned leader = (idx / m_assoc) % DUEL_PERIOD;
+        bool use_brrip;
+        if ( leader == 0 ) {
+            if ( m_psel < PSEL_MAX ) m_psel++;
+            use_brrip = false;
+        } else if ( leader == 1 ) {
+            if ( m_psel > 0 ) m_psel--;
+            use_brrip = true;
+        } else {
+            use_brrip = m_psel > PSEL_MAX/2;
+        }
+        return use_brrip? brrip_rrpv() : (unsigned char)(RRPV_MAX-1);
+    }
+    unsigned m_psel;
+};
+
+// SHiP-PC (Wu et al., MICRO 2011): SRRIP whose insertion RRPV comes from a 
+// table of saturating counters indexed by a hash of the PC of the 
+// instruction that missed.  A counter goes up when a line brought in by that
+// PC is hit and down when such a line is evicted without reuse.
+class ship_policy : public rrip_policy {
+public:
+    ship_policy( unsigned n_lines, unsigned assoc ) 
+    : rrip_policy(n_lines,assoc), m_shct(SHCT_SIZE,1), m_signature(n_lines,0), m_reused(n_lines,false) {}
+
+    virtual void on_hit( unsigned idx, const mem_fetch *mf ) 
+    { 
+        rrip_policy::on_hit(idx,mf);
+        m_reused[idx] = true;
+        if ( m_shct[m_signature[idx]] < SHCT_MAX ) 
+            m_shct[m_signature[idx]]++;
+    }
+    virtual void on_insert( unsigned idx, bool evict, const mem_fetch *mf )
+    {
+        if ( evict && !m_reused[idx] && m_shct[m_signature[idx]] > 0 ) 
+            m_shct[m_signature[idx]]--;
+        m_signature[idx] = signature(mf);
+        m_reused[idx] = false;
+        rrip_policy::on_insert(idx,evict,mf);
+    }
+    virtual void reset()
+    {
+        rrip_policy::reset();
+        // loaded lines have no known signature; don't let them train
+        std::fill(m_reused.begin(), m_reused.end(), true);
+    }
+
+protected:
+    static const unsigned SHCT_SIZE = 16384;
+    static const unsigned char SHCT_MAX = 7;
+
+    virtual unsigned char insert_rrpv( unsigned idx, const mem_fetch *mf ) 
+    { 
+        return (m_shct[m_signature[idx]] == 0)? RRPV_MAX : RRPV_MAX-1; 
+    }
+    static unsigned signature( const mem_fetch *mf )
+    {
+        // writebacks and warm-up fills carry no instruction
+        if ( mf == NULL ) 
+            return 0;
+        unsigned pc = mf->get_pc();
+        return (pc ^ (pc >> 14)) & (SHCT_SIZE-1);
+    }
+
+    std::vector<unsigned char> m_shct;
+    std::vector<unsigned> m_signature;
+    std::vector<bool> m_reused;
+};
+
+cache_replacement_policy *create_replacement_policy( const cache_config &config, 
+                                                     const cache_block_t *lines, 
+                                                     unsigned n_lines )
+{
+    unsigned assoc = config.get_assoc();
+    switch ( config.get_replacement_policy() ) {
+    case LRU:   return new timestamp_policy(lines,assoc,false);
+    case FIFO:  return new timestamp_policy(lines,assoc,true);
+    case SRRIP: return new srrip_policy(n_lines,assoc);
+    case BRRIP: return new brrip_policy(n_lines,assoc);
+    case DRRIP: return new drrip_policy(n_lines,assoc);
+    case SHIP_PC: return new ship_policy(n_lines,assoc);
+    default: abort();
+    }
+    return NULL;
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef CACHE_REPLACEMENT_H
+#define CACHE_REPLACEMENT_H
+
+#include <vector>
+
+struct cache_block_t;
+class cache_config;
+class mem_fetch;
+
+// Replacement and insertion policy of a tag_array, selected by the first 
+// letter of the second field of a cache configuration string:
+//   L = LRU, F = FIFO, S = SRRIP, B = BRRIP, D = DRRIP (set dueling), 
+//   P = SHiP-PC (SRRIP with a PC signature reuse predictor)
+//
+// Lines are named by their tag_array index (set*assoc + way).  tag_array 
+// asks for a victim only when every unreserved way of the set is valid, and
+// tells the policy about every hit and every line it (re)allocates.
+class cache_replacement_policy {
+public:
+    virtual ~cache_replacement_policy() {}
+
+    // victim among the ways of the set starting at 'base' whose bit is set in
+    // 'valid' (one 64-bit word per 64 ways); must not change policy state
+    virtual unsigned victim( unsigned base, const unsigned long long *valid ) const = 0;
+    // line idx hit (or hit a pending miss)
+    virtual void on_hit( unsigned idx, const mem_fetch *mf ) {}
+    // line idx is allocated for a new block; 'evict' is set if it held a 
+    // valid block, i.e. idx came from victim()
+    virtual void on_insert( unsigned idx, bool evict, const mem_fetch *mf ) {}
+    // forget per-line state, e.g. after the lines were loaded from a checkpoint
+    virtual void reset() {}
+};
+
+cache_replacement_policy *create_replacement_policy( const cache_config &config, 
+                                                     const cache_block_t *lines, 
+                                                     unsigned n_lines );
+
+#endif
@@ -0,0 +1,174 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "checkpoint.h"
+#include "gpu-sim.h"
+#include "shader.h"
+#include "l2cache.h"
+#include "mem_latency_stat.h"
+
+#include <string.h>
+
+extern unsigned g_ptx_sim_num_insn;
+
+// A checkpoint is taken right before a kernel launch is handed to the 
+// simulator. It holds what the application cannot rebuild by replaying its 
+// host code: the contents of device memory, the cache tag arrays with their 
+// statistics, and the running totals the end of kernel statistics build on 
+// (shader core, memory latency and DRAM counters). The resumed run 
+// re-executes the host code (allocations, copies, PTX loading and stream 
+// operations) but skips every kernel launch before the checkpointed one. 
+// Interconnect statistics, the DRAM queue length histogram and the power 
+// model are not part of the checkpoint and restart from zero.
+
+bool gpgpu_sim::resume_skips_kernel( const kernel_info_t &kernel ) const
+{
+   return m_config.resume_kernel && kernel.get_uid() < m_config.resume_kernel;
+}
+
+void gpgpu_sim::checkpoint_kernel_launch( const kernel_info_t &kernel )
+{
+   if( m_config.checkpoint_kernel && kernel.get_uid() == m_config.checkpoint_kernel )
+      save_checkpoint(kernel);
+   if( m_config.resume_kernel && kernel.get_uid() == m_config.resume_kernel )
+      load_checkpoint(kernel);
+}
+
+void gpgpu_sim::save_checkpoint( const kernel_info_t &kernel )
+{
+   for( unsigned n=0; n < m_running_kernels.size(); n++ ) {
+      if( m_running_kernels[n] && !m_running_kernels[n]->done() ) {
+         printf("GPGPU-Sim: ERROR ** kernel %u is still running when kernel %u is launched, cannot checkpoint "
+                "(serialize the launches, e.g. with CUDA_LAUNCH_BLOCKING=1)\n", 
+                m_running_kernels[n]->get_uid(), kernel.get_uid() );
+         exit(1);
+      }
+   }
+   FILE *fp = fopen(m_config.checkpoint_file,"wb");
+   if( fp == NULL ) {
+      printf("GPGPU-Sim: ERROR ** could not open checkpoint file %s for writing\n", m_config.checkpoint_file);
+      exit(1);
+   }
+   printf("GPGPU-Sim: saving checkpoint before kernel %u \'%s\' to %s\n", 
+          kernel.get_uid(), kernel.name().c_str(), m_config.checkpoint_file );
+
+   unsigned magic = CHECKPOINT_MAGIC;
+   unsigned version = CHECKPOINT_VERSION;
+   checkpoint_write(fp,magic);
+   checkpoint_write(fp,version);
+   checkpoint_write(fp,kernel.get_uid());
+   checkpoint_write_string(fp,kernel.name());
+
+   // cache line timestamps are absolute cycles, so the time base goes first
+   unsigned long long tot_cycle = gpu_tot_sim_cycle + gpu_sim_cycle;
+   unsigned long long tot_insn = gpu_tot_sim_insn + gpu_sim_insn;
+   checkpoint_write(fp,tot_cycle);
+   checkpoint_write(fp,tot_insn);
+   checkpoint_write(fp,gpu_tot_issued_cta);
+   checkpoint_write(fp,g_ptx_sim_num_insn);
+
+   save_memory(fp);
+
+   checkpoint_write(fp,m_shader_config->n_simt_clusters);
+   checkpoint_write(fp,m_memory_config->m_n_mem_sub_partition);
+   for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) 
+      m_cluster[i]->save_caches(fp);
+   for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++) 
+      m_memory_sub_partition[i]->save_L2(fp);
+
+   checkpoint_write(fp,m_memory_config->m_n_mem);
+   m_shader_stats->checkpoint_io(fp,true);
+   m_memory_stats->checkpoint_io(fp,true);
+   for (unsigned i=0;i<m_memory_config->m_n_mem;i++) 
+      m_memory_partition_unit[i]->checkpoint_dram_stats(fp,true);
+
+   if( fclose(fp) != 0 ) 
+      checkpoint_fail("write");
+}
+
+void gpgpu_sim::load_checkpoint( const kernel_info_t &kernel )
+{
+   FILE *fp = fopen(m_config.checkpoint_file,"rb");
+   if( fp == NULL ) {
+      printf("GPGPU-Sim: ERROR ** could not open checkpoint file %s\n", m_config.checkpoint_file);
+      exit(1);
+   }
+   printf("GPGPU-Sim: restoring checkpoint %s at kernel %u \'%s\'\n", 
+          m_config.checkpoint_file, kernel.get_uid(), kernel.name().c_str() );
+
+   unsigned magic, version, uid;
+   checkpoint_read(fp,magic);
+   checkpoint_read(fp,version);
+   if( magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION ) {
+      printf("GPGPU-Sim: ERROR ** %s is not a checkpoint of this simulator version\n", m_config.checkpoint_file);
+      exit(1);
+   }
+   checkpoint_read(fp,uid);
+   std::string name = checkpoint_read_string(fp);
+   if( uid != kernel.get_uid() || name != kernel.name() ) {
+      printf("GPGPU-Sim: ERROR ** checkpoint was taken before kernel %u \'%s\', resuming at kernel %u \'%s\'\n", 
+             uid, name.c_str(), kernel.get_uid(), kernel.name().c_str() );
+      exit(1);
+   }
+
+   unsigned long long tot_cycle, tot_insn;
+   checkpoint_read(fp,tot_cycle);
+   checkpoint_read(fp,tot_insn);
+   checkpoint_read(fp,gpu_tot_issued_cta);
+   checkpoint_read(fp,g_ptx_sim_num_insn);
+   gpu_tot_sim_cycle = tot_cycle - gpu_sim_cycle;
+   gpu_tot_sim_insn = tot_insn - gpu_sim_insn;
+
+   load_memory(fp);
+
+   unsigned n_clusters, n_sub_partitions;
+   checkpoint_read(fp,n_clusters);
+   checkpoint_read(fp,n_sub_partitions);
+   if( n_clusters != m_shader_config->n_simt_clusters || n_sub_partitions != m_memory_config->m_n_mem_sub_partition ) {
+      printf("GPGPU-Sim: ERROR ** checkpoint has %u SIMT clusters and %u memory sub partitions, configuration has %u and %u\n",
+             n_clusters, n_sub_partitions, m_shader_config->n_simt_clusters, m_memory_config->m_n_mem_sub_partition );
+      exit(1);
+   }
+   for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) 
+      m_cluster[i]->load_caches(fp);
+   for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++) 
+      m_memory_sub_partition[i]->load_L2(fp);
+
+   unsigned n_mem;
+   checkpoint_read(fp,n_mem);
+   if( n_mem != m_memory_config->m_n_mem ) {
+      printf("GPGPU-Sim: ERROR ** checkpoint has %u memory partitions, configuration has %u\n",
+             n_mem, m_memory_config->m_n_mem );
+      exit(1);
+   }
+   m_shader_stats->checkpoint_io(fp,false);
+   m_memory_stats->checkpoint_io(fp,false);
+   for (unsigned i=0;i<m_memory_config->m_n_mem;i++) 
+      m_memory_partition_unit[i]->checkpoint_dram_stats(fp,false);
+
+   fclose(fp);
+}
@@ -0,0 +1,138 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <map>
+
+// Kernel boundary checkpoints (-checkpoint_kernel/-resume_kernel) are raw 
+// binary dumps in host byte order. They are only meant to be read back by the 
+// same simulator build running the same application and configuration.
+
+#define CHECKPOINT_MAGIC   0x4b435047 // "GPCK"
+#define CHECKPOINT_VERSION 5
+
+inline void checkpoint_fail( const char *what )
+{
+   printf("GPGPU-Sim: ERROR ** checkpoint %s failed (file truncated or not writable)\n", what);
+   exit(1);
+}
+
+inline void checkpoint_write_bytes( FILE *fp, const void *data, size_t n )
+{
+   if( n && fwrite(data,n,1,fp) != 1 ) 
+      checkpoint_fail("write");
+}
+
+inline void checkpoint_read_bytes( FILE *fp, void *data, size_t n )
+{
+   if( n && fread(data,n,1,fp) != 1 ) 
+      checkpoint_fail("read");
+}
+
+template<class T> void checkpoint_write( FILE *fp, const T &value )
+{
+   checkpoint_write_bytes(fp,&value,sizeof(T));
+}
+
+template<class T> void checkpoint_read( FILE *fp, T &value )
+{
+   checkpoint_read_bytes(fp,&value,sizeof(T));
+}
+
+// Statistics classes list their counters once, in checkpoint_io(fp,save), 
+// and the helpers below either write or read them depending on 'save'.
+template<class T> void checkpoint_io( FILE *fp, bool save, T &value )
+{
+   if( save ) checkpoint_write(fp,value);
+   else checkpoint_read(fp,value);
+}
+
+template<class T> void checkpoint_io_array( FILE *fp, bool save, T *values, size_t n )
+{
+   if( save ) checkpoint_write_bytes(fp,values,n*sizeof(T));
+   else checkpoint_read_bytes(fp,values,n*sizeof(T));
+}
+
+template<class T> void checkpoint_io( FILE *fp, bool save, std::vector<T> &values )
+{
+   unsigned n = values.size();
+   checkpoint_io(fp,save,n);
+   values.resize(n);
+   for( unsigned i=0; i < n; i++ ) 
+      checkpoint_io(fp,save,values[i]);
+}
+
+inline void checkpoint_write_string( FILE *fp, const std::string &s )
+{
+   unsigned n = s.size();
+   checkpoint_write(fp,n);
+   checkpoint_write_bytes(fp,s.data(),n);
+}
+
+inline std::string checkpoint_read_string( FILE *fp )
+{
+   unsigned n;
+   checkpoint_read(fp,n);
+   std::string s(n,'\0');
+   if( n ) 
+      checkpoint_read_bytes(fp,&s[0],n);
+   return s;
+}
+
+inline void checkpoint_io( FILE *fp, bool save, std::string &s )
+{
+   if( save ) checkpoint_write_string(fp,s);
+   else s = checkpoint_read_string(fp);
+}
+
+template<class K, class V> void checkpoint_io( FILE *fp, bool save, std::map<K,V> &values )
+{
+   unsigned n = values.size();
+   checkpoint_io(fp,save,n);
+   if( save ) {
+      for( typename std::map<K,V>::iterator i=values.begin(); i != values.end(); ++i ) {
+         K key = i->first;
+         checkpoint_io(fp,save,key);
+         checkpoint_io(fp,save,i->second);
+      }
+   } else {
+      values.clear();
+      for( unsigned i=0; i < n; i++ ) {
+         K key;
+         checkpoint_io(fp,save,key);
+         checkpoint_io(fp,save,values[key]);
+      }
+   }
+}
+
+#endif
@@ -35,12 +35,9 @@
 #include "../statwrapper.h"
 #include "gpu-misc.h"
 
-template <class T>
-struct fifo_data {
-   T *m_data;
-   fifo_data *m_next;
-};
-
+// Fixed-capacity circular buffer of m_max_len slots. A NULL slot models a
+// pipeline bubble: the queue is padded with NULL entries up to m_min_len so
+// that data pushed into it takes at least m_min_len pops to reach the head.
 template <class T> 
 class fifo_pipeline {
 public:
@@ -52,59 +49,37 @@ public:
       m_max_len = maxlen;
       m_length = 0;
       m_n_element = 0;
-      m_head = NULL;
-      m_tail = NULL;
+      m_head = 0;
+      m_slots = new T*[m_max_len];
       for (unsigned i=0;i<m_min_len;i++) 
          push(NULL);
    }
 
    ~fifo_pipeline() 
    {
-      while (m_head) {
-         m_tail = m_head;
-         m_head = m_head->m_next;
-         delete m_tail;
-      }
+      delete[] m_slots;
    }
 
    void push(T* data ) 
    {
       assert(m_length < m_max_len);
-      if (m_head) {
-         if (m_tail->m_data || m_length < m_min_len) {
-            m_tail->m_next = new fifo_data<T>();
-            m_tail = m_tail->m_next;
-            m_length++;
-            m_n_element++;
-         }
-      } else {
-         m_head = m_tail = new fifo_data<T>();
+      // a trailing NULL beyond the minimum length is a bubble that data can 
+      // take over; otherwise data goes into a new slot
+      if (m_length == 0 || m_slots[tail()] || m_length < m_min_len) {
          m_length++;
          m_n_element++;
       }
-      m_tail->m_next = NULL;
-      m_tail->m_data = data;
+      m_slots[tail()] = data;
    }
 
    T* pop() 
    {
-      fifo_data<T>* next;
       T* data;
-      if (m_head) {
-        next = m_head->m_next;
-        data = m_head->m_data;
-        if ( m_head == m_tail ) {
-           assert( next == NULL );
-           m_tail = NULL;     
-        }
-        delete m_head;
-        m_head = next;
-        m_length--;
-        if (m_length == 0) {
-           assert( m_head == NULL );
-           m_tail = m_head;
-        }
-        m_n_element--; 
+      if (m_length) {
+         data = m_slots[m_head];
+         m_head = (m_head+1 == m_max_len)? 0 : m_head+1;
+         m_length--;
+         m_n_element--; 
          if (m_min_len && m_length < m_min_len) {
             push(NULL);
             m_n_element--; // uncount NULL elements inserted to create delays
@@ -117,8 +92,8 @@ public:
 
    T* top() const
    {
-      if (m_head) {
-         return m_head->m_data;
+      if (m_length) {
+         return m_slots[m_head];
       } else {
          return NULL;
       }
@@ -136,24 +111,15 @@ public:
          }
       } else {
          // in this branch imply that the original min_len is larger then 0
-         // ie. head != 0
-         assert(m_head);
+         // ie. length != 0
+         assert(m_length);
          m_min_len = new_min_len;
-         while ((m_length > m_min_len) && (m_tail->m_data == 0)) {
-            fifo_data<T> *iter;
-            iter = m_head;
-            while (iter && (iter->m_next != m_tail))
-               iter = iter->m_next;
-            if (!iter) {
-               // there is only one node, and that node is empty
-               assert(m_head->m_data == 0);
+         while ((m_length > m_min_len) && (m_slots[tail()] == 0)) {
+            if (m_length == 1) {
+               // there is only one slot, and that slot is empty
                pop();
             } else {
-               // there are more than one node, and tail node is empty
-               assert(iter->m_next == m_tail);
-               delete m_tail;
-               m_tail = iter;
-               m_tail->m_next = 0;
+               // there are more than one slot, and tail slot is empty
                m_length--;
             }
          }
@@ -161,23 +127,26 @@ public:
    }
 
    bool full() const { return (m_max_len && m_length >= m_max_len); }
-   bool empty() const { return m_head == NULL; }
+   bool empty() const { return m_length == 0; }
    unsigned get_n_element() const { return m_n_element; }
    unsigned get_length() const { return m_length; }
    unsigned get_max_len() const { return m_max_len; }
 
    void print() const
    {
-      fifo_data<T>* ddp = m_head;
       printf("%s(%d): ", m_name, m_length);
-      while (ddp) {
-         printf("%p ", ddp->m_data);
-         ddp = ddp->m_next;
-      }
+      for (unsigned i=0; i < m_length; i++) 
+         printf("%p ", m_slots[(m_head+i)%m_max_len]);
       printf("\n");
    }
 
 private:
+   unsigned tail() const
+   {
+      unsigned t = m_head + m_length - 1;
+      return (t >= m_max_len)? t - m_max_len : t;
+   }
+
    const char* m_name;
 
    unsigned int m_min_len;
@@ -185,8 +154,8 @@ private:
    unsigned int m_length;
    unsigned int m_n_element;
 
-   fifo_data<T> *m_head;
-   fifo_data<T> *m_tail;
+   T **m_slots;
+   unsigned int m_head;
 };
 
 #endif
@@ -33,6 +33,8 @@
 #include "dram_sched.h"
 #include "mem_fetch.h"
 #include "l2cache.h"
+#include "stat_registry.h"
+#include "checkpoint.h"
 
 #ifdef DRAM_VERIFY
 int PRINT_CYCLE = 0;
@@ -474,6 +476,57 @@ void dram_t::visualize() const
       m_frfcfs_scheduler->print(stdout);
 }
 
+void dram_t::reg_stats( stat_registry &reg ) const
+{
+   reg.reg_unit("dram_n_cmd", id, &n_cmd);
+   reg.reg_unit("dram_n_nop", id, &n_nop);
+   reg.reg_unit("dram_n_act", id, &n_act);
+   reg.reg_unit("dram_n_pre", id, &n_pre);
+   reg.reg_unit("dram_n_req", id, &n_req);
+   reg.reg_unit("dram_n_rd", id, &n_rd);
+   reg.reg_unit("dram_n_write", id, &n_wr);
+   reg.reg_unit("dram_n_activity", id, &n_activity);
+   reg.reg_unit("dram_bwutil", id, &bwutil);
+   reg.reg_unit("dram_max_mrqs", id, &max_mrqs);
+   reg.reg_unit("dram_ave_mrqs", id, &ave_mrqs);
+   reg.reg(stat_registry::indexed("dram_util_bins",id), dram_util_bins, 10);
+   reg.reg(stat_registry::indexed("dram_eff_bins",id), dram_eff_bins, 10);
+}
+
+void dram_t::checkpoint_io( FILE *fp, bool save )
+{
+   ::checkpoint_io(fp,save,dram_util_bins);
+   ::checkpoint_io(fp,save,dram_eff_bins);
+   ::checkpoint_io(fp,save,last_n_cmd);
+   ::checkpoint_io(fp,save,last_n_activity);
+   ::checkpoint_io(fp,save,last_bwutil);
+   ::checkpoint_io(fp,save,n_cmd);
+   ::checkpoint_io(fp,save,n_activity);
+   ::checkpoint_io(fp,save,n_nop);
+   ::checkpoint_io(fp,save,n_act);
+   ::checkpoint_io(fp,save,n_pre);
+   ::checkpoint_io(fp,save,n_rd);
+   ::checkpoint_io(fp,save,n_wr);
+   ::checkpoint_io(fp,save,n_req);
+   ::checkpoint_io(fp,save,max_mrqs_temp);
+   ::checkpoint_io(fp,save,bwutil);
+   ::checkpoint_io(fp,save,max_mrqs);
+   ::checkpoint_io(fp,save,ave_mrqs);
+   ::checkpoint_io(fp,save,n_cmd_partial);
+   ::checkpoint_io(fp,save,n_activity_partial);
+   ::checkpoint_io(fp,save,n_nop_partial);
+   ::checkpoint_io(fp,save,n_act_partial);
+   ::checkpoint_io(fp,save,n_pre_partial);
+   ::checkpoint_io(fp,save,n_req_partial);
+   ::checkpoint_io(fp,save,ave_mrqs_partial);
+   ::checkpoint_io(fp,save,bwutil_partial);
+   for (unsigned i=0;i<m_config->nbk;i++) {
+      ::checkpoint_io(fp,save,bk[i]->n_access);
+      ::checkpoint_io(fp,save,bk[i]->n_writes);
+      ::checkpoint_io(fp,save,bk[i]->n_idle);
+   }
+}
+
 void dram_t::print_stat( FILE* simFile ) 
 {
    fprintf(simFile,"DRAM (%d): n_cmd=%d n_nop=%d n_act=%d n_pre=%d n_req=%d n_rd=%d n_write=%d bw_util=%.4g ",
@@ -97,6 +97,7 @@ public:
 
    bool full() const;
    void print( FILE* simFile ) const;
+   void reg_stats( class stat_registry &reg ) const;
    void visualize() const;
    void print_stat( FILE* simFile );
    unsigned que_length() const; 
@@ -109,6 +110,8 @@ public:
    void push( class mem_fetch *data );
    void cycle();
    void dram_log (int task);
+   // save (or restore) the access counters to a kernel boundary checkpoint
+   void checkpoint_io( FILE *fp, bool save );
 
    class memory_partition_unit *m_memory_partition_unit;
    unsigned int id;
@@ -31,33 +31,192 @@
 #include "../abstract_hardware_model.h"
 #include "mem_latency_stat.h"
 
+const unsigned frfcfs_scheduler::NIL;
+
 frfcfs_scheduler::frfcfs_scheduler( const memory_config *config, dram_t *dm, memory_stats_t *stats )
 {
    m_config = config;
    m_stats = stats;
    m_num_pending = 0;
    m_dram = dm;
-   m_queue = new std::list<dram_req_t*>[m_config->nbk];
-   m_bins = new std::map<unsigned,std::list<std::list<dram_req_t*>::iterator> >[ m_config->nbk ];
-   m_last_row = new std::list<std::list<dram_req_t*>::iterator>*[ m_config->nbk ];
+   if ( m_config->frfcfs_policy != DRAM_SCHED_FRFCFS &&
+        m_config->frfcfs_policy != DRAM_SCHED_FRFCFS_CAP &&
+        m_config->frfcfs_policy != DRAM_SCHED_BLISS ) {
+      printf("GPGPU-Sim uArch: ERROR ** unknown -gpgpu_frfcfs_policy %d\n", (int)m_config->frfcfs_policy);
+      exit(1);
+   }
+
+   // preallocate the request slots; an unlimited queue grows the pool on demand
+   unsigned n_slots = m_config->gpgpu_frfcfs_dram_sched_queue_size;
+   if ( n_slots == 0 )
+      n_slots = 64;
+   m_slots.resize(n_slots);
+   for ( unsigned i=0; i < n_slots; i++ ) {
+      m_slots[i].req = NULL;
+      m_slots[i].age_next = (i+1 < n_slots)? i+1 : NIL;
+   }
+   m_free_slot = 0;
+
+   m_bank.resize(m_config->nbk);
    curr_row_service_time = new unsigned[m_config->nbk];
    row_service_timestamp = new unsigned[m_config->nbk];
    for ( unsigned i=0; i < m_config->nbk; i++ ) {
-      m_queue[i].clear();
-      m_bins[i].clear();
-      m_last_row[i] = NULL;
+      bank_queue &q = m_bank[i];
+      q.oldest = q.newest = NIL;
+      q.size = 0;
+      q.active = false;
+      q.active_row = 0;
+      q.row_hits = 0;
+      q.n_bins = 0;
+      q.bins.resize(16);
+      for ( unsigned j=0; j < q.bins.size(); j++ ) 
+         q.bins[j].oldest = NIL;
       curr_row_service_time[i] = 0;
       row_service_timestamp[i] = 0;
    }
 
+   m_last_source = NIL;
+   m_source_streak = 0;
+   m_blacklist_clear_time = 0;
+   m_n_blacklisted = 0;
+}
+
+unsigned frfcfs_scheduler::alloc_slot( dram_req_t *req )
+{
+   unsigned s = m_free_slot;
+   if ( s == NIL ) {
+      s = m_slots.size();
+      m_slots.resize(s+1);
+   } else {
+      m_free_slot = m_slots[s].age_next;
+   }
+   m_slots[s].req = req;
+   return s;
+}
+
+frfcfs_scheduler::row_bin *frfcfs_scheduler::find_bin( bank_queue &q, unsigned row )
+{
+   unsigned mask = q.bins.size()-1;
+   for ( unsigned i = bin_hash(row) & mask; ; i = (i+1) & mask ) {
+      row_bin &b = q.bins[i];
+      if ( b.oldest == NIL ) 
+         return NULL;
+      if ( b.row == row ) 
+         return &b;
+   }
+}
+
+void frfcfs_scheduler::grow_bins( bank_queue &q )
+{
+   std::vector<row_bin> old;
+   old.swap(q.bins);
+   q.bins.resize(2*old.size());
+   for ( unsigned j=0; j < q.bins.size(); j++ ) 
+      q.bins[j].oldest = NIL;
+   unsigned mask = q.bins.size()-1;
+   for ( unsigned j=0; j < old.size(); j++ ) {
+      if ( old[j].oldest == NIL ) 
+         continue;
+      unsigned i = bin_hash(old[j].row) & mask;
+      while ( q.bins[i].oldest != NIL ) 
+         i = (i+1) & mask;
+      q.bins[i] = old[j];
+   }
+}
+
+// returns an empty bin for row; the caller must link a request into it
+frfcfs_scheduler::row_bin *frfcfs_scheduler::insert_bin( bank_queue &q, unsigned row )
+{
+   if ( 2*(q.n_bins+1) > q.bins.size() ) 
+      grow_bins(q);
+   unsigned mask = q.bins.size()-1;
+   unsigned i = bin_hash(row) & mask;
+   while ( q.bins[i].oldest != NIL ) 
+      i = (i+1) & mask;
+   q.n_bins++;
+   q.bins[i].row = row;
+   q.bins[i].newest = NIL;
+   return &q.bins[i];
+}
+
+// linear probing deletion: shift later entries of the probe run back so
+// lookups never need tombstones
+void frfcfs_scheduler::erase_bin( bank_queue &q, row_bin *b )
+{
+   unsigned mask = q.bins.size()-1;
+   unsigned i = b - &q.bins[0];
+   unsigned j = i;
+   while ( true ) {
+      j = (j+1) & mask;
+      if ( q.bins[j].oldest == NIL ) 
+         break;
+      unsigned k = bin_hash(q.bins[j].row) & mask;
+      if ( (j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j)) ) {
+         q.bins[i] = q.bins[j];
+         i = j;
+      }
+   }
+   q.bins[i].oldest = NIL;
+   q.n_bins--;
 }
 
 void frfcfs_scheduler::add_req( dram_req_t *req )
 {
    m_num_pending++;
-   m_queue[req->bk].push_front(req);
-   std::list<dram_req_t*>::iterator ptr = m_queue[req->bk].begin();
-   m_bins[req->bk][req->row].push_front( ptr ); //newest reqs to the front
+   bank_queue &q = m_bank[req->bk];
+   unsigned s = alloc_slot(req);
+   req_slot &e = m_slots[s];
+
+   e.age_prev = q.newest;
+   e.age_next = NIL;
+   if ( q.newest != NIL ) 
+      m_slots[q.newest].age_next = s;
+   else 
+      q.oldest = s;
+   q.newest = s;
+   q.size++;
+
+   row_bin *b = find_bin( q, req->row );
+   if ( b == NULL ) 
+      b = insert_bin( q, req->row );
+   e.row_prev = b->newest;
+   e.row_next = NIL;
+   if ( b->newest != NIL ) 
+      m_slots[b->newest].row_next = s;
+   else 
+      b->oldest = s;
+   b->newest = s;
+}
+
+void frfcfs_scheduler::remove( unsigned bank, unsigned s )
+{
+   bank_queue &q = m_bank[bank];
+   req_slot &e = m_slots[s];
+   unsigned row = e.req->row;
+
+   if ( e.age_prev != NIL ) m_slots[e.age_prev].age_next = e.age_next;
+   else q.oldest = e.age_next;
+   if ( e.age_next != NIL ) m_slots[e.age_next].age_prev = e.age_prev;
+   else q.newest = e.age_prev;
+   q.size--;
+
+   row_bin *b = find_bin( q, row );
+   assert( b != NULL ); // where did the request go???
+   if ( e.row_prev != NIL ) m_slots[e.row_prev].row_next = e.row_next;
+   else b->oldest = e.row_next;
+   if ( e.row_next != NIL ) m_slots[e.row_next].row_prev = e.row_prev;
+   else b->newest = e.row_prev;
+   if ( b->oldest == NIL ) {
+      erase_bin( q, b );
+      if ( q.active && q.active_row == row ) 
+         q.active = false;
+   }
+
+   e.req = NULL;
+   e.age_next = m_free_slot;
+   m_free_slot = s;
+   assert( m_num_pending != 0 );
+   m_num_pending--;
 }
 
 void frfcfs_scheduler::data_collection(unsigned int bank)
@@ -76,43 +235,115 @@ void frfcfs_scheduler::data_collection(unsigned int bank)
    m_stats->num_activates[m_dram->id][bank]++;
 }
 
-dram_req_t *frfcfs_scheduler::schedule( unsigned bank, unsigned curr_row )
+// FR-FCFS: drain the bin of the open row (oldest first) until it is empty,
+// then move to the row of the oldest request.  FR-FCFS-Cap additionally gives
+// up the open row after frfcfs_row_hit_cap hits if other rows are waiting.
+unsigned frfcfs_scheduler::select_frfcfs( unsigned bank, unsigned curr_row )
 {
-   if ( m_last_row[bank] == NULL ) {
-      if ( m_queue[bank].empty() )
-         return NULL;
-
-      std::map<unsigned,std::list<std::list<dram_req_t*>::iterator> >::iterator bin_ptr = m_bins[bank].find( curr_row );
-      if ( bin_ptr == m_bins[bank].end()) {
-         dram_req_t *req = m_queue[bank].back();
-         bin_ptr = m_bins[bank].find( req->row );
-         assert( bin_ptr != m_bins[bank].end() ); // where did the request go???
-         m_last_row[bank] = &(bin_ptr->second);
+   bank_queue &q = m_bank[bank];
+   if ( q.active && m_config->frfcfs_policy == DRAM_SCHED_FRFCFS_CAP && 
+        q.row_hits >= m_config->frfcfs_row_hit_cap ) {
+      unsigned s = q.oldest;
+      while ( s != NIL && m_slots[s].req->row == q.active_row ) 
+         s = m_slots[s].age_next;
+      if ( s != NIL ) {
+         q.active_row = m_slots[s].req->row;
+         q.row_hits = 0;
          data_collection(bank);
+      }
+   }
+   if ( !q.active ) {
+      if ( find_bin(q,curr_row) ) {
+         q.active_row = curr_row;
       } else {
-         m_last_row[bank] = &(bin_ptr->second);
+         q.active_row = m_slots[q.oldest].req->row;
+         data_collection(bank);
+      }
+      q.active = true;
+      q.row_hits = 0;
+   }
+   q.row_hits++;
+   return find_bin(q,q.active_row)->oldest;
+}
+
+bool frfcfs_scheduler::blacklisted( const req_slot &e ) const
+{
+   unsigned src = e.req->data->get_sid();
+   return src < m_blacklist.size() && m_blacklist[src];
+}
 
+// BLISS: oldest row hit from a non-blacklisted source, else the oldest request
+// from a non-blacklisted source, else plain FR-FCFS order
+unsigned frfcfs_scheduler::select_bliss( unsigned bank, unsigned curr_row )
+{
+   bank_queue &q = m_bank[bank];
+   row_bin *b = find_bin(q,curr_row);
+   unsigned s;
+   if ( b ) {
+      for ( s = b->oldest; s != NIL; s = m_slots[s].row_next ) 
+         if ( !blacklisted(m_slots[s]) ) 
+            return s;
+   }
+   for ( s = q.oldest; s != NIL; s = m_slots[s].age_next ) 
+      if ( !blacklisted(m_slots[s]) ) 
+         break;
+   if ( s == NIL ) 
+      s = b? b->oldest : q.oldest;
+   if ( m_slots[s].req->row != curr_row ) 
+      data_collection(bank);
+   return s;
+}
+
+void frfcfs_scheduler::bliss_update( const dram_req_t *req )
+{
+   unsigned src = req->data->get_sid();
+   if ( src == m_last_source ) {
+      m_source_streak++;
+   } else {
+      m_last_source = src;
+      m_source_streak = 1;
+   }
+   // requests without a source core (e.g. L2 writebacks) are never blacklisted
+   if ( m_source_streak > m_config->bliss_threshold && src != (unsigned)-1 ) {
+      if ( src >= m_blacklist.size() ) 
+         m_blacklist.resize(src+1,false);
+      if ( !m_blacklist[src] ) {
+         m_blacklist[src] = true;
+         m_n_blacklisted++;
       }
+      m_source_streak = 0;
    }
-   std::list<dram_req_t*>::iterator next = m_last_row[bank]->back();
-   dram_req_t *req = (*next);
+}
 
-   m_stats->concurrent_row_access[m_dram->id][bank]++;
-   m_stats->row_access[m_dram->id][bank]++;
-   m_last_row[bank]->pop_back();
+dram_req_t *frfcfs_scheduler::schedule( unsigned bank, unsigned curr_row )
+{
+   if ( m_bank[bank].size == 0 )
+      return NULL;
 
-   m_queue[bank].erase(next);
-   if ( m_last_row[bank]->empty() ) {
-      m_bins[bank].erase( req->row );
-      m_last_row[bank] = NULL;
+   unsigned s;
+   if ( m_config->frfcfs_policy == DRAM_SCHED_BLISS ) {
+      unsigned long long now = gpu_sim_cycle + gpu_tot_sim_cycle;
+      if ( now >= m_blacklist_clear_time ) {
+         m_blacklist.assign(m_blacklist.size(),false);
+         m_blacklist_clear_time = now + m_config->bliss_clear_interval;
+      }
+      s = select_bliss(bank,curr_row);
+   } else {
+      s = select_frfcfs(bank,curr_row);
    }
+   dram_req_t *req = m_slots[s].req;
+
+   m_stats->concurrent_row_access[m_dram->id][bank]++;
+   m_stats->row_access[m_dram->id][bank]++;
+   remove(bank,s);
+   if ( m_config->frfcfs_policy == DRAM_SCHED_BLISS ) 
+      bliss_update(req);
 #ifdef DEBUG_FAST_IDEAL_SCHED
    if ( req )
       printf("%08u : DRAM(%u) scheduling memory request to bank=%u, row=%u\n", 
              (unsigned)gpu_sim_cycle, m_dram->id, req->bk, req->row );
 #endif
-   assert( req != NULL && m_num_pending != 0 ); 
-   m_num_pending--;
+   assert( req != NULL ); 
 
    return req;
 }
@@ -121,8 +352,10 @@ dram_req_t *frfcfs_scheduler::schedule( unsigned bank, unsigned curr_row )
 void frfcfs_scheduler::print( FILE *fp )
 {
    for ( unsigned b=0; b < m_config->nbk; b++ ) {
-      printf(" %u: queue length = %u\n", b, (unsigned)m_queue[b].size() );
+      printf(" %u: queue length = %u\n", b, m_bank[b].size );
    }
+   if ( m_config->frfcfs_policy == DRAM_SCHED_BLISS ) 
+      printf(" BLISS blacklistings = %u\n", m_n_blacklisted );
 }
 
 void dram_t::scheduler_frfcfs()
@@ -134,12 +367,12 @@ void dram_t::scheduler_frfcfs()
 
       // Power stats
       //if(req->data->get_type() != READ_REPLY && req->data->get_type() != WRITE_ACK)
-      m_stats->total_n_access++;
+      stat_atomic_inc(m_stats->total_n_access);
 
       if(req->data->get_type() == WRITE_REQUEST){
-    	  m_stats->total_n_writes++;
+    	  stat_atomic_inc(m_stats->total_n_writes);
       }else if(req->data->get_type() == READ_REQUEST){
-    	  m_stats->total_n_reads++;
+    	  stat_atomic_inc(m_stats->total_n_reads);
       }
 
       req->data->set_status(IN_PARTITION_MC_INPUT_QUEUE,gpu_sim_cycle+gpu_tot_sim_cycle);
@@ -161,10 +394,8 @@ void dram_t::scheduler_frfcfs()
             if (m_config->gpgpu_memlatency_stat) {
                mrq_latency = gpu_sim_cycle + gpu_tot_sim_cycle - bk[b]->mrq->timestamp;
                bk[b]->mrq->timestamp = gpu_tot_sim_cycle + gpu_sim_cycle;
-               m_stats->mrq_lat_table[LOGB2(mrq_latency)]++;
-               if (mrq_latency > m_stats->max_mrq_latency) {
-                  m_stats->max_mrq_latency = mrq_latency;
-               }
+               stat_atomic_inc(m_stats->mrq_lat_table[LOGB2(mrq_latency)]);
+               stat_atomic_max(m_stats->max_mrq_latency, mrq_latency);
             }
 
             break;
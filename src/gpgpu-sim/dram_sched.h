@@ -32,9 +32,14 @@
 #include "shader.h"
 #include "gpu-sim.h"
 #include "gpu-misc.h"
-#include <list>
-#include <map>
+#include <vector>
 
+// FR-FCFS request queue with constant time row hit lookup.  
+//
+// Pending requests live in a preallocated slot pool and are threaded through
+// two intrusive doubly linked lists (slot indices, not pointers, so the pool
+// can grow): one per bank in arrival order and one per (bank,row) bin.  Each
+// bank finds the bin for a row through a small open addressed hash table.
 class frfcfs_scheduler {
 public:
    frfcfs_scheduler( const memory_config *config, dram_t *dm, memory_stats_t *stats );
@@ -45,15 +50,56 @@ public:
    unsigned num_pending() const { return m_num_pending;}
 
 private:
+   static const unsigned NIL = (unsigned)-1;
+
+   struct req_slot {
+      dram_req_t *req;
+      unsigned age_prev, age_next; // per bank list, prev is older
+      unsigned row_prev, row_next; // per row bin list, prev is older
+   };
+   struct row_bin {
+      unsigned row;
+      unsigned oldest, newest; // oldest == NIL marks an empty hash entry
+   };
+   struct bank_queue {
+      unsigned oldest, newest;
+      unsigned size;
+      bool     active;     // FR-FCFS keeps draining active_row's bin
+      unsigned active_row;
+      unsigned row_hits;   // requests served from active_row since it was picked
+      unsigned n_bins;
+      std::vector<row_bin> bins; // power of two sized
+   };
+
+   unsigned alloc_slot( dram_req_t *req );
+   row_bin *find_bin( bank_queue &q, unsigned row );
+   row_bin *insert_bin( bank_queue &q, unsigned row );
+   void erase_bin( bank_queue &q, row_bin *b );
+   void grow_bins( bank_queue &q );
+   void remove( unsigned bank, unsigned s );
+   unsigned select_frfcfs( unsigned bank, unsigned curr_row );
+   unsigned select_bliss( unsigned bank, unsigned curr_row );
+   bool blacklisted( const req_slot &s ) const;
+   void bliss_update( const dram_req_t *req );
+   static unsigned bin_hash( unsigned row ) { return row * 2654435761U; }
+
    const memory_config *m_config;
    dram_t *m_dram;
    unsigned m_num_pending;
-   std::list<dram_req_t*>                                    *m_queue;
-   std::map<unsigned,std::list<std::list<dram_req_t*>::iterator> >    *m_bins;
-   std::list<std::list<dram_req_t*>::iterator>                 **m_last_row;
+   std::vector<req_slot> m_slots;
+   unsigned m_free_slot;  // free slots are chained through age_next
+   std::vector<bank_queue> m_bank;
    unsigned *curr_row_service_time; //one set of variables for each bank.
    unsigned *row_service_timestamp; //tracks when scheduler began servicing current row
 
+   // BLISS: sources (shader cores) that get too many requests served in a row
+   // are deprioritized until the blacklist is cleared
+   std::vector<bool> m_blacklist;
+   unsigned m_last_source;
+   unsigned m_source_streak;
+   unsigned long long m_blacklist_clear_time;
+   unsigned m_n_blacklisted;
+
    memory_stats_t *m_stats;
 };
 
@@ -0,0 +1,130 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gpu-sim.h"
+#include "shader.h"
+#include "l2cache.h"
+
+extern unsigned g_ptx_sim_num_insn;
+
+// Sampled simulation: the first kernel launches of an application are run by 
+// the functional model (as with -gpgpu_ptx_sim_mode 1) and the performance 
+// model takes over at a kernel boundary. While fast-forwarding, the last 
+// -gpgpu_fast_forward_warmup global and constant memory accesses are kept in 
+// a ring and replayed into the L1 and L2 tag arrays at the switch, so the 
+// sampled region does not start with cold caches. The functional model does 
+// not place CTAs on cores, so a CTA's accesses go to the core the performance 
+// model would give it on an idle GPU (round robin over the clusters).
+
+bool gpgpu_sim::fast_forward_kernel( const kernel_info_t &kernel )
+{
+   if( m_fast_forward_done ) 
+      return false;
+   bool kernels_left = !m_config.fast_forward_kernels || m_fast_forward_kernels < m_config.fast_forward_kernels;
+   bool insn_left = !m_config.fast_forward_insn || g_ptx_sim_num_insn < m_config.fast_forward_insn;
+   if( kernels_left && insn_left ) {
+      m_fast_forward_kernels++;
+      printf("GPGPU-Sim: fast-forwarding kernel %u \'%s\' in the functional model\n", 
+             kernel.get_uid(), kernel.name().c_str() );
+      return true;
+   }
+   m_fast_forward_done = true;
+   printf("GPGPU-Sim: fast-forwarded %u kernels (%u instructions), switching to the performance model at kernel %u \'%s\'\n", 
+          m_fast_forward_kernels, g_ptx_sim_num_insn, kernel.get_uid(), kernel.name().c_str() );
+   fast_forward_warm_caches();
+   return false;
+}
+
+void gpgpu_sim::fast_forward_record( unsigned cta, const warp_inst_t &inst )
+{
+   if( m_fast_forward_done || !m_config.fast_forward_warmup ) 
+      return;
+   if( !inst.is_load() && !inst.is_store() && !inst.isatomic() ) 
+      return;
+   bool constant;
+   switch( inst.space.get_type() ) {
+   case global_space: constant = false; break;
+   case const_space: 
+   case param_space_kernel: constant = true; break;
+   default: return; // shared memory, and local/texture accesses the functional model does not translate
+   }
+   bool write = inst.is_store() || inst.isatomic();
+
+   // one access per cache line touched by the warp
+   new_addr_type line_mask = ~(new_addr_type)(m_memory_config->m_L2_config.get_line_sz()-1);
+   new_addr_type lines[MAX_WARP_SIZE];
+   unsigned n_lines = 0;
+   for( unsigned t=0; t < inst.warp_size(); t++ ) {
+      if( !inst.active(t) ) 
+         continue;
+      new_addr_type line = inst.get_addr(t) & line_mask;
+      bool seen = false;
+      for( unsigned l=0; l < n_lines && !seen; l++ ) 
+         seen = (lines[l] == line);
+      if( seen ) 
+         continue;
+      lines[n_lines++] = line;
+
+      fast_forward_access access;
+      access.addr = line;
+      access.cta = cta;
+      access.write = write;
+      access.constant = constant;
+      if( m_fast_forward_trace.size() < m_config.fast_forward_warmup ) {
+         m_fast_forward_trace.push_back(access);
+      } else {
+         m_fast_forward_trace[m_fast_forward_next] = access;
+         m_fast_forward_next = (m_fast_forward_next+1) % m_fast_forward_trace.size();
+      }
+   }
+}
+
+void gpgpu_sim::fast_forward_warm_caches()
+{
+   unsigned n = m_fast_forward_trace.size();
+   if( n == 0 ) 
+      return;
+   printf("GPGPU-Sim uArch: warming up the caches with the last %u fast-forwarded memory accesses\n", n);
+   unsigned n_clusters = m_shader_config->n_simt_clusters;
+   unsigned n_cores = m_shader_config->n_simt_cores_per_cluster;
+   for( unsigned i=0; i < n; i++ ) {
+      // oldest first; once the ring has wrapped the next slot is the oldest
+      const fast_forward_access &access = m_fast_forward_trace[(m_fast_forward_next+i) % n];
+      unsigned cluster = access.cta % n_clusters;
+      unsigned core = (access.cta / n_clusters) % n_cores;
+      m_cluster[cluster]->warm_L1(core,access.addr,i,access.write,access.constant);
+      addrdec_t raw_addr;
+      m_memory_config->m_address_mapping.addrdec_tlx(access.addr,&raw_addr);
+      m_memory_sub_partition[raw_addr.sub_partition]->warm_L2(access.addr,i,access.write);
+   }
+   for( unsigned i=0; i < n_clusters; i++ ) 
+      m_cluster[i]->warm_L1_done();
+   for( unsigned i=0; i < m_memory_config->m_n_mem_sub_partition; i++ ) 
+      m_memory_sub_partition[i]->warm_L2_done();
+   std::vector<fast_forward_access>().swap(m_fast_forward_trace);
+   m_fast_forward_next = 0;
+}
@@ -27,7 +27,13 @@
 
 #include "gpu-cache.h"
 #include "stat-tool.h"
+#include "checkpoint.h"
+#include "stat_registry.h"
 #include <assert.h>
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define MAX_DEFAULT_CACHE_SIZE_MULTIBLIER 4
 // used to allocate memory that is large enough to adapt the changes in cache size across kernels
@@ -38,7 +44,8 @@ const char * cache_request_status_str(enum cache_request_status status)
       "HIT",
       "HIT_RESERVED",
       "MISS",
-      "RESERVATION_FAIL"
+      "RESERVATION_FAIL",
+      "SECTOR_MISS"
    }; 
 
    assert(sizeof(static_cache_request_status_str) / sizeof(const char*) == NUM_CACHE_REQUEST_STATUS); 
@@ -47,6 +54,38 @@ const char * cache_request_status_str(enum cache_request_status status)
    return static_cache_request_status_str[status]; 
 }
 
+unsigned cache_config::sector_mask( const mem_fetch *mf ) const
+{
+    if ( !m_sector_sz || !mf ) 
+        return full_sector_mask();
+    new_addr_type addr = mf->get_addr();
+    new_addr_type line = block_addr(addr);
+    unsigned mask = 0;
+    mem_access_byte_mask_t bytes = mf->get_access_byte_mask();
+    if ( bytes.any() ) {
+        // the byte mask covers the 128 byte chunk that holds addr
+        new_addr_type chunk = addr & ~(new_addr_type)(MAX_MEMORY_ACCESS_SIZE-1);
+        for ( unsigned s = 0; s < get_num_sectors(); s++ ) {
+            new_addr_type lo = std::max(line + s*m_sector_sz, chunk);
+            new_addr_type hi = std::min(line + (s+1)*m_sector_sz, chunk + MAX_MEMORY_ACCESS_SIZE);
+            for ( new_addr_type a = lo; a < hi; a++ ) {
+                if ( bytes.test(a - chunk) ) {
+                    mask |= 1U << s;
+                    break;
+                }
+            }
+        }
+    } else {
+        new_addr_type end = std::min(addr + std::max(mf->get_data_size(),1U), line + m_line_sz);
+        for ( new_addr_type a = addr; a < end; a += m_sector_sz ) 
+            mask |= 1U << ((a - line) / m_sector_sz);
+        mask |= 1U << ((end - 1 - line) / m_sector_sz);
+    }
+    if ( mask == 0 ) 
+        mask = 1U << ((addr - line) / m_sector_sz);
+    return mask;
+}
+
 unsigned l1d_cache_config::set_index(new_addr_type addr) const{
     unsigned set_index = m_nset; // Default to linear set index function
     unsigned lower_xor = 0;
@@ -114,6 +153,8 @@ unsigned l2_cache_config::set_index(new_addr_type addr) const{
 tag_array::~tag_array() 
 {
     delete[] m_lines;
+    delete[] m_tags;
+    delete m_policy;
 }
 
 tag_array::tag_array( cache_config &config,
@@ -123,12 +164,32 @@ tag_array::tag_array( cache_config &config,
     : m_config( config ),
       m_lines( new_lines )
 {
+    m_n_alloc_lines = config.get_num_lines();
     init( core_id, type_id );
 }
 
 void tag_array::update_cache_parameters(cache_config &config)
 {
+	unsigned assoc = m_config.m_assoc;
+	enum replacement_policy_t policy = m_config.m_replacement_policy;
+	unsigned sector_sz = m_config.m_sector_sz;
 	m_config=config;
+	if (sector_sz != m_config.m_sector_sz) {
+		// sector geometry changed: treat whatever a line holds as whole
+		unsigned full = m_config.full_sector_mask();
+		for (unsigned i=0; i < m_n_alloc_lines; i++) {
+			cache_block_t &line = m_lines[i];
+			line.m_sector_valid = (line.m_status == VALID || line.m_status == MODIFIED)? full : 0;
+			line.m_sector_pending = (line.m_status == RESERVED)? full : 0;
+			line.m_sector_dirty = (line.m_status == MODIFIED)? full : 0;
+		}
+	}
+	rebuild_lookup();
+	if (assoc != m_config.m_assoc || policy != m_config.m_replacement_policy) {
+		delete m_policy;
+		m_policy = create_replacement_policy(m_config, m_lines, m_n_alloc_lines);
+		m_policy->reset();
+	}
 }
 
 tag_array::tag_array( cache_config &config,
@@ -137,7 +198,8 @@ tag_array::tag_array( cache_config &config,
     : m_config( config )
 {
     //assert( m_config.m_write_policy == READ_ONLY ); Old assert
-    m_lines = new cache_block_t[MAX_DEFAULT_CACHE_SIZE_MULTIBLIER*config.get_num_lines()];
+    m_n_alloc_lines = MAX_DEFAULT_CACHE_SIZE_MULTIBLIER*config.get_num_lines();
+    m_lines = new cache_block_t[m_n_alloc_lines];
     init( core_id, type_id );
 }
 
@@ -153,90 +215,206 @@ void tag_array::init( int core_id, int type_id )
     m_prev_snapshot_pending_hit = 0;
     m_core_id = core_id; 
     m_type_id = type_id;
+    m_tags = new new_addr_type[m_n_alloc_lines];
+    rebuild_lookup();
+    m_policy = create_replacement_policy(m_config, m_lines, m_n_alloc_lines);
+}
+
+static inline unsigned long long way_mask( unsigned n )
+{
+    return (n >= 64)? ~0ULL : ((1ULL << n) - 1);
+}
+
+// bit i is set if tags[i] == tag, for i < n <= 64
+static inline unsigned long long tag_match_mask( const new_addr_type *tags, unsigned n, new_addr_type tag )
+{
+    unsigned long long match = 0;
+    unsigned way = 0;
+#ifdef __SSE2__
+    const __m128i key = _mm_set1_epi64x( (long long)tag );
+    for (; way+2 <= n; way += 2) {
+        __m128i eq = _mm_cmpeq_epi32( _mm_loadu_si128((const __m128i*)&tags[way]), key );
+        // a 64-bit tag matches when both of its 32-bit halves do
+        eq = _mm_and_si128( eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2,3,0,1)) );
+        match |= (unsigned long long)_mm_movemask_pd(_mm_castsi128_pd(eq)) << way;
+    }
+#endif
+    for (; way < n; way++) 
+        match |= (unsigned long long)(tags[way] == tag) << way;
+    return match;
+}
+
+// copy the tag and state of line idx into the lookup arrays
+void tag_array::sync_lookup( unsigned idx )
+{
+    unsigned assoc = m_config.m_assoc;
+    unsigned way = idx % assoc;
+    unsigned w = (idx / assoc)*m_mask_words + way/64;
+    unsigned long long bit = 1ULL << (way % 64);
+    m_tags[idx] = m_lines[idx].m_tag;
+    m_valid_mask[w] &= ~bit;
+    m_reserved_mask[w] &= ~bit;
+    if (m_lines[idx].m_status == VALID || m_lines[idx].m_status == MODIFIED) 
+        m_valid_mask[w] |= bit;
+    else if (m_lines[idx].m_status == RESERVED) 
+        m_reserved_mask[w] |= bit;
+}
+
+void tag_array::rebuild_lookup()
+{
+    unsigned assoc = m_config.m_assoc;
+    unsigned n_sets = m_n_alloc_lines / assoc;
+    m_mask_words = (assoc + 63) / 64;
+    m_valid_mask.assign(n_sets*m_mask_words, 0);
+    m_reserved_mask.assign(n_sets*m_mask_words, 0);
+    for (unsigned i=0; i < n_sets*assoc; i++) 
+        sync_lookup(i);
+}
+
+void tag_array::set_status( unsigned idx, enum cache_block_state status )
+{
+    m_lines[idx].m_status = status;
+    sync_lookup(idx);
+}
+
+void tag_array::allocate_line( unsigned idx, new_addr_type addr, unsigned time, const mem_fetch *mf, unsigned sector_mask )
+{
+    enum cache_block_state old_status = m_lines[idx].m_status;
+    m_policy->on_insert( idx, old_status == VALID || old_status == MODIFIED, mf );
+    m_lines[idx].allocate( m_config.tag(addr), m_config.block_addr(addr), time );
+    if ( m_config.m_sector_sz ) 
+        m_lines[idx].m_sector_pending = sector_mask;
+    sync_lookup(idx);
+}
+
+// the fetch of a reserved line arrived; the sectors it brought are valid 
+void tag_array::fill_line( unsigned idx, unsigned time )
+{
+    cache_block_t &line = m_lines[idx];
+    line.fill(time);
+    if ( m_config.m_sector_sz ) {
+        line.m_sector_valid |= line.m_sector_pending;
+        line.m_sector_pending = 0;
+        if ( line.m_sector_dirty ) 
+            line.m_status = MODIFIED; // written while the fetch was in flight
+    }
+    sync_lookup(idx);
+}
+
+// outcome of an access to 'sector_mask' of a sectored line whose tag matched
+enum cache_request_status tag_array::sector_status( const cache_block_t &line, unsigned sector_mask ) const
+{
+    if ( (sector_mask & ~line.m_sector_valid) == 0 ) 
+        return HIT;
+    if ( (sector_mask & ~(line.m_sector_valid | line.m_sector_pending)) == 0 ) 
+        return HIT_RESERVED;
+    if ( line.m_status == RESERVED ) 
+        return RESERVATION_FAIL; // one fetch per line: wait for the pending one
+    return SECTOR_MISS;
+}
+
+void tag_array::mark_modified( unsigned idx, const mem_fetch *mf )
+{
+    cache_block_t &line = m_lines[idx];
+    if ( m_config.m_sector_sz ) {
+        line.m_sector_dirty |= m_config.sector_mask(mf) & line.m_sector_valid;
+        if ( line.m_status == RESERVED ) 
+            return; // fill_line() makes it MODIFIED
+    }
+    set_status(idx, MODIFIED);
+}
+
+void tag_array::invalidate( unsigned idx, const mem_fetch *mf )
+{
+    cache_block_t &line = m_lines[idx];
+    if ( m_config.m_sector_sz ) {
+        unsigned mask = m_config.sector_mask(mf);
+        line.m_sector_valid &= ~mask;
+        line.m_sector_dirty &= ~mask;
+        if ( line.m_status == RESERVED ) 
+            return;
+        if ( line.m_sector_valid ) {
+            set_status(idx, line.m_sector_dirty? MODIFIED : VALID);
+            return;
+        }
+    }
+    set_status(idx, INVALID);
 }
 
-enum cache_request_status tag_array::probe( new_addr_type addr, unsigned &idx ) const {
+enum cache_request_status tag_array::probe( new_addr_type addr, unsigned &idx, const mem_fetch *mf ) const {
     //assert( m_config.m_write_policy == READ_ONLY );
     unsigned set_index = m_config.set_index(addr);
     new_addr_type tag = m_config.tag(addr);
-
-    unsigned invalid_line = (unsigned)-1;
-    unsigned valid_line = (unsigned)-1;
-    unsigned valid_timestamp = (unsigned)-1;
+    unsigned assoc = m_config.m_assoc;
+    unsigned base = set_index*assoc;
+    const unsigned long long *valid = &m_valid_mask[set_index*m_mask_words];
+    const unsigned long long *reserved = &m_reserved_mask[set_index*m_mask_words];
 
     bool all_reserved = true;
 
-    // check for hit or pending hit
-    for (unsigned way=0; way<m_config.m_assoc; way++) {
-        unsigned index = set_index*m_config.m_assoc+way;
-        cache_block_t *line = &m_lines[index];
-        if (line->m_tag == tag) {
-            if ( line->m_status == RESERVED ) {
-                idx = index;
-                return HIT_RESERVED;
-            } else if ( line->m_status == VALID ) {
-                idx = index;
-                return HIT;
-            } else if ( line->m_status == MODIFIED ) {
-                idx = index;
-                return HIT;
-            } else {
-                assert( line->m_status == INVALID );
-            }
+    // check for hit or pending hit: first matching way that holds a line
+    for (unsigned w=0; w < m_mask_words; w++) {
+        unsigned n = std::min(64U, assoc - w*64);
+        unsigned long long hit = tag_match_mask(&m_tags[base+w*64],n,tag) & (valid[w] | reserved[w]);
+        if (hit) {
+            unsigned way = __builtin_ctzll(hit);
+            idx = base + w*64 + way;
+            if ( m_config.m_sector_sz ) 
+                return sector_status( m_lines[idx], m_config.sector_mask(mf) );
+            return ((reserved[w] >> way) & 1)? HIT_RESERVED : HIT;
         }
-        if (line->m_status != RESERVED) {
+        if (reserved[w] != way_mask(n)) 
             all_reserved = false;
-            if (line->m_status == INVALID) {
-                invalid_line = index;
-            } else {
-                // valid line : keep track of most appropriate replacement candidate
-                if ( m_config.m_replacement_policy == LRU ) {
-                    if ( line->m_last_access_time < valid_timestamp ) {
-                        valid_timestamp = line->m_last_access_time;
-                        valid_line = index;
-                    }
-                } else if ( m_config.m_replacement_policy == FIFO ) {
-                    if ( line->m_alloc_time < valid_timestamp ) {
-                        valid_timestamp = line->m_alloc_time;
-                        valid_line = index;
-                    }
-                }
-            }
-        }
     }
     if ( all_reserved ) {
         assert( m_config.m_alloc_policy == ON_MISS ); 
         return RESERVATION_FAIL; // miss and not enough space in cache to allocate on miss
     }
 
-    if ( invalid_line != (unsigned)-1 ) {
-        idx = invalid_line;
-    } else if ( valid_line != (unsigned)-1) {
-        idx = valid_line;
-    } else abort(); // if an unreserved block exists, it is either invalid or replaceable 
+    // prefer the last invalid way
+    for (unsigned w=m_mask_words; w-- > 0; ) {
+        unsigned long long invalid = ~(valid[w] | reserved[w]) & way_mask(std::min(64U, assoc - w*64));
+        if (invalid) {
+            idx = base + w*64 + 63 - __builtin_clzll(invalid);
+            return MISS;
+        }
+    }
+
+    // all unreserved ways hold valid lines: let the replacement policy choose
+    idx = m_policy->victim(base, valid);
 
     return MISS;
 }
 
-enum cache_request_status tag_array::access( new_addr_type addr, unsigned time, unsigned &idx )
+enum cache_request_status tag_array::access( new_addr_type addr, unsigned time, unsigned &idx, const mem_fetch *mf )
 {
     bool wb=false;
     cache_block_t evicted;
-    enum cache_request_status result = access(addr,time,idx,wb,evicted);
+    enum cache_request_status result = access(addr,time,idx,wb,evicted,mf);
     assert(!wb);
     return result;
 }
 
-enum cache_request_status tag_array::access( new_addr_type addr, unsigned time, unsigned &idx, bool &wb, cache_block_t &evicted ) 
+enum cache_request_status tag_array::access( new_addr_type addr, unsigned time, unsigned &idx, bool &wb, cache_block_t &evicted, const mem_fetch *mf ) 
 {
     m_access++;
     shader_cache_access_log(m_core_id, m_type_id, 0); // log accesses to cache
-    enum cache_request_status status = probe(addr,idx);
+    enum cache_request_status status = probe(addr,idx,mf);
     switch (status) {
     case HIT_RESERVED: 
         m_pending_hit++;
     case HIT: 
         m_lines[idx].m_last_access_time=time; 
+        m_policy->on_hit(idx,mf);
+        break;
+    case SECTOR_MISS:
+        // fetch the missing sectors into the line that is already here
+        m_miss++;
+        shader_cache_access_log(m_core_id, m_type_id, 1); // log cache misses
+        m_lines[idx].m_last_access_time=time; 
+        m_policy->on_hit(idx,mf);
+        m_lines[idx].m_sector_pending = m_config.sector_mask(mf) & ~m_lines[idx].m_sector_valid;
+        set_status(idx, RESERVED);
         break;
     case MISS:
         m_miss++;
@@ -246,7 +424,7 @@ enum cache_request_status tag_array::access( new_addr_type addr, unsigned time,
                 wb = true;
                 evicted = m_lines[idx];
             }
-            m_lines[idx].allocate( m_config.tag(addr), m_config.block_addr(addr), time );
+            allocate_line( idx, addr, time, mf, m_config.sector_mask(mf) );
         }
         break;
     case RESERVATION_FAIL:
@@ -261,26 +439,146 @@ enum cache_request_status tag_array::access( new_addr_type addr, unsigned time,
     return status;
 }
 
-void tag_array::fill( new_addr_type addr, unsigned time )
+void tag_array::fill( new_addr_type addr, unsigned time, const mem_fetch *mf )
 {
     assert( m_config.m_alloc_policy == ON_FILL );
     unsigned idx;
     enum cache_request_status status = probe(addr,idx);
     assert(status==MISS); // MSHR should have prevented redundant memory request
-    m_lines[idx].allocate( m_config.tag(addr), m_config.block_addr(addr), time );
-    m_lines[idx].fill(time);
+    allocate_line( idx, addr, time, mf, m_config.full_sector_mask() );
+    fill_line( idx, time );
 }
 
 void tag_array::fill( unsigned index, unsigned time ) 
 {
     assert( m_config.m_alloc_policy == ON_MISS );
-    m_lines[index].fill(time);
+    fill_line( index, time );
+}
+
+void tag_array::allocate_prefetch( new_addr_type addr, unsigned time, unsigned idx, bool &wb, cache_block_t &evicted, const mem_fetch *mf )
+{
+    assert( m_config.m_alloc_policy == ON_MISS );
+    if( m_lines[idx].m_status == MODIFIED ) {
+        wb = true;
+        evicted = m_lines[idx];
+    }
+    allocate_line( idx, addr, time, mf, m_config.full_sector_mask() );
 }
 
 void tag_array::flush() 
 {
     for (unsigned i=0; i < m_config.get_num_lines(); i++)
         m_lines[i].m_status = INVALID;
+    std::fill(m_valid_mask.begin(), m_valid_mask.end(), 0);
+    std::fill(m_reserved_mask.begin(), m_reserved_mask.end(), 0);
+}
+
+void tag_array::save( FILE *fp ) const
+{
+    unsigned n_lines = size();
+    checkpoint_write(fp,n_lines);
+    for (unsigned i=0; i < n_lines; i++) {
+        const cache_block_t &line = m_lines[i];
+        checkpoint_write(fp,line.m_tag);
+        checkpoint_write(fp,line.m_block_addr);
+        checkpoint_write(fp,line.m_alloc_time);
+        checkpoint_write(fp,line.m_last_access_time);
+        checkpoint_write(fp,line.m_fill_time);
+        checkpoint_write(fp,line.m_status);
+        checkpoint_write(fp,line.m_sector_valid);
+        checkpoint_write(fp,line.m_sector_dirty);
+    }
+    checkpoint_write(fp,m_access);
+    checkpoint_write(fp,m_miss);
+    checkpoint_write(fp,m_pending_hit);
+    checkpoint_write(fp,m_res_fail);
+}
+
+bool tag_array::load( FILE *fp )
+{
+    unsigned n_lines;
+    checkpoint_read(fp,n_lines);
+    bool same_geometry = (n_lines == size());
+    for (unsigned i=0; i < n_lines; i++) {
+        cache_block_t line;
+        checkpoint_read(fp,line.m_tag);
+        checkpoint_read(fp,line.m_block_addr);
+        checkpoint_read(fp,line.m_alloc_time);
+        checkpoint_read(fp,line.m_last_access_time);
+        checkpoint_read(fp,line.m_fill_time);
+        checkpoint_read(fp,line.m_status);
+        checkpoint_read(fp,line.m_sector_valid);
+        checkpoint_read(fp,line.m_sector_dirty);
+        // the miss that reserved the line is not part of the checkpoint; a
+        // sectored line keeps the sectors it already had
+        if (line.m_status == RESERVED) {
+            if (line.m_sector_valid) 
+                line.m_status = line.m_sector_dirty? MODIFIED : VALID;
+            else 
+                line.m_status = INVALID;
+        }
+        if (same_geometry) 
+            m_lines[i] = line;
+    }
+    checkpoint_read(fp,m_access);
+    checkpoint_read(fp,m_miss);
+    checkpoint_read(fp,m_pending_hit);
+    checkpoint_read(fp,m_res_fail);
+    new_window();
+    if (same_geometry) {
+        rebuild_lookup();
+        m_policy->reset();
+    }
+    return same_geometry;
+}
+
+void tag_array::warm( new_addr_type addr, unsigned time, bool dirty )
+{
+    unsigned idx;
+    enum cache_request_status status = probe(addr,idx);
+    switch (status) {
+    case HIT:
+        m_lines[idx].m_last_access_time=time;
+        m_policy->on_hit(idx,NULL);
+        break;
+    case MISS:
+        allocate_line( idx, addr, time, NULL, m_config.full_sector_mask() );
+        fill_line( idx, time );
+        break;
+    case SECTOR_MISS:
+        m_lines[idx].m_last_access_time=time;
+        m_policy->on_hit(idx,NULL);
+        m_lines[idx].m_sector_valid = m_config.full_sector_mask();
+        break;
+    default:
+        return; // nothing is in flight while warming up
+    }
+    if (dirty) 
+        mark_modified( idx );
+}
+
+void tag_array::warm_done()
+{
+    // the timing model starts counting cycles from where it stopped, not from 
+    // the end of the replay, so keep only the order of the lines in each set
+    unsigned assoc = m_config.m_assoc;
+    std::vector< std::pair<unsigned,unsigned> > order;
+    order.reserve(assoc);
+    for (unsigned set=0; set < size()/assoc; set++) {
+        order.clear();
+        for (unsigned way=0; way < assoc; way++) {
+            const cache_block_t &line = m_lines[set*assoc+way];
+            if (line.m_status == VALID || line.m_status == MODIFIED) 
+                order.push_back( std::make_pair(line.m_last_access_time,set*assoc+way) );
+        }
+        std::sort(order.begin(),order.end());
+        for (unsigned n=0; n < order.size(); n++) {
+            cache_block_t &line = m_lines[order[n].second];
+            line.m_alloc_time = n;
+            line.m_last_access_time = n;
+            line.m_fill_time = n;
+        }
+    }
 }
 
 float tag_array::windowed_miss_rate( ) const
@@ -349,69 +647,170 @@ bool was_read_sent( const std::list<cache_event> &events )
 }
 /****************************************************************** MSHR ******************************************************************/
 
+const unsigned mshr_table::NO_ENTRY;
+
+mshr_table::mshr_table( unsigned num_entries, unsigned max_merged )
+: m_num_entries(num_entries),
+  m_max_merged(max_merged),
+  m_entries(num_entries),
+  m_merged(num_entries*max_merged),
+  m_used(0),
+  m_ready(num_entries),
+  m_ready_head(0),
+  m_ready_count(0)
+{
+    for ( unsigned i=0; i < num_entries; i++ ) {
+        m_entries[i].m_count = 0;
+        m_free_entries.push_back(num_entries-1-i);
+    }
+    unsigned n = 2;
+    while ( n < 2*num_entries ) 
+        n <<= 1;
+    m_index.assign(n,NO_ENTRY);
+}
+
+/// Slot of block_addr in the index, or the empty slot where it would go
+unsigned mshr_table::find_slot( new_addr_type block_addr ) const{
+    unsigned mask = m_index.size()-1;
+    unsigned i = index_hash(block_addr);
+    while ( m_index[i] != NO_ENTRY && m_entries[m_index[i]].m_block_addr != block_addr ) 
+        i = (i+1) & mask;
+    return i;
+}
+
+/// Remove an index slot, shifting back later members of its probe run
+void mshr_table::erase_slot( unsigned i ){
+    unsigned mask = m_index.size()-1;
+    unsigned j = i;
+    while ( true ) {
+        j = (j+1) & mask;
+        if ( m_index[j] == NO_ENTRY ) 
+            break;
+        unsigned k = index_hash(m_entries[m_index[j]].m_block_addr);
+        if ( (j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j)) ) {
+            m_index[i] = m_index[j];
+            i = j;
+        }
+    }
+    m_index[i] = NO_ENTRY;
+}
+
 /// Checks if there is a pending request to the lower memory level already
 bool mshr_table::probe( new_addr_type block_addr ) const{
-    table::const_iterator a = m_data.find(block_addr);
-    return a != m_data.end();
+    return m_index[find_slot(block_addr)] != NO_ENTRY;
 }
 
 /// Checks if there is space for tracking a new memory access
 bool mshr_table::full( new_addr_type block_addr ) const{
-    table::const_iterator i=m_data.find(block_addr);
-    if ( i != m_data.end() )
-        return i->second.m_list.size() >= m_max_merged;
+    unsigned e = m_index[find_slot(block_addr)];
+    if ( e != NO_ENTRY )
+        return m_entries[e].m_count >= m_max_merged;
     else
-        return m_data.size() >= m_num_entries;
+        return m_used >= m_num_entries;
 }
 
 /// Add or merge this access
 void mshr_table::add( new_addr_type block_addr, mem_fetch *mf ){
-	m_data[block_addr].m_list.push_back(mf);
-	assert( m_data.size() <= m_num_entries );
-	assert( m_data[block_addr].m_list.size() <= m_max_merged );
+    unsigned slot = find_slot(block_addr);
+    unsigned e = m_index[slot];
+    if ( e == NO_ENTRY ) {
+        assert( !m_free_entries.empty() );
+        e = m_free_entries.back();
+        m_free_entries.pop_back();
+        m_used++;
+        m_index[slot] = e;
+        m_entries[e].m_block_addr = block_addr;
+        m_entries[e].m_head = 0;
+        m_entries[e].m_has_atomic = false;
+        m_entries[e].m_prefetch = false;
+    }
+    mshr_entry &entry = m_entries[e];
+    assert( entry.m_count < m_max_merged );
+    m_merged[e*m_max_merged + (entry.m_head+entry.m_count)%m_max_merged] = mf;
+    entry.m_count++;
 	// indicate that this MSHR entry contains an atomic operation
 	if ( mf->isatomic() ) {
-		m_data[block_addr].m_has_atomic = true;
+		entry.m_has_atomic = true;
 	}
 }
 
+/// Allocate a new entry for a prefetch of block_addr
+void mshr_table::add_prefetch( new_addr_type block_addr, mem_fetch *mf ){
+    assert( !probe(block_addr) );
+    add(block_addr,mf);
+    mshr_entry &entry = m_entries[m_index[find_slot(block_addr)]];
+    entry.m_prefetch = true;
+    entry.m_prefetch_claimed = false;
+}
+
+/// Is the pending request a prefetch no demand access has merged into yet? If so, it is now.
+bool mshr_table::claim_prefetch( new_addr_type block_addr ){
+    unsigned e = m_index[find_slot(block_addr)];
+    if ( e == NO_ENTRY || !m_entries[e].m_prefetch || m_entries[e].m_prefetch_claimed ) 
+        return false;
+    m_entries[e].m_prefetch_claimed = true;
+    return true;
+}
+
 /// Accept a new cache fill response: mark entry ready for processing
-void mshr_table::mark_ready( new_addr_type block_addr, bool &has_atomic ){
+void mshr_table::mark_ready( new_addr_type block_addr, bool &has_atomic, bool &unused_prefetch ){
     assert( !busy() );
-    table::iterator a = m_data.find(block_addr);
-    assert( a != m_data.end() ); // don't remove same request twice
-    m_current_response.push_back( block_addr );
-    has_atomic = a->second.m_has_atomic;
-    assert( m_current_response.size() <= m_data.size() );
+    unsigned slot = find_slot(block_addr);
+    unsigned e = m_index[slot];
+    assert( e != NO_ENTRY ); // don't remove same request twice
+    unused_prefetch = false;
+    mshr_entry &entry = m_entries[e];
+    if ( entry.m_prefetch ) {
+        // the prefetch itself is not returned by next_access()
+        entry.m_prefetch = false;
+        entry.m_head = (entry.m_head+1) % m_max_merged;
+        entry.m_count--;
+        if ( entry.m_count == 0 ) {
+            erase_slot(slot);
+            m_free_entries.push_back(e);
+            m_used--;
+            has_atomic = false;
+            unused_prefetch = true;
+            return;
+        }
+    }
+    assert( m_ready_count < m_used );
+    m_ready[(m_ready_head+m_ready_count)%m_num_entries] = e;
+    m_ready_count++;
+    has_atomic = m_entries[e].m_has_atomic;
 }
 
 /// Returns next ready access
 mem_fetch *mshr_table::next_access(){
     assert( access_ready() );
-    new_addr_type block_addr = m_current_response.front();
-    assert( !m_data[block_addr].m_list.empty() );
-    mem_fetch *result = m_data[block_addr].m_list.front();
-    m_data[block_addr].m_list.pop_front();
-    if ( m_data[block_addr].m_list.empty() ) {
+    unsigned e = m_ready[m_ready_head];
+    mshr_entry &entry = m_entries[e];
+    assert( entry.m_count != 0 );
+    mem_fetch *result = m_merged[e*m_max_merged + entry.m_head];
+    entry.m_head = (entry.m_head+1) % m_max_merged;
+    entry.m_count--;
+    if ( entry.m_count == 0 ) {
         // release entry
-        m_data.erase(block_addr);
-        m_current_response.pop_front();
+        erase_slot( find_slot(entry.m_block_addr) );
+        m_free_entries.push_back(e);
+        m_used--;
+        m_ready_head = (m_ready_head+1) % m_num_entries;
+        m_ready_count--;
     }
     return result;
 }
 
 void mshr_table::display( FILE *fp ) const{
     fprintf(fp,"MSHR contents\n");
-    for ( table::const_iterator e=m_data.begin(); e!=m_data.end(); ++e ) {
-        unsigned block_addr = e->first;
-        fprintf(fp,"MSHR: tag=0x%06x, atomic=%d %zu entries : ", block_addr, e->second.m_has_atomic, e->second.m_list.size());
-        if ( !e->second.m_list.empty() ) {
-            mem_fetch *mf = e->second.m_list.front();
-            fprintf(fp,"%p :",mf);
-            mf->print(fp);
-        } else {
-            fprintf(fp," no memory requests???\n");
-        }
+    for ( unsigned e=0; e < m_num_entries; e++ ) {
+        const mshr_entry &entry = m_entries[e];
+        if ( entry.m_count == 0 ) 
+            continue;
+        unsigned block_addr = entry.m_block_addr;
+        fprintf(fp,"MSHR: tag=0x%06x, atomic=%d %u entries : ", block_addr, entry.m_has_atomic, entry.m_count);
+        mem_fetch *mf = m_merged[e*m_max_merged + entry.m_head];
+        fprintf(fp,"%p :",mf);
+        mf->print(fp);
     }
 }
 /***************************************************************** Caches *****************************************************************/
@@ -423,6 +822,42 @@ cache_stats::cache_stats(){
     m_cache_port_available_cycles = 0; 
     m_cache_data_port_busy_cycles = 0; 
     m_cache_fill_port_busy_cycles = 0; 
+    std::fill(m_prefetch, m_prefetch+NUM_PREFETCH_STAT, 0);
+}
+
+void cache_stats::save( FILE *fp ) const
+{
+    for(unsigned i=0; i<NUM_MEM_ACCESS_TYPE; ++i){
+        for(unsigned j=0; j<NUM_CACHE_REQUEST_STATUS; ++j)
+            checkpoint_write(fp,m_stats[i][j]);
+    }
+    checkpoint_write(fp,m_cache_port_available_cycles);
+    checkpoint_write(fp,m_cache_data_port_busy_cycles);
+    checkpoint_write(fp,m_cache_fill_port_busy_cycles);
+    unsigned n = m_mshr_occupancy.size();
+    checkpoint_write(fp,n);
+    for(unsigned i=0; i<n; ++i)
+        checkpoint_write(fp,m_mshr_occupancy[i]);
+    for(unsigned i=0; i<NUM_PREFETCH_STAT; ++i)
+        checkpoint_write(fp,m_prefetch[i]);
+}
+
+void cache_stats::load( FILE *fp )
+{
+    for(unsigned i=0; i<NUM_MEM_ACCESS_TYPE; ++i){
+        for(unsigned j=0; j<NUM_CACHE_REQUEST_STATUS; ++j)
+            checkpoint_read(fp,m_stats[i][j]);
+    }
+    checkpoint_read(fp,m_cache_port_available_cycles);
+    checkpoint_read(fp,m_cache_data_port_busy_cycles);
+    checkpoint_read(fp,m_cache_fill_port_busy_cycles);
+    unsigned n;
+    checkpoint_read(fp,n);
+    m_mshr_occupancy.resize(n);
+    for(unsigned i=0; i<n; ++i)
+        checkpoint_read(fp,m_mshr_occupancy[i]);
+    for(unsigned i=0; i<NUM_PREFETCH_STAT; ++i)
+        checkpoint_read(fp,m_prefetch[i]);
 }
 
 void cache_stats::clear(){
@@ -435,6 +870,8 @@ void cache_stats::clear(){
     m_cache_port_available_cycles = 0; 
     m_cache_data_port_busy_cycles = 0; 
     m_cache_fill_port_busy_cycles = 0; 
+    m_mshr_occupancy.clear();
+    std::fill(m_prefetch, m_prefetch+NUM_PREFETCH_STAT, 0);
 }
 
 void cache_stats::inc_stats(int access_type, int access_outcome){
@@ -451,8 +888,9 @@ enum cache_request_status cache_stats::select_stats_status(enum cache_request_st
 	///
 	/// This function selects how the cache access outcome should be counted. HIT_RESERVED is considered as a MISS
 	/// in the cores, however, it should be counted as a HIT_RESERVED in the caches.
+	/// A SECTOR_MISS is returned to the cores as a MISS but counted separately.
 	///
-	if(probe == HIT_RESERVED && access != RESERVATION_FAIL)
+	if((probe == HIT_RESERVED || probe == SECTOR_MISS) && access != RESERVATION_FAIL)
 		return probe;
 	else
 		return access;
@@ -492,6 +930,13 @@ cache_stats cache_stats::operator+(const cache_stats &cs){
     ret.m_cache_port_available_cycles = m_cache_port_available_cycles + cs.m_cache_port_available_cycles; 
     ret.m_cache_data_port_busy_cycles = m_cache_data_port_busy_cycles + cs.m_cache_data_port_busy_cycles; 
     ret.m_cache_fill_port_busy_cycles = m_cache_fill_port_busy_cycles + cs.m_cache_fill_port_busy_cycles; 
+    ret.m_mshr_occupancy = m_mshr_occupancy;
+    if(ret.m_mshr_occupancy.size() < cs.m_mshr_occupancy.size())
+        ret.m_mshr_occupancy.resize(cs.m_mshr_occupancy.size(), 0);
+    for(unsigned i=0; i<cs.m_mshr_occupancy.size(); ++i)
+        ret.m_mshr_occupancy[i] += cs.m_mshr_occupancy[i];
+    for(unsigned i=0; i<NUM_PREFETCH_STAT; ++i)
+        ret.m_prefetch[i] = m_prefetch[i] + cs.m_prefetch[i];
     return ret;
 }
 
@@ -507,6 +952,12 @@ cache_stats &cache_stats::operator+=(const cache_stats &cs){
     m_cache_port_available_cycles += cs.m_cache_port_available_cycles; 
     m_cache_data_port_busy_cycles += cs.m_cache_data_port_busy_cycles; 
     m_cache_fill_port_busy_cycles += cs.m_cache_fill_port_busy_cycles; 
+    if(m_mshr_occupancy.size() < cs.m_mshr_occupancy.size())
+        m_mshr_occupancy.resize(cs.m_mshr_occupancy.size(), 0);
+    for(unsigned i=0; i<cs.m_mshr_occupancy.size(); ++i)
+        m_mshr_occupancy[i] += cs.m_mshr_occupancy[i];
+    for(unsigned i=0; i<NUM_PREFETCH_STAT; ++i)
+        m_prefetch[i] += cs.m_prefetch[i];
     return *this;
 }
 
@@ -529,6 +980,13 @@ void cache_stats::print_stats(FILE *fout, const char *cache_name) const{
             }
         }
     }
+    if(!m_mshr_occupancy.empty()){
+        // cycles spent with 0,1,2,... MSHR entries allocated
+        fprintf(fout, "\t%s_mshr_occupancy =", m_cache_name.c_str());
+        for(unsigned i=0; i<m_mshr_occupancy.size(); ++i)
+            fprintf(fout, " %llu", m_mshr_occupancy[i]);
+        fprintf(fout, "\n");
+    }
 }
 
 void cache_sub_stats::print_port_stats(FILE *fout, const char *cache_name) const
@@ -545,6 +1003,47 @@ void cache_sub_stats::print_port_stats(FILE *fout, const char *cache_name) const
     fprintf(fout, "%s_fill_port_util = %.3f\n", cache_name, fill_port_util); 
 }
 
+void cache_sub_stats::reg_stats(stat_registry &reg, const std::string &prefix) const
+{
+    reg.reg(prefix + "_accesses", &accesses);
+    reg.reg(prefix + "_misses", &misses);
+    reg.reg(prefix + "_sector_misses", &sector_misses);
+    reg.reg(prefix + "_pending_hits", &pending_hits);
+    reg.reg(prefix + "_reservation_fails", &res_fails);
+    reg.reg(prefix + "_port_available_cycles", &port_available_cycles);
+    reg.reg(prefix + "_data_port_busy_cycles", &data_port_busy_cycles);
+    reg.reg(prefix + "_fill_port_busy_cycles", &fill_port_busy_cycles);
+    // indexed by prefetch_stat: issued, useful, late, unused, throttled, uncovered
+    reg.reg(prefix + "_prefetch", prefetch, NUM_PREFETCH_STAT);
+}
+
+void cache_sub_stats::print_prefetch_stats(FILE *fout, const char *cache_name) const
+{
+    if (prefetch[PREFETCH_ISSUED] == 0 && prefetch[PREFETCH_THROTTLED] == 0) 
+        return; 
+    unsigned long long useful = prefetch[PREFETCH_USEFUL]; 
+    unsigned long long late = prefetch[PREFETCH_LATE]; 
+    fprintf(fout, "%s_prefetch_issued = %llu\n", cache_name, prefetch[PREFETCH_ISSUED]); 
+    fprintf(fout, "%s_prefetch_throttled = %llu\n", cache_name, prefetch[PREFETCH_THROTTLED]); 
+    fprintf(fout, "%s_prefetch_useful = %llu\n", cache_name, useful); 
+    fprintf(fout, "%s_prefetch_late = %llu\n", cache_name, late); 
+    fprintf(fout, "%s_prefetch_unused = %llu\n", cache_name, prefetch[PREFETCH_UNUSED]); 
+    fprintf(fout, "%s_prefetch_uncovered_misses = %llu\n", cache_name, prefetch[PREFETCH_UNCOVERED]); 
+    // accuracy: useful / issued; coverage: demand misses removed or shortened
+    // out of the misses there would have been without prefetching; 
+    // timeliness: useful prefetches that arrived before the demand access
+    float accuracy = 0.0f, coverage = 0.0f, timeliness = 0.0f; 
+    if (prefetch[PREFETCH_ISSUED] > 0) 
+        accuracy = (float) useful / prefetch[PREFETCH_ISSUED]; 
+    if (useful + prefetch[PREFETCH_UNCOVERED] > 0) 
+        coverage = (float) useful / (useful + prefetch[PREFETCH_UNCOVERED]); 
+    if (useful > 0) 
+        timeliness = (float) (useful - late) / useful; 
+    fprintf(fout, "%s_prefetch_accuracy = %.3f\n", cache_name, accuracy); 
+    fprintf(fout, "%s_prefetch_coverage = %.3f\n", cache_name, coverage); 
+    fprintf(fout, "%s_prefetch_timeliness = %.3f\n", cache_name, timeliness); 
+}
+
 unsigned cache_stats::get_stats(enum mem_access_type *access_type, unsigned num_access_type, enum cache_request_status *access_status, unsigned num_access_status) const{
     ///
     /// Returns a sum of the stats corresponding to each "access_type" and "access_status" pair.
@@ -570,12 +1069,15 @@ void cache_stats::get_sub_stats(struct cache_sub_stats &css) const{
 
     for (unsigned type = 0; type < NUM_MEM_ACCESS_TYPE; ++type) {
         for (unsigned status = 0; status < NUM_CACHE_REQUEST_STATUS; ++status) {
-            if(status == HIT || status == MISS || status == HIT_RESERVED)
+            if(status == HIT || status == MISS || status == HIT_RESERVED || status == SECTOR_MISS)
                 t_css.accesses += m_stats[type][status];
 
-            if(status == MISS)
+            if(status == MISS || status == SECTOR_MISS)
                 t_css.misses += m_stats[type][status];
 
+            if(status == SECTOR_MISS)
+                t_css.sector_misses += m_stats[type][status];
+
             if(status == HIT_RESERVED)
                 t_css.pending_hits += m_stats[type][status];
 
@@ -587,6 +1089,8 @@ void cache_stats::get_sub_stats(struct cache_sub_stats &css) const{
     t_css.port_available_cycles = m_cache_port_available_cycles; 
     t_css.data_port_busy_cycles = m_cache_data_port_busy_cycles; 
     t_css.fill_port_busy_cycles = m_cache_fill_port_busy_cycles; 
+    for(unsigned i=0; i<NUM_PREFETCH_STAT; ++i)
+        t_css.prefetch[i] = m_prefetch[i];
 
     css = t_css;
 }
@@ -612,6 +1116,13 @@ void cache_stats::sample_cache_port_utility(bool data_port_busy, bool fill_port_
     } 
 }
 
+void cache_stats::sample_mshr_occupancy(unsigned n)
+{
+    if (n >= m_mshr_occupancy.size()) 
+        m_mshr_occupancy.resize(n+1, 0);
+    m_mshr_occupancy[n]++;
+}
+
 baseline_cache::bandwidth_management::bandwidth_management(cache_config &config) 
 : m_config(config)
 {
@@ -680,6 +1191,35 @@ bool baseline_cache::bandwidth_management::fill_port_free() const
     return (m_fill_port_occupied_cycles == 0); 
 }
 
+void baseline_cache::save( FILE *fp ) const
+{
+    checkpoint_write_string(fp,m_name);
+    m_tag_array->save(fp);
+    m_stats.save(fp);
+}
+
+void baseline_cache::load( FILE *fp )
+{
+    std::string name = checkpoint_read_string(fp);
+    if (name != m_name) {
+        printf("GPGPU-Sim uArch: ERROR ** checkpoint holds cache %s where %s was expected\n",
+               name.c_str(), m_name.c_str());
+        exit(1);
+    }
+    if (!m_tag_array->load(fp)) 
+        printf("GPGPU-Sim uArch: WARNING ** %s geometry differs from the checkpoint, starting it cold\n", m_name.c_str());
+    m_stats.load(fp);
+}
+
+void baseline_cache::warm( new_addr_type addr, unsigned time, bool write )
+{
+    // only a write-back cache keeps the lines a write leaves behind
+    if (!write) 
+        m_tag_array->warm(addr,time,false);
+    else if (m_config.m_write_policy == WRITE_BACK) 
+        m_tag_array->warm(addr,time,true);
+}
+
 /// Sends next request to lower level of memory
 void baseline_cache::cycle(){
     if ( !m_miss_queue.empty() ) {
@@ -692,6 +1232,7 @@ void baseline_cache::cycle(){
     bool data_port_busy = !m_bandwidth_management.data_port_free(); 
     bool fill_port_busy = !m_bandwidth_management.fill_port_free(); 
     m_stats.sample_cache_port_utility(data_port_busy, fill_port_busy); 
+    m_stats.sample_mshr_occupancy(m_mshrs.occupancy());
     m_bandwidth_management.replenish_port_bandwidth(); 
 }
 
@@ -701,20 +1242,33 @@ void baseline_cache::fill(mem_fetch *mf, unsigned time){
     assert( e != m_extra_mf_fields.end() );
     assert( e->second.m_valid );
     mf->set_data_size( e->second.m_data_size );
+    unsigned cache_index = e->second.m_cache_index;
     if ( m_config.m_alloc_policy == ON_MISS )
-        m_tag_array->fill(e->second.m_cache_index,time);
-    else if ( m_config.m_alloc_policy == ON_FILL )
-        m_tag_array->fill(e->second.m_block_addr,time);
-    else abort();
+        m_tag_array->fill(cache_index,time);
+    else if ( m_config.m_alloc_policy == ON_FILL ) {
+        m_tag_array->probe(e->second.m_block_addr,cache_index);
+        if ( holds_unused_prefetch(cache_index) ) 
+            m_stats.inc_prefetch_stats(PREFETCH_UNUSED);
+        m_tag_array->fill(e->second.m_block_addr,time,mf);
+    } else abort();
     bool has_atomic = false;
-    m_mshrs.mark_ready(e->second.m_block_addr, has_atomic);
+    bool unused_prefetch = false;
+    m_mshrs.mark_ready(e->second.m_block_addr, has_atomic, unused_prefetch);
     if (has_atomic) {
         assert(m_config.m_alloc_policy == ON_MISS);
-        cache_block_t &block = m_tag_array->get_block(e->second.m_cache_index);
-        block.m_status = MODIFIED; // mark line as dirty for atomic operation
+        m_tag_array->mark_modified(e->second.m_cache_index); // mark line as dirty for atomic operation
     }
+    if (unused_prefetch) 
+        m_tag_array->set_prefetched(cache_index, true);
+    bool prefetch = e->second.m_prefetch;
     m_extra_mf_fields.erase(mf);
     m_bandwidth_management.use_fill_port(mf); 
+    if (prefetch) {
+        // nothing above this cache is waiting for a prefetch
+        assert(m_prefetch_inflight > 0);
+        m_prefetch_inflight--;
+        delete mf;
+    }
 }
 
 /// Checks if mf is waiting to be filled by lower memory level
@@ -751,22 +1305,26 @@ void baseline_cache::send_read_request(new_addr_type addr, new_addr_type block_a
     bool mshr_avail = !m_mshrs.full(block_addr);
     if ( mshr_hit && mshr_avail ) {
     	if(read_only)
-    		m_tag_array->access(block_addr,time,cache_index);
+    		m_tag_array->access(block_addr,time,cache_index,mf);
     	else
-    		m_tag_array->access(block_addr,time,cache_index,wb,evicted);
+    		m_tag_array->access(block_addr,time,cache_index,wb,evicted,mf);
 
         m_mshrs.add(block_addr,mf);
         do_miss = true;
     } else if ( !mshr_hit && mshr_avail && (m_miss_queue.size() < m_config.m_miss_queue_size) ) {
     	if(read_only)
-    		m_tag_array->access(block_addr,time,cache_index);
+    		m_tag_array->access(block_addr,time,cache_index,mf);
     	else
-    		m_tag_array->access(block_addr,time,cache_index,wb,evicted);
+    		m_tag_array->access(block_addr,time,cache_index,wb,evicted,mf);
 
         m_mshrs.add(block_addr,mf);
         m_extra_mf_fields[mf] = extra_mf_fields(block_addr,cache_index, mf->get_data_size());
 		
-        mf->set_data_size( m_config.get_line_sz() );
+        if ( m_config.is_sectored() ) // only the sectors the line is missing
+            mf->set_data_size( m_config.get_sector_sz() * 
+                __builtin_popcount(m_tag_array->get_block(cache_index).m_sector_pending) );
+        else 
+            mf->set_data_size( m_config.get_line_sz() );
         m_miss_queue.push_back(mf);
         mf->set_status(m_miss_queue_status,time);
         if(!wa)
@@ -777,6 +1335,22 @@ void baseline_cache::send_read_request(new_addr_type addr, new_addr_type block_a
 
 
 /// Sends write request to lower level memory (write or writeback)
+/// Write back an evicted line, one request per contiguous run of dirty sectors
+void data_cache::send_writeback(const cache_block_t &evicted, unsigned time, std::list<cache_event> *events){
+    unsigned from = 0;
+    new_addr_type addr;
+    unsigned size;
+    while ( m_config.writeback_run(evicted, from, addr, size) ) {
+        mem_fetch *wb = m_memfetch_creator->alloc(addr, m_wrbk_type, size, true);
+        if ( events ) 
+            send_write_request(wb, WRITE_BACK_REQUEST_SENT, time, *events);
+        else {
+            m_miss_queue.push_back(wb);
+            wb->set_status(m_miss_queue_status,time);
+        }
+    }
+}
+
 void data_cache::send_write_request(mem_fetch *mf, cache_event request, unsigned time, std::list<cache_event> &events){
     events.push_back(request);
     m_miss_queue.push_back(mf);
@@ -789,9 +1363,8 @@ void data_cache::send_write_request(mem_fetch *mf, cache_event request, unsigned
 /// Write-back hit: Mark block as modified
 cache_request_status data_cache::wr_hit_wb(new_addr_type addr, unsigned cache_index, mem_fetch *mf, unsigned time, std::list<cache_event> &events, enum cache_request_status status ){
 	new_addr_type block_addr = m_config.block_addr(addr);
-	m_tag_array->access(block_addr,time,cache_index); // update LRU state
-	cache_block_t &block = m_tag_array->get_block(cache_index);
-	block.m_status = MODIFIED;
+	m_tag_array->access(block_addr,time,cache_index,mf); // update LRU state
+	m_tag_array->mark_modified(cache_index, mf);
 
 	return HIT;
 }
@@ -802,9 +1375,8 @@ cache_request_status data_cache::wr_hit_wt(new_addr_type addr, unsigned cache_in
 		return RESERVATION_FAIL; // cannot handle request this cycle
 
 	new_addr_type block_addr = m_config.block_addr(addr);
-	m_tag_array->access(block_addr,time,cache_index); // update LRU state
-	cache_block_t &block = m_tag_array->get_block(cache_index);
-	block.m_status = MODIFIED;
+	m_tag_array->access(block_addr,time,cache_index,mf); // update LRU state
+	m_tag_array->mark_modified(cache_index, mf);
 
 	// generate a write-through
 	send_write_request(mf, WRITE_REQUEST_SENT, time, events);
@@ -818,11 +1390,10 @@ cache_request_status data_cache::wr_hit_we(new_addr_type addr, unsigned cache_in
 		return RESERVATION_FAIL; // cannot handle request this cycle
 
 	// generate a write-through/evict
-	cache_block_t &block = m_tag_array->get_block(cache_index);
 	send_write_request(mf, WRITE_REQUEST_SENT, time, events);
 
-	// Invalidate block
-	block.m_status = INVALID;
+	// Invalidate block (only the written sectors of a sectored line)
+	m_tag_array->invalidate(cache_index, mf);
 
 	return HIT;
 }
@@ -848,11 +1419,12 @@ data_cache::wr_miss_wa( new_addr_type addr,
 {
     new_addr_type block_addr = m_config.block_addr(addr);
 
-    // Write allocate, maximum 3 requests (write miss, read request, write back request)
+    // Write allocate, maximum 2 requests plus the write backs (write miss, 
+    // read request, one write back per run of dirty sectors of the victim)
     // Conservatively ensure the worst-case request can be handled this cycle
     bool mshr_hit = m_mshrs.probe(block_addr);
     bool mshr_avail = !m_mshrs.full(block_addr);
-    if(miss_queue_full(2) 
+    if(miss_queue_full(1 + writeback_slots(cache_index,status)) 
         || (!(mshr_hit && mshr_avail) 
         && !(!mshr_hit && mshr_avail 
         && (m_miss_queue.size() < m_config.m_miss_queue_size))))
@@ -890,10 +1462,7 @@ data_cache::wr_miss_wa( new_addr_type addr,
         // If evicted block is modified and not a write-through
         // (already modified lower level)
         if( wb && (m_config.m_write_policy != WRITE_THROUGH) ) { 
-            mem_fetch *wb = m_memfetch_creator->alloc(evicted.m_block_addr,
-                m_wrbk_type,m_config.get_line_sz(),true);
-            m_miss_queue.push_back(wb);
-            wb->set_status(m_miss_queue_status,time);
+            send_writeback(evicted, time, NULL);
         }
         return MISS;
     }
@@ -932,13 +1501,12 @@ data_cache::rd_hit_base( new_addr_type addr,
                          enum cache_request_status status )
 {
     new_addr_type block_addr = m_config.block_addr(addr);
-    m_tag_array->access(block_addr,time,cache_index);
+    m_tag_array->access(block_addr,time,cache_index,mf);
     // Atomics treated as global read/write requests - Perform read, mark line as
     // MODIFIED
     if(mf->isatomic()){ 
         assert(mf->get_access_type() == GLOBAL_ACC_R);
-        cache_block_t &block = m_tag_array->get_block(cache_index);
-        block.m_status = MODIFIED;  // mark line as dirty
+        m_tag_array->mark_modified(cache_index, mf);  // mark line as dirty
     }
     return HIT;
 }
@@ -954,9 +1522,9 @@ data_cache::rd_miss_base( new_addr_type addr,
                           unsigned time,
                           std::list<cache_event> &events,
                           enum cache_request_status status ){
-    if(miss_queue_full(1))
+    if(miss_queue_full(writeback_slots(cache_index,status)))
         // cannot handle request this cycle
-        // (might need to generate two requests)
+        // (might need to generate the read and the victim's write backs)
         return RESERVATION_FAIL; 
 
     new_addr_type block_addr = m_config.block_addr(addr);
@@ -972,9 +1540,7 @@ data_cache::rd_miss_base( new_addr_type addr,
         // If evicted block is modified and not a write-through
         // (already modified lower level)
         if(wb && (m_config.m_write_policy != WRITE_THROUGH) ){ 
-            mem_fetch *wb = m_memfetch_creator->alloc(evicted.m_block_addr,
-                m_wrbk_type,m_config.get_line_sz(),true);
-        send_write_request(wb, WRITE_BACK_REQUEST_SENT, time, events);
+            send_writeback(evicted, time, &events);
     }
         return MISS;
     }
@@ -998,7 +1564,7 @@ read_only_cache::access( new_addr_type addr,
     enum cache_request_status cache_status = RESERVATION_FAIL;
 
     if ( status == HIT ) {
-        cache_status = m_tag_array->access(block_addr,time,cache_index); // update LRU state
+        cache_status = m_tag_array->access(block_addr,time,cache_index,mf); // update LRU state
     }else if ( status != RESERVATION_FAIL ) {
         if(!miss_queue_full(0)){
             bool do_miss=false;
@@ -1076,14 +1642,99 @@ data_cache::access( new_addr_type addr,
     new_addr_type block_addr = m_config.block_addr(addr);
     unsigned cache_index = (unsigned)-1;
     enum cache_request_status probe_status
-        = m_tag_array->probe( block_addr, cache_index );
+        = m_tag_array->probe( block_addr, cache_index, mf );
+    bool victim_prefetched = false;
+    if ( m_prefetcher && probe_status == MISS ) 
+        victim_prefetched = holds_unused_prefetch(cache_index);
     enum cache_request_status access_status
         = process_tag_probe( wr, probe_status, addr, cache_index, mf, time, events );
     m_stats.inc_stats(mf->get_access_type(),
         m_stats.select_stats_status(probe_status, access_status));
+    if ( m_prefetcher ) 
+        prefetch_access( wr, probe_status, access_status, block_addr, cache_index, victim_prefetched, mf, time );
     return access_status;
 }
 
+/// Prefetch accounting and training after the demand access mf
+void data_cache::prefetch_access( bool wr,
+                                  enum cache_request_status probe_status,
+                                  enum cache_request_status access_status,
+                                  new_addr_type block_addr,
+                                  unsigned cache_index,
+                                  bool victim_prefetched,
+                                  mem_fetch *mf,
+                                  unsigned time )
+{
+    if ( access_status == RESERVATION_FAIL ) 
+        return; // the access will be retried
+    if ( access_status == HIT ) {
+        if ( m_tag_array->get_block(cache_index).m_prefetched ) {
+            m_stats.inc_prefetch_stats(PREFETCH_USEFUL);
+            m_tag_array->set_prefetched(cache_index, false);
+        }
+    } else {
+        // allocation on miss clears the flag of the line it replaced
+        if ( victim_prefetched && !m_tag_array->get_block(cache_index).m_prefetched ) 
+            m_stats.inc_prefetch_stats(PREFETCH_UNUSED);
+        // a read, or a write allocate, waits in the MSHR for a prefetch in flight
+        if ( (!wr || m_config.m_write_alloc_policy == WRITE_ALLOCATE) && m_mshrs.claim_prefetch(block_addr) ) {
+            m_stats.inc_prefetch_stats(PREFETCH_USEFUL);
+            m_stats.inc_prefetch_stats(PREFETCH_LATE);
+        } else if ( probe_status == MISS || probe_status == SECTOR_MISS ) {
+            m_stats.inc_prefetch_stats(PREFETCH_UNCOVERED);
+        }
+    }
+    if ( wr ) 
+        return;
+    m_prefetch_candidates.clear();
+    m_prefetcher->observe( block_addr, probe_status != HIT, mf, m_prefetch_candidates );
+    for ( unsigned i=0; i < m_prefetch_candidates.size(); i++ ) 
+        issue_prefetch( m_config.block_addr(m_prefetch_candidates[i]), mf, time );
+}
+
+/// Sends a prefetch of block_addr if it is not already cached or pending
+/// and the prefetch throttle, MSHRs and miss queue leave room for it
+void data_cache::issue_prefetch( new_addr_type block_addr, const mem_fetch *demand, unsigned time )
+{
+    unsigned cache_index = (unsigned)-1;
+    if ( m_tag_array->probe(block_addr,cache_index) != MISS || m_mshrs.probe(block_addr) ) 
+        return;
+    // prefetches are only trained by reads; keep the space of the demand
+    // (a local prefetch must fill the L1D even when global reads bypass it)
+    mem_access_type type = demand->get_access_type();
+    if ( type == L1_WR_ALLOC_R || type == L2_WR_ALLOC_R ) 
+        type = GLOBAL_ACC_R;
+    mem_fetch *mf = m_memfetch_creator->alloc(block_addr, type, m_config.get_line_sz(), false);
+    if ( !prefetch_allowed(mf,demand) ) {
+        delete mf;
+        return;
+    }
+    // demand misses keep a miss queue slot for themselves (and their writebacks)
+    if ( m_prefetch_inflight >= m_config.get_prefetch_max_inflight() 
+         || m_mshrs.full(block_addr) || miss_queue_full(writeback_slots(cache_index,MISS)) ) {
+        m_stats.inc_prefetch_stats(PREFETCH_THROTTLED);
+        delete mf;
+        return;
+    }
+
+    bool wb = false;
+    cache_block_t evicted;
+    if ( m_config.m_alloc_policy == ON_MISS ) {
+        if ( holds_unused_prefetch(cache_index) ) 
+            m_stats.inc_prefetch_stats(PREFETCH_UNUSED);
+        m_tag_array->allocate_prefetch(block_addr, time, cache_index, wb, evicted, mf);
+    }
+    m_mshrs.add_prefetch(block_addr, mf);
+    m_extra_mf_fields[mf] = extra_mf_fields(block_addr, cache_index, mf->get_data_size(), true);
+    m_miss_queue.push_back(mf);
+    mf->set_status(m_miss_queue_status,time);
+    if ( wb && (m_config.m_write_policy != WRITE_THROUGH) ) {
+        send_writeback(evicted, time, NULL);
+    }
+    m_prefetch_inflight++;
+    m_stats.inc_prefetch_stats(PREFETCH_ISSUED);
+}
+
 /// This is meant to model the first level data cache in Fermi.
 /// It is write-evict (global) or write-back (local) at the
 /// granularity of individual blocks (Set by GPGPU-Sim configuration file)
@@ -1125,7 +1776,7 @@ enum cache_request_status tex_cache::access( new_addr_type addr, mem_fetch *mf,
     // at this point, we will accept the request : access tags and immediately allocate line
     new_addr_type block_addr = m_config.block_addr(addr);
     unsigned cache_index = (unsigned)-1;
-    enum cache_request_status status = m_tags.access(block_addr,time,cache_index);
+    enum cache_request_status status = m_tags.access(block_addr,time,cache_index,mf);
     enum cache_request_status cache_status = RESERVATION_FAIL;
     assert( status != RESERVATION_FAIL );
     assert( status != HIT_RESERVED ); // as far as tags are concerned: HIT or MISS
@@ -1202,6 +1853,42 @@ void tex_cache::fill( mem_fetch *mf, unsigned time )
     assert( r.m_block_addr == m_config.block_addr(mf->get_addr()) );
 }
 
+void tex_cache::save( FILE *fp ) const
+{
+    checkpoint_write_string(fp,m_name);
+    m_tags.save(fp);
+    unsigned n_lines = m_config.get_num_lines();
+    checkpoint_write(fp,n_lines);
+    for (unsigned i=0; i < n_lines; i++) {
+        checkpoint_write(fp,m_cache[i].m_valid);
+        checkpoint_write(fp,m_cache[i].m_block_addr);
+    }
+    m_stats.save(fp);
+}
+
+void tex_cache::load( FILE *fp )
+{
+    std::string name = checkpoint_read_string(fp);
+    if (name != m_name) {
+        printf("GPGPU-Sim uArch: ERROR ** checkpoint holds cache %s where %s was expected\n",
+               name.c_str(), m_name.c_str());
+        exit(1);
+    }
+    bool same_geometry = m_tags.load(fp);
+    unsigned n_lines;
+    checkpoint_read(fp,n_lines);
+    for (unsigned i=0; i < n_lines; i++) {
+        data_block block;
+        checkpoint_read(fp,block.m_valid);
+        checkpoint_read(fp,block.m_block_addr);
+        if (same_geometry) 
+            m_cache[i] = block;
+    }
+    if (!same_geometry) 
+        printf("GPGPU-Sim uArch: WARNING ** %s geometry differs from the checkpoint, starting it cold\n", m_name.c_str());
+    m_stats.load(fp);
+}
+
 void tex_cache::display_state( FILE *fp ) const
 {
     fprintf(fp,"%s (texture cache) state:\n", m_name.c_str() );
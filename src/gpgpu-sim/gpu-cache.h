@@ -36,6 +36,8 @@
 #include "../tr1_hash_map.h"
 
 #include "addrdec.h"
+#include "cache_replacement.h"
+#include "cache_prefetcher.h"
 
 enum cache_block_state {
     INVALID,
@@ -49,6 +51,7 @@ enum cache_request_status {
     HIT_RESERVED,
     MISS,
     RESERVATION_FAIL, 
+    SECTOR_MISS, // sectored caches: the line is present but some of the requested sectors are not
     NUM_CACHE_REQUEST_STATUS
 };
 
@@ -60,6 +63,16 @@ enum cache_event {
 
 const char * cache_request_status_str(enum cache_request_status status); 
 
+enum prefetch_stat {
+    PREFETCH_ISSUED,    // sent to the lower level
+    PREFETCH_USEFUL,    // a demand access used the line (includes PREFETCH_LATE)
+    PREFETCH_LATE,      // the demand access arrived before the fill and waited for it
+    PREFETCH_UNUSED,    // the line was evicted before any demand access used it
+    PREFETCH_THROTTLED, // candidate dropped: too many in flight or no MSHR/miss queue space
+    PREFETCH_UNCOVERED, // demand miss that no prefetch had asked for
+    NUM_PREFETCH_STAT
+};
+
 struct cache_block_t {
     cache_block_t()
     {
@@ -69,6 +82,10 @@ struct cache_block_t {
         m_fill_time=0;
         m_last_access_time=0;
         m_status=INVALID;
+        m_prefetched=false;
+        m_sector_valid=0;
+        m_sector_pending=0;
+        m_sector_dirty=0;
     }
     void allocate( new_addr_type tag, new_addr_type block_addr, unsigned time )
     {
@@ -78,6 +95,10 @@ struct cache_block_t {
         m_last_access_time=time;
         m_fill_time=0;
         m_status=RESERVED;
+        m_prefetched=false;
+        m_sector_valid=0;
+        m_sector_pending=0;
+        m_sector_dirty=0;
     }
     void fill( unsigned time )
     {
@@ -92,11 +113,29 @@ struct cache_block_t {
     unsigned         m_last_access_time;
     unsigned         m_fill_time;
     cache_block_state    m_status;
+    bool             m_prefetched; // filled by a prefetch no demand access has used yet
+
+    // sectored caches only (bit i = sector i of the line); a line with 
+    // pending sectors is RESERVED and has only one fetch in flight
+    unsigned         m_sector_valid;
+    unsigned         m_sector_pending;
+    unsigned         m_sector_dirty;
 };
 
 enum replacement_policy_t {
     LRU,
-    FIFO
+    FIFO,
+    SRRIP,
+    BRRIP,
+    DRRIP,
+    SHIP_PC
+};
+
+enum prefetcher_t {
+    PREFETCH_NONE,
+    PREFETCH_NEXT_LINE,
+    PREFETCH_STRIDE_PC,
+    PREFETCH_WARP_STRIDE
 };
 
 enum write_policy_t {
@@ -138,8 +177,11 @@ public:
         m_config_string = NULL; // set by option parser
         m_config_stringPrefL1 = NULL;
         m_config_stringPrefShared = NULL;
+        m_prefetch_string = NULL; // set by option parser (L1D and L2 only)
+        m_prefetcher = PREFETCH_NONE;
         m_data_port_width = 0;
         m_set_index_function = LINEAR_SET_FUNCTION;
+        m_sector_sz = 0;
     }
     void init(char * config, FuncCache status)
     {
@@ -147,12 +189,25 @@ public:
         assert( config );
         char rp, wp, ap, mshr_type, wap, sif;
 
-
-        int ntok = sscanf(config,"%u:%u:%u,%c:%c:%c:%c:%c,%c:%u:%u,%u:%u,%u",
+        // the first field may carry a sector size: <nsets>:<bsize>:<assoc>:<sector size>
+        unsigned n_colons = 0;
+        for (const char *c = config; *c && *c != ','; c++) 
+            n_colons += (*c == ':');
+        m_sector_sz = 0;
+        int ntok;
+        if ( n_colons == 3 ) {
+            ntok = sscanf(config,"%u:%u:%u:%u,%c:%c:%c:%c:%c,%c:%u:%u,%u:%u,%u",
+                          &m_nset, &m_line_sz, &m_assoc, &m_sector_sz, &rp, &wp, &ap, &wap,
+                          &sif,&mshr_type,&m_mshr_entries,&m_mshr_max_merge,
+                          &m_miss_queue_size, &m_result_fifo_entries,
+                          &m_data_port_width) - 1;
+        } else {
+            ntok = sscanf(config,"%u:%u:%u,%c:%c:%c:%c:%c,%c:%u:%u,%u:%u,%u",
                           &m_nset, &m_line_sz, &m_assoc, &rp, &wp, &ap, &wap,
                           &sif,&mshr_type,&m_mshr_entries,&m_mshr_max_merge,
                           &m_miss_queue_size, &m_result_fifo_entries,
                           &m_data_port_width);
+        }
 
         if ( ntok < 11 ) {
             if ( !strcmp(config,"none") ) {
@@ -164,6 +219,10 @@ public:
         switch (rp) {
         case 'L': m_replacement_policy = LRU; break;
         case 'F': m_replacement_policy = FIFO; break;
+        case 'S': m_replacement_policy = SRRIP; break;
+        case 'B': m_replacement_policy = BRRIP; break;
+        case 'D': m_replacement_policy = DRRIP; break;
+        case 'P': m_replacement_policy = SHIP_PC; break;
         default: exit_parse_error();
         }
         switch (wp) {
@@ -208,6 +267,17 @@ public:
             assert(0 && "Invalid cache configuration: Writeback cache cannot allocate new line on fill. "); 
         }
 
+        // sectors are fetched separately, so a sector miss needs the line 
+        // reserved in the tag array
+        if (m_sector_sz == m_line_sz) 
+            m_sector_sz = 0;
+        if (m_sector_sz) {
+            if (m_line_sz % m_sector_sz != 0 || m_line_sz / m_sector_sz > 32 || m_alloc_policy != ON_MISS) {
+                printf("GPGPU-Sim uArch: ERROR ** sectored cache (%s) needs a sector size that divides the line into at most 32 sectors and allocation on miss\n", config);
+                exit(1);
+            }
+        }
+
         // default: port to data array width and granularity = line size 
         if (m_data_port_width == 0) {
             m_data_port_width = m_line_sz; 
@@ -220,6 +290,25 @@ public:
         case 'L': m_set_index_function = LINEAR_SET_FUNCTION; break;
         default: exit_parse_error();
         }
+
+        init_prefetcher();
+    }
+    // <type>:<degree>:<max prefetches in flight>, or "none"
+    void init_prefetcher()
+    {
+        m_prefetcher = PREFETCH_NONE;
+        if ( m_prefetch_string == NULL || !strcmp(m_prefetch_string,"none") ) 
+            return;
+        char pt;
+        int ntok = sscanf(m_prefetch_string,"%c:%u:%u", &pt, &m_prefetch_degree, &m_prefetch_max_inflight);
+        if ( ntok != 3 || m_prefetch_degree == 0 || m_prefetch_max_inflight == 0 ) 
+            exit_prefetch_parse_error();
+        switch (pt) {
+        case 'N': m_prefetcher = PREFETCH_NEXT_LINE; break;
+        case 'S': m_prefetcher = PREFETCH_STRIDE_PC; break;
+        case 'W': m_prefetcher = PREFETCH_WARP_STRIDE; break;
+        default: exit_prefetch_parse_error();
+        }
     }
     bool disabled() const { return m_disabled;}
     unsigned get_line_sz() const
@@ -232,6 +321,54 @@ public:
         assert( m_valid );
         return m_nset * m_assoc;
     }
+    unsigned get_assoc() const { return m_assoc; }
+    bool is_sectored() const { return m_sector_sz != 0; }
+    unsigned get_sector_sz() const { return m_sector_sz; }
+    unsigned get_num_sectors() const { return m_sector_sz? m_line_sz / m_sector_sz : 1; }
+    unsigned full_sector_mask() const
+    {
+        unsigned n = get_num_sectors();
+        return (n == 32)? ~0U : ((1U << n) - 1);
+    }
+    // sectors of its line that mf touches (every sector if mf is NULL)
+    unsigned sector_mask( const mem_fetch *mf ) const;
+    // next writeback of an evicted line at or after sector 'from': a sectored
+    // cache writes each contiguous run of dirty sectors separately, so the 
+    // lower level marks exactly those sectors dirty; returns false when done
+    bool writeback_run( const cache_block_t &line, unsigned &from, new_addr_type &addr, unsigned &size ) const
+    {
+        if (!m_sector_sz || !line.m_sector_dirty) {
+            if (from) 
+                return false;
+            from = get_num_sectors();
+            addr = line.m_block_addr;
+            size = m_line_sz;
+            return true;
+        }
+        unsigned dirty = (from < 32)? (line.m_sector_dirty >> from) << from : 0;
+        if (!dirty) 
+            return false;
+        unsigned first = __builtin_ctz(dirty);
+        unsigned last = first;
+        while (last + 1 < get_num_sectors() && (dirty & (1U << (last + 1)))) 
+            last++;
+        from = last + 1;
+        addr = line.m_block_addr + first * m_sector_sz;
+        size = (last - first + 1) * m_sector_sz;
+        return true;
+    }
+    unsigned writeback_runs( const cache_block_t &line ) const
+    {
+        unsigned from = 0, n = 0, size;
+        new_addr_type addr;
+        while (writeback_run(line, from, addr, size)) 
+            n++;
+        return n;
+    }
+    enum replacement_policy_t get_replacement_policy() const { return m_replacement_policy; }
+    enum prefetcher_t get_prefetcher() const { return m_prefetcher; }
+    unsigned get_prefetch_degree() const { return m_prefetch_degree; }
+    unsigned get_prefetch_max_inflight() const { return m_prefetch_max_inflight; }
 
     void print( FILE *fp ) const
     {
@@ -269,6 +406,7 @@ public:
     char *m_config_string;
     char *m_config_stringPrefL1;
     char *m_config_stringPrefShared;
+    char *m_prefetch_string;
     FuncCache cache_status;
 
 protected:
@@ -277,6 +415,11 @@ protected:
         printf("GPGPU-Sim uArch: cache configuration parsing error (%s)\n", m_config_string );
         abort();
     }
+    void exit_prefetch_parse_error()
+    {
+        printf("GPGPU-Sim uArch: prefetcher configuration parsing error (%s)\n", m_prefetch_string );
+        abort();
+    }
 
     bool m_valid;
     bool m_disabled;
@@ -285,11 +428,15 @@ protected:
     unsigned m_nset;
     unsigned m_nset_log2;
     unsigned m_assoc;
+    unsigned m_sector_sz; // 0 = not sectored
 
-    enum replacement_policy_t m_replacement_policy; // 'L' = LRU, 'F' = FIFO
+    enum replacement_policy_t m_replacement_policy; // 'L' = LRU, 'F' = FIFO, 'S' = SRRIP, 'B' = BRRIP, 'D' = DRRIP, 'P' = SHiP-PC
     enum write_policy_t m_write_policy;             // 'T' = write through, 'B' = write back, 'R' = read only
     enum allocation_policy_t m_alloc_policy;        // 'm' = allocate on miss, 'f' = allocate on fill
     enum mshr_config_t m_mshr_type;
+    enum prefetcher_t m_prefetcher;                 // 'N' = next-line, 'S' = stride per PC, 'W' = inter-warp stride
+    unsigned m_prefetch_degree;
+    unsigned m_prefetch_max_inflight;
 
     write_allocate_policy_t m_write_alloc_policy;	// 'W' = Write allocate, 'N' = No write allocate
 
@@ -340,19 +487,43 @@ public:
     tag_array(cache_config &config, int core_id, int type_id );
     ~tag_array();
 
-    enum cache_request_status probe( new_addr_type addr, unsigned &idx ) const;
-    enum cache_request_status access( new_addr_type addr, unsigned time, unsigned &idx );
-    enum cache_request_status access( new_addr_type addr, unsigned time, unsigned &idx, bool &wb, cache_block_t &evicted );
+    // mf (if any) is the request behind the probe; a sectored cache looks 
+    // at the sectors it touches (all of them without mf)
+    enum cache_request_status probe( new_addr_type addr, unsigned &idx, const mem_fetch *mf = NULL ) const;
+    // mf (if any) is the request behind the access, for PC based replacement
+    enum cache_request_status access( new_addr_type addr, unsigned time, unsigned &idx, const mem_fetch *mf = NULL );
+    enum cache_request_status access( new_addr_type addr, unsigned time, unsigned &idx, bool &wb, cache_block_t &evicted, const mem_fetch *mf = NULL );
 
-    void fill( new_addr_type addr, unsigned time );
+    void fill( new_addr_type addr, unsigned time, const mem_fetch *mf = NULL );
     void fill( unsigned idx, unsigned time );
+    // allocate line idx, which probe() returned for a MISS on addr, to a 
+    // prefetch; unlike access() this is not counted as a cache access
+    void allocate_prefetch( new_addr_type addr, unsigned time, unsigned idx, bool &wb, cache_block_t &evicted, const mem_fetch *mf );
+    void set_prefetched( unsigned idx, bool prefetched ) { m_lines[idx].m_prefetched = prefetched; }
+    // write to line idx: marks the sectors mf touches (all without mf) dirty
+    void mark_modified( unsigned idx, const mem_fetch *mf = NULL );
+    // write-evict: drops the sectors mf touches, or the line if nothing else is left
+    void invalidate( unsigned idx, const mem_fetch *mf );
 
     unsigned size() const { return m_config.get_num_lines();}
-    cache_block_t &get_block(unsigned idx) { return m_lines[idx];}
+    const cache_block_t &get_block(unsigned idx) const { return m_lines[idx];}
+    // line state changes go through here to keep the lookup masks in sync
+    void set_status(unsigned idx, enum cache_block_state status);
 
     void flush(); // flash invalidate all entries
     void new_window();
 
+    // checkpoint support: load() returns false (and leaves the lines alone) 
+    // if the checkpoint was taken with a different cache geometry
+    void save( FILE *fp ) const;
+    bool load( FILE *fp );
+
+    // fast-forward warm-up: installs the block of addr without counting an 
+    // access; 'time' is the replay order, which warm_done() compacts to a 
+    // per-set rank so warmed lines look older than any simulated access
+    void warm( new_addr_type addr, unsigned time, bool dirty );
+    void warm_done();
+
     void print( FILE *stream, unsigned &total_access, unsigned &total_misses ) const;
     float windowed_miss_rate( ) const;
     void get_stats(unsigned &total_access, unsigned &total_misses, unsigned &total_hit_res, unsigned &total_res_fail) const;
@@ -368,11 +539,27 @@ protected:
                cache_block_t* new_lines );
     void init( int core_id, int type_id );
 
+    void allocate_line( unsigned idx, new_addr_type addr, unsigned time, const mem_fetch *mf, unsigned sector_mask );
+    void fill_line( unsigned idx, unsigned time );
+    enum cache_request_status sector_status( const cache_block_t &line, unsigned sector_mask ) const;
+    void sync_lookup( unsigned idx );
+    void rebuild_lookup();
+
 protected:
 
     cache_config &m_config;
 
     cache_block_t *m_lines; /* nbanks x nset x assoc lines in total */
+    unsigned m_n_alloc_lines;
+    cache_replacement_policy *m_policy;
+
+    // probe() lookup state, kept as structure of arrays next to m_lines: the
+    // tags of a set are contiguous, and each set has m_mask_words 64-bit 
+    // masks of its VALID/MODIFIED ways and of its RESERVED ways
+    new_addr_type *m_tags;
+    unsigned m_mask_words;
+    std::vector<unsigned long long> m_valid_mask;
+    std::vector<unsigned long long> m_reserved_mask;
 
     unsigned m_access;
     unsigned m_miss;
@@ -390,14 +577,7 @@ protected:
 
 class mshr_table {
 public:
-    mshr_table( unsigned num_entries, unsigned max_merged )
-    : m_num_entries(num_entries),
-    m_max_merged(max_merged)
-#if (tr1_hash_map_ismap == 0)
-    ,m_data(2*num_entries)
-#endif
-    {
-    }
+    mshr_table( unsigned num_entries, unsigned max_merged );
 
     /// Checks if there is a pending request to the lower memory level already
     bool probe( new_addr_type block_addr ) const;
@@ -405,14 +585,22 @@ public:
     bool full( new_addr_type block_addr ) const;
     /// Add or merge this access
     void add( new_addr_type block_addr, mem_fetch *mf );
+    /// Allocate a new entry for a prefetch of block_addr
+    void add_prefetch( new_addr_type block_addr, mem_fetch *mf );
+    /// Is the pending request a prefetch no demand access has merged into yet? If so, it is now.
+    bool claim_prefetch( new_addr_type block_addr );
     /// Returns true if cannot accept new fill responses
     bool busy() const {return false;}
-    /// Accept a new cache fill response: mark entry ready for processing
-    void mark_ready( new_addr_type block_addr, bool &has_atomic );
+    /// Accept a new cache fill response: mark entry ready for processing.
+    /// The prefetch of a prefetch entry is dropped; an entry left empty is 
+    /// released at once and the prefetch reported unused
+    void mark_ready( new_addr_type block_addr, bool &has_atomic, bool &unused_prefetch );
     /// Returns true if ready accesses exist
-    bool access_ready() const {return !m_current_response.empty();}
+    bool access_ready() const {return m_ready_count != 0;}
     /// Returns next ready access
     mem_fetch *next_access();
+    /// Number of allocated entries
+    unsigned occupancy() const {return m_used;}
     void display( FILE *fp ) const;
 
     void check_mshr_parameters( unsigned num_entries, unsigned max_merged )
@@ -422,22 +610,40 @@ public:
     }
 
 private:
+    static const unsigned NO_ENTRY = (unsigned)-1;
 
     // finite sized, fully associative table, with a finite maximum number of merged requests
     const unsigned m_num_entries;
     const unsigned m_max_merged;
 
+    // entry i keeps its merged requests in a ring at m_merged[i*m_max_merged]
     struct mshr_entry {
-        std::list<mem_fetch*> m_list;
+        new_addr_type m_block_addr;
+        unsigned m_head;
+        unsigned m_count; // 0 => entry is free
         bool m_has_atomic; 
-        mshr_entry() : m_has_atomic(false) { }
+        bool m_prefetch; // the first request is a prefetch owned by the cache
+        bool m_prefetch_claimed;
     }; 
-    typedef tr1_hash_map<new_addr_type,mshr_entry> table;
-    table m_data;
-
-    // it may take several cycles to process the merged requests
-    bool m_current_response_ready;
-    std::list<new_addr_type> m_current_response;
+    std::vector<mshr_entry> m_entries;
+    std::vector<mem_fetch*> m_merged;
+    std::vector<unsigned> m_free_entries;
+    unsigned m_used;
+
+    // open addressed (linear probing) index from block address to entry
+    std::vector<unsigned> m_index;
+    unsigned index_hash( new_addr_type block_addr ) const 
+    {
+        return (unsigned)((block_addr * 0x9E3779B97F4A7C15ULL) >> 32) & (m_index.size()-1);
+    }
+    unsigned find_slot( new_addr_type block_addr ) const;
+    void erase_slot( unsigned slot );
+
+    // ring of entries whose fill has arrived; it may take several cycles to
+    // process the merged requests
+    std::vector<unsigned> m_ready;
+    unsigned m_ready_head;
+    unsigned m_ready_count;
 };
 
 
@@ -448,6 +654,7 @@ private:
 struct cache_sub_stats{
     unsigned accesses;
     unsigned misses;
+    unsigned sector_misses; // misses on a sectored line that was present
     unsigned pending_hits;
     unsigned res_fails;
 
@@ -455,17 +662,22 @@ struct cache_sub_stats{
     unsigned long long data_port_busy_cycles; 
     unsigned long long fill_port_busy_cycles; 
 
+    unsigned long long prefetch[NUM_PREFETCH_STAT];
+
     cache_sub_stats(){
         clear();
     }
     void clear(){
         accesses = 0;
         misses = 0;
+        sector_misses = 0;
         pending_hits = 0;
         res_fails = 0;
         port_available_cycles = 0; 
         data_port_busy_cycles = 0; 
         fill_port_busy_cycles = 0; 
+        for (unsigned i = 0; i < NUM_PREFETCH_STAT; ++i) 
+            prefetch[i] = 0;
     }
     cache_sub_stats &operator+=(const cache_sub_stats &css){
         ///
@@ -473,11 +685,14 @@ struct cache_sub_stats{
         ///
         accesses += css.accesses;
         misses += css.misses;
+        sector_misses += css.sector_misses;
         pending_hits += css.pending_hits;
         res_fails += css.res_fails;
         port_available_cycles += css.port_available_cycles; 
         data_port_busy_cycles += css.data_port_busy_cycles; 
         fill_port_busy_cycles += css.fill_port_busy_cycles; 
+        for (unsigned i = 0; i < NUM_PREFETCH_STAT; ++i) 
+            prefetch[i] += css.prefetch[i];
         return *this;
     }
 
@@ -488,15 +703,21 @@ struct cache_sub_stats{
         cache_sub_stats ret;
         ret.accesses = accesses + cs.accesses;
         ret.misses = misses + cs.misses;
+        ret.sector_misses = sector_misses + cs.sector_misses;
         ret.pending_hits = pending_hits + cs.pending_hits;
         ret.res_fails = res_fails + cs.res_fails;
         ret.port_available_cycles = port_available_cycles + cs.port_available_cycles; 
         ret.data_port_busy_cycles = data_port_busy_cycles + cs.data_port_busy_cycles; 
         ret.fill_port_busy_cycles = fill_port_busy_cycles + cs.fill_port_busy_cycles; 
+        for (unsigned i = 0; i < NUM_PREFETCH_STAT; ++i) 
+            ret.prefetch[i] = prefetch[i] + cs.prefetch[i];
         return ret;
     }
 
     void print_port_stats(FILE *fout, const char *cache_name) const; 
+    void print_prefetch_stats(FILE *fout, const char *cache_name) const; 
+    // -gpgpu_stat_dump: registers the fields as <prefix>_accesses, ...
+    void reg_stats(class stat_registry &reg, const std::string &prefix) const;
 };
 
 ///
@@ -521,6 +742,11 @@ public:
     void get_sub_stats(struct cache_sub_stats &css) const;
 
     void sample_cache_port_utility(bool data_port_busy, bool fill_port_busy); 
+    void sample_mshr_occupancy(unsigned n);
+    void inc_prefetch_stats(enum prefetch_stat stat) { m_prefetch[stat]++; }
+
+    void save( FILE *fp ) const;
+    void load( FILE *fp );
 private:
     bool check_valid(int type, int status) const;
 
@@ -529,6 +755,11 @@ private:
     unsigned long long m_cache_port_available_cycles; 
     unsigned long long m_cache_data_port_busy_cycles; 
     unsigned long long m_cache_fill_port_busy_cycles; 
+
+    // cycles with n MSHR entries allocated, indexed by n
+    std::vector<unsigned long long> m_mshr_occupancy;
+
+    unsigned long long m_prefetch[NUM_PREFETCH_STAT];
 };
 
 class cache_t {
@@ -553,6 +784,7 @@ public:
                      enum mem_fetch_status status )
     : m_config(config), m_tag_array(new tag_array(config,core_id,type_id)), 
       m_mshrs(config.m_mshr_entries,config.m_mshr_max_merge), 
+      m_prefetch_inflight(0),
       m_bandwidth_management(config) 
     {
         init( name, config, memport, status );
@@ -594,6 +826,12 @@ public:
     mem_fetch *next_access(){return m_mshrs.next_access();}
     // flash invalidate all entries in cache
     void flush(){m_tag_array->flush();}
+    // checkpoint the tag array and statistics (not in-flight misses)
+    void save( FILE *fp ) const;
+    void load( FILE *fp );
+    // install lines recorded during functional fast-forward
+    void warm( new_addr_type addr, unsigned time, bool write );
+    void warm_done() { m_tag_array->warm_done(); }
     void print(FILE *fp, unsigned &accesses, unsigned &misses) const;
     void display_state( FILE *fp ) const;
 
@@ -612,6 +850,15 @@ public:
     bool data_port_free() const { return m_bandwidth_management.data_port_free(); } 
     bool fill_port_free() const { return m_bandwidth_management.fill_port_free(); } 
 
+    /// Would cycle() do nothing but sample idle ports? (see shader_core_ctx::idle())
+    bool idle() const { return m_miss_queue.empty() && !access_ready() && data_port_free() && fill_port_free(); }
+    /// Stat side effect of cycle() on an idle cache
+    void idle_cycle() 
+    { 
+        m_stats.sample_cache_port_utility(false,false); 
+        m_stats.sample_mshr_occupancy(m_mshrs.occupancy());
+    }
+
 protected:
     // Constructor that can be used by derived classes with custom tag arrays
     baseline_cache( const char *name,
@@ -624,6 +871,7 @@ protected:
     : m_config(config),
       m_tag_array( new_tag_array ),
       m_mshrs(config.m_mshr_entries,config.m_mshr_max_merge), 
+      m_prefetch_inflight(0),
       m_bandwidth_management(config) 
     {
         init( name, config, memport, status );
@@ -640,17 +888,19 @@ protected:
 
     struct extra_mf_fields {
         extra_mf_fields()  { m_valid = false;}
-        extra_mf_fields( new_addr_type a, unsigned i, unsigned d ) 
+        extra_mf_fields( new_addr_type a, unsigned i, unsigned d, bool p = false ) 
         {
             m_valid = true;
             m_block_addr = a;
             m_cache_index = i;
             m_data_size = d;
+            m_prefetch = p;
         }
         bool m_valid;
         new_addr_type m_block_addr;
         unsigned m_cache_index;
         unsigned m_data_size;
+        bool m_prefetch; // issued by this cache's prefetcher, deleted on fill
     };
 
     typedef std::map<mem_fetch*,extra_mf_fields> extra_mf_fields_lookup;
@@ -659,6 +909,28 @@ protected:
 
     cache_stats m_stats;
 
+    unsigned m_prefetch_inflight;
+
+    /// Miss queue slots to keep for the writebacks of a miss that evicts 
+    /// line idx: one per run of dirty sectors, and at least one
+    unsigned writeback_slots( unsigned idx, enum cache_request_status status ) const
+    {
+        if ( status != MISS || m_config.m_alloc_policy != ON_MISS 
+             || m_config.m_write_policy == WRITE_THROUGH ) 
+            return 1;
+        const cache_block_t &line = m_tag_array->get_block(idx);
+        if ( line.m_status != MODIFIED ) 
+            return 1;
+        return std::max(1U, m_config.writeback_runs(line));
+    }
+
+    /// Does line idx hold a prefetched block no demand access has used?
+    bool holds_unused_prefetch( unsigned idx ) const
+    {
+        const cache_block_t &line = m_tag_array->get_block(idx);
+        return line.m_prefetched && (line.m_status == VALID || line.m_status == MODIFIED);
+    }
+
     /// Checks whether this request can be handled on this cycle. num_miss equals max # of misses to be handled on this cycle
     bool miss_queue_full(unsigned num_miss){
     	  return ( (m_miss_queue.size()+num_miss) >= m_config.m_miss_queue_size );
@@ -729,11 +1001,15 @@ public:
         m_wrbk_type = wrbk_type;
     }
 
-    virtual ~data_cache() {}
+    virtual ~data_cache() 
+    {
+        delete m_prefetcher;
+    }
 
     virtual void init( mem_fetch_allocator *mfcreator )
     {
         m_memfetch_creator=mfcreator;
+        m_prefetcher = create_prefetcher(m_config);
 
         // Set read hit function
         m_rd_hit = &data_cache::rd_hit_base;
@@ -808,8 +1084,27 @@ protected:
 protected:
     mem_fetch_allocator *m_memfetch_creator;
 
+    cache_prefetcher *m_prefetcher; // NULL if prefetching is off
+    std::vector<new_addr_type> m_prefetch_candidates;
+
+    /// Prefetch accounting and training after the demand access mf
+    void prefetch_access( bool wr,
+                          enum cache_request_status probe_status,
+                          enum cache_request_status access_status,
+                          new_addr_type block_addr,
+                          unsigned cache_index,
+                          bool victim_prefetched,
+                          mem_fetch *mf,
+                          unsigned time );
+    /// Sends a prefetch of block_addr if it is not already cached or pending
+    /// and the prefetch throttle, MSHRs and miss queue leave room for it
+    void issue_prefetch( new_addr_type block_addr, const mem_fetch *demand, unsigned time );
+    /// May this cache prefetch pf on behalf of the demand access?
+    virtual bool prefetch_allowed( const mem_fetch *pf, const mem_fetch *demand ) const { return true; }
+
     // Functions for data cache access
     /// Sends write request to lower level memory (write or writeback)
+    void send_writeback( const cache_block_t &evicted, unsigned time, std::list<cache_event> *events );
     void send_write_request( mem_fetch *mf,
                              cache_event request,
                              unsigned time,
@@ -969,6 +1264,13 @@ public:
                 mem_fetch *mf,
                 unsigned time,
                 std::list<cache_event> &events );
+
+protected:
+    /// An L2 slice only holds the lines of its own memory sub partition
+    virtual bool prefetch_allowed( const mem_fetch *pf, const mem_fetch *demand ) const
+    {
+        return pf->get_sub_partition_id() == demand->get_sub_partition_id();
+    }
 };
 
 /*****************************************************************************/
@@ -1014,11 +1316,17 @@ public:
     /// Pop next ready access (includes both accesses that "HIT" and those that "MISS")
     mem_fetch *next_access(){return m_result_fifo.pop();}
     void display_state( FILE *fp ) const;
+    // checkpoint the tags, the block addresses they map to and statistics
+    void save( FILE *fp ) const;
+    void load( FILE *fp );
 
     // accessors for cache bandwidth availability - stubs for now 
     bool data_port_free() const { return true; }
     bool fill_port_free() const { return true; }
 
+    /// Would cycle() do nothing? (the texture cache keeps no port statistics)
+    bool idle() const { return m_request_fifo.empty() && m_fragment_fifo.empty() && m_result_fifo.empty(); }
+
     // Stat collection
     const cache_stats &get_stats() const {
         return m_stats;
@@ -49,6 +49,9 @@
 #include "addrdec.h"
 #include "stat-tool.h"
 #include "l2cache.h"
+#include "thread_pool.h"
+#include "warp_trace.h"
+#include "sim_profiler.h"
 
 #include "../cuda-sim/ptx-stats.h"
 #include "../statwrapper.h"
@@ -127,6 +130,10 @@ void power_config::reg_options(class OptionParser * opp)
 	                          &g_power_trace_zlevel, "Compression level of the power trace output log (0=no comp, 9=highest)",
 	                          "6");
 
+	   option_parser_register(opp, "-icnt_power_trace_enabled", OPT_BOOL,
+	                          &g_icnt_power_trace_enabled, "produce a file for the DSENT interconnect power trace, sampled every gpu_stat_sample_freq cycles (1=On, 0=Off)",
+	                          "0");
+
 	   option_parser_register(opp, "-steady_power_levels_enabled", OPT_BOOL,
 	                          &g_steady_power_levels_enabled, "produce a file for the steady power levels (1=On, 0=Off)",
 	                          "0");
@@ -150,8 +157,12 @@ void memory_config::reg_options(class OptionParser * opp)
                            "0");
     option_parser_register(opp, "-gpgpu_cache:dl2", OPT_CSTR, &m_L2_config.m_config_string, 
                    "unified banked L2 data cache config "
-                   " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq>}",
+                   " {<nsets>:<bsize>:<assoc>[:<sector>],<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq>}",
                    "64:128:8,L:B:m:N,A:16:4,4");
+    option_parser_register(opp, "-gpgpu_l2_prefetcher", OPT_CSTR, &m_L2_config.m_prefetch_string, 
+                   "L2 cache prefetcher {<type>:<degree>:<max in flight> | none}, "
+                   "type N = next-line, S = stride per PC, W = inter-warp stride",
+                   "none");
     option_parser_register(opp, "-gpgpu_cache:dl2_texture_only", OPT_BOOL, &m_L2_texure_only, 
                            "L2 cache used for texture only",
                            "1");
@@ -170,6 +181,18 @@ void memory_config::reg_options(class OptionParser * opp)
     option_parser_register(opp, "-gpgpu_frfcfs_dram_sched_queue_size", OPT_INT32, &gpgpu_frfcfs_dram_sched_queue_size, 
                 "0 = unlimited (default); # entries per chip",
                 "0");
+    option_parser_register(opp, "-gpgpu_frfcfs_policy", OPT_INT32, &frfcfs_policy, 
+                "FR-FCFS request selection: 0 = FR-FCFS (default), 1 = FR-FCFS-Cap, 2 = BLISS",
+                "0");
+    option_parser_register(opp, "-gpgpu_frfcfs_row_hit_cap", OPT_UINT32, &frfcfs_row_hit_cap, 
+                "FR-FCFS-Cap: row hits served before an older request to another row wins",
+                "16");
+    option_parser_register(opp, "-gpgpu_bliss_threshold", OPT_UINT32, &bliss_threshold, 
+                "BLISS: consecutive requests served from one core before it is blacklisted",
+                "4");
+    option_parser_register(opp, "-gpgpu_bliss_clear_interval", OPT_UINT32, &bliss_clear_interval, 
+                "BLISS: cycles between blacklist resets",
+                "10000");
     option_parser_register(opp, "-gpgpu_dram_return_queue_size", OPT_INT32, &gpgpu_dram_return_queue_size, 
                 "0 = unlimited (default); # entries per chip",
                 "0");
@@ -216,15 +239,19 @@ void shader_core_config::reg_options(class OptionParser * opp)
                    "4:256:4,L:R:f:N,A:2:32,4" );
     option_parser_register(opp, "-gpgpu_cache:dl1", OPT_CSTR, &m_L1D_config.m_config_string,
                    "per-shader L1 data cache config "
-                   " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq> | none}",
+                   " {<nsets>:<bsize>:<assoc>[:<sector>],<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq> | none}",
                    "none" );
     option_parser_register(opp, "-gpgpu_cache:dl1PrefL1", OPT_CSTR, &m_L1D_config.m_config_stringPrefL1,
                    "per-shader L1 data cache config "
-                   " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq> | none}",
+                   " {<nsets>:<bsize>:<assoc>[:<sector>],<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq> | none}",
                    "none" );
     option_parser_register(opp, "-gpgpu_cache:dl1PreShared", OPT_CSTR, &m_L1D_config.m_config_stringPrefShared,
                    "per-shader L1 data cache config "
-                   " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq> | none}",
+                   " {<nsets>:<bsize>:<assoc>[:<sector>],<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq> | none}",
+                   "none" );
+    option_parser_register(opp, "-gpgpu_l1d_prefetcher", OPT_CSTR, &m_L1D_config.m_prefetch_string,
+                   "per-shader L1 data cache prefetcher {<type>:<degree>:<max in flight> | none}, "
+                   "type N = next-line, S = stride per PC, W = inter-warp stride",
                    "none" );
     option_parser_register(opp, "-gmem_skip_L1D", OPT_BOOL, &gmem_skip_L1D, 
                    "global memory access skip L1D cache (implements -Xptxas -dlcm=cg, default=no skip)",
@@ -347,6 +374,10 @@ void shader_core_config::reg_options(class OptionParser * opp)
     option_parser_register(opp, "-gpgpu_simt_core_sim_order", OPT_INT32, &simt_core_sim_order,
                             "Select the simulation order of cores in a cluster (0=Fix, 1=Round-Robin)",
                             "1");
+    option_parser_register(opp, "-gpgpu_core_idle_skip", OPT_BOOL, &gpgpu_core_idle_skip,
+                            "Replay only the statistics of shader cores that are stalled on memory "
+                            "instead of stepping their pipeline (results are unchanged)",
+                            "0");
     option_parser_register(opp, "-gpgpu_pipeline_widths", OPT_CSTR, &pipeline_widths_string,
                             "Pipeline widths "
                             "ID_OC_SP,ID_OC_SFU,ID_OC_MEM,OC_EX_SP,OC_EX_SFU,OC_EX_MEM,EX_WB",
@@ -411,6 +442,33 @@ void gpgpu_sim_config::reg_options(option_parser_t opp)
                   "500.0:2000.0:2000.0:2000.0");
    option_parser_register(opp, "-gpgpu_max_concurrent_kernel", OPT_INT32, &max_concurrent_kernel,
                           "maximum kernels that can run concurrently on GPU", "8" );
+   option_parser_register(opp, "-gpgpu_n_sim_threads", OPT_UINT32, &gpgpu_n_sim_threads,
+                          "number of host threads used to tick the DRAM and L2 of memory partitions in parallel; SIMT core clusters are always ticked serially (1 = serial)",
+                          "1");
+   option_parser_register(opp, "-checkpoint_kernel", OPT_UINT32, &checkpoint_kernel,
+                          "save a checkpoint of memory, caches and statistics right before this kernel launch (launch uid, 0 = off)", "0" );
+   option_parser_register(opp, "-resume_kernel", OPT_UINT32, &resume_kernel,
+                          "skip the kernel launches before this one and restore the checkpoint when it is launched (launch uid, 0 = off)", "0" );
+   option_parser_register(opp, "-checkpoint_file", OPT_CSTR, &checkpoint_file,
+                          "file written by -checkpoint_kernel and read by -resume_kernel", "gpgpusim.ckpt" );
+   option_parser_register(opp, "-warp_trace_capture", OPT_CSTR, &warp_trace_capture,
+                          "record the dynamic instruction stream of every warp to this file", NULL );
+   option_parser_register(opp, "-warp_trace_replay", OPT_CSTR, &warp_trace_replay,
+                          "drive the performance model from this warp trace instead of executing the PTX", NULL );
+   option_parser_register(opp, "-gpgpu_stat_dump", OPT_CSTR, &stat_dump_file,
+                          "write the registered statistics to this file at the end of each kernel", NULL );
+   option_parser_register(opp, "-gpgpu_stat_dump_format", OPT_CSTR, &stat_dump_format,
+                          "format of -gpgpu_stat_dump (binary or json)", "binary" );
+   option_parser_register(opp, "-gpgpu_stat_dump_interval", OPT_UINT32, &stat_dump_interval,
+                          "also write a -gpgpu_stat_dump record every this many cycles (0 = per kernel only)", "0" );
+   option_parser_register(opp, "-gpgpu_self_profile", OPT_BOOL, &self_profile,
+                          "report the host time spent in each simulator subsystem at exit", "0" );
+   option_parser_register(opp, "-gpgpu_fast_forward_kernels", OPT_UINT32, &fast_forward_kernels,
+                          "run this many kernel launches in the functional model before switching to the performance model (0 = no limit)", "0" );
+   option_parser_register(opp, "-gpgpu_fast_forward_insn", OPT_UINT32, &fast_forward_insn,
+                          "run kernel launches in the functional model until this many instructions have executed, checked at launch (0 = no limit)", "0" );
+   option_parser_register(opp, "-gpgpu_fast_forward_warmup", OPT_UINT32, &fast_forward_warmup,
+                          "number of the last fast-forwarded memory accesses replayed into the L1 and L2 tag arrays (0 = start cold)", "0" );
    option_parser_register(opp, "-gpgpu_cflog_interval", OPT_INT32, &gpgpu_cflog_interval, 
                "Interval between each snapshot in control flow logger", 
                "0");
@@ -476,6 +534,8 @@ void gpgpu_sim::launch( kernel_info_t *kinfo )
        }
    }
    assert(n < m_running_kernels.size());
+   if( m_warp_trace ) 
+      m_warp_trace->kernel_launch(*kinfo);
 }
 
 bool gpgpu_sim::can_start_kernel()
@@ -540,6 +600,13 @@ void gpgpu_sim::set_kernel_done( kernel_info_t *kernel )
         }
     }
     assert( k != m_running_kernels.end() ); 
+    if( m_warp_trace ) {
+        bool idle = true;
+        for( k=m_running_kernels.begin(); k!=m_running_kernels.end(); k++ ) 
+            if( *k != NULL ) idle = false;
+        if( idle ) 
+            m_warp_trace->kernels_idle();
+    }
 }
 
 void set_ptx_warp_size(const struct core_config * warp_size);
@@ -552,9 +619,13 @@ gpgpu_sim::gpgpu_sim( const gpgpu_sim_config &config )
     set_ptx_warp_size(m_shader_config);
     ptx_file_line_stats_create_exposed_latency_tracker(m_config.num_shader());
 
+    m_mf_pool = new mem_fetch_pool();
+    mem_fetch::set_pool(m_mf_pool);
+
 #ifdef GPGPUSIM_POWER_MODEL
         m_gpgpusim_wrapper = new gpgpu_sim_wrapper(config.g_power_simulation_enabled,config.g_power_config_name);
 #endif
+    m_icnt_power_trace_fp = NULL;
 
     m_shader_stats = new shader_core_stats(m_shader_config);
     m_memory_stats = new memory_stats_t(m_config.num_shader(),m_shader_config,m_memory_config);
@@ -568,6 +639,20 @@ gpgpu_sim::gpgpu_sim( const gpgpu_sim_config &config )
     gpu_deadlock = false;
 
 
+    m_warp_trace = NULL;
+    if( m_config.warp_trace_capture && m_config.warp_trace_replay ) {
+        printf("GPGPU-Sim uArch: ERROR ** -warp_trace_capture and -warp_trace_replay cannot be used together\n");
+        exit(1);
+    }
+    if( m_config.warp_trace_replay && (m_config.fast_forward_kernels || m_config.fast_forward_insn) ) {
+        printf("GPGPU-Sim uArch: ERROR ** -warp_trace_replay does not update device memory, it cannot be used with functional fast-forward\n");
+        exit(1);
+    }
+    if( m_config.warp_trace_capture ) 
+        m_warp_trace = new warp_trace_file(m_config.warp_trace_capture,false,m_shader_config->warp_size);
+    else if( m_config.warp_trace_replay ) 
+        m_warp_trace = new warp_trace_file(m_config.warp_trace_replay,true,m_shader_config->warp_size);
+
     m_cluster = new simt_core_cluster*[m_shader_config->n_simt_clusters];
     for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) 
         m_cluster[i] = new simt_core_cluster(this,i,m_shader_config,m_memory_config,m_shader_stats,m_memory_stats);
@@ -582,14 +667,41 @@ gpgpu_sim::gpgpu_sim( const gpgpu_sim_config &config )
         }
     }
 
+    if (m_config.self_profile) 
+        sim_prof_enable();
+
+    m_thread_pool = NULL;
+    m_mf_uid_pending = NULL;
+    if (m_config.gpgpu_n_sim_threads > 1) {
+        m_thread_pool = new sim_thread_pool(m_config.gpgpu_n_sim_threads);
+        m_mf_uid_pending = new std::vector<mem_fetch*>[ std::max(m_memory_config->m_n_mem, m_memory_config->m_n_mem_sub_partition) ];
+        printf("GPGPU-Sim uArch: ticking memory partitions with %u host threads\n", m_config.gpgpu_n_sim_threads);
+    }
+
     icnt_wrapper_init();
     icnt_create(m_shader_config->n_simt_clusters,m_memory_config->m_n_mem_sub_partition);
     fprintf(stdout, "\nInterconnect Created.\n\n");
 
+    m_icnt_power_trace = m_config.g_icnt_power_trace_enabled;
+    if (m_icnt_power_trace && !icnt_has_power_model()) {
+        printf("GPGPU-Sim uArch: WARNING ** -icnt_power_trace_enabled needs the intersim2 network with sim_power = 1 "
+               "in the interconnect config, no interconnect power trace will be written\n");
+        m_icnt_power_trace = false;
+    }
+
     time_vector_create(NUM_MEM_REQ_STAT);
+
+    m_stat_registry = NULL;
+    m_stat_dump_kernel_first = 0;
+    if (m_config.stat_dump_file) 
+        stat_dump_init();
+
     fprintf(stdout, "GPGPU-Sim uArch: performance model initialization complete.\n");
     fflush(stdout); 
     m_running_kernels.resize( config.max_concurrent_kernel, NULL );
+    m_fast_forward_done = !m_config.fast_forward_kernels && !m_config.fast_forward_insn;
+    m_fast_forward_kernels = 0;
+    m_fast_forward_next = 0;
     m_last_issued_kernel = 0;
     m_last_cluster_issue = 0;
     *average_pipeline_duty_cycle=0;
@@ -729,12 +841,105 @@ void gpgpu_sim::print_stats()
     ptx_file_line_stats_write_file();
     //gpu_print_stat();
 
+    // once the cores and the memory system have drained, no request should 
+    // be in flight: any mem_fetch still allocated has been leaked
+    m_mf_pool->print_stats(stdout);
+    bool drained = !icnt_busy();
+    for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) 
+       if( m_cluster[i]->get_not_completed()>0 ) 
+          drained = false;
+    for (unsigned i=0;i<m_memory_config->m_n_mem;i++) 
+       if( m_memory_partition_unit[i]->busy() ) 
+          drained = false;
+    if( drained && m_mf_pool->live() ) 
+       printf("GPGPU-Sim uArch: WARNING ** %llu mem_fetch objects leaked at end of kernel\n", m_mf_pool->live() );
+
     if (g_network_mode) {
         printf("----------------------------Interconnect-DETAILS--------------------------------\n" );
         icnt_display_stats();
         icnt_display_overall_stats();
         printf("----------------------------END-of-Interconnect-DETAILS-------------------------\n" );
     }
+
+    if (m_stat_registry) 
+        stat_dump_record(STAT_RECORD_KERNEL);
+}
+
+// -gpgpu_stat_dump: every unit registers its counters once; totals over 
+// units are kept in gpgpu_sim and refreshed by stat_dump_record()
+void gpgpu_sim::stat_dump_init()
+{
+    enum stat_dump_format format = STAT_DUMP_BINARY;
+    if (!strcmp(m_config.stat_dump_format, "json")) {
+        format = STAT_DUMP_JSON;
+    } else if (strcmp(m_config.stat_dump_format, "binary")) {
+        printf("GPGPU-Sim uArch: ERROR ** -gpgpu_stat_dump_format must be binary or json (got %s)\n", m_config.stat_dump_format);
+        exit(1);
+    }
+    m_stat_registry = new stat_registry(m_config.stat_dump_file, format);
+    stat_registry &reg = *m_stat_registry;
+
+    reg.reg("gpu_sim_cycle", &gpu_sim_cycle);
+    reg.reg("gpu_sim_insn", &gpu_sim_insn);
+    reg.reg("gpu_tot_sim_cycle", &gpu_tot_sim_cycle);
+    reg.reg("gpu_tot_sim_insn", &gpu_tot_sim_insn);
+    reg.reg("gpu_tot_issued_cta", &gpu_tot_issued_cta);
+    reg.reg("gpu_stall_dramfull", &gpu_stall_dramfull);
+    reg.reg("gpu_stall_icnt2sh", &gpu_stall_icnt2sh);
+    m_shader_stats->reg_stats(reg);
+    m_memory_stats->reg_stats(reg);
+    for (unsigned i=0;i<m_memory_config->m_n_mem;i++) 
+        m_memory_partition_unit[i]->reg_stats(reg);
+
+    m_stat_l1i.reg_stats(reg, "L1I_total_cache");
+    m_stat_l1d.reg_stats(reg, "L1D_total_cache");
+    m_stat_l1c.reg_stats(reg, "L1C_total_cache");
+    m_stat_l1t.reg_stats(reg, "L1T_total_cache");
+    m_stat_l2_bank.resize(m_memory_config->m_n_mem_sub_partition);
+    for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++) 
+        m_stat_l2_bank[i].reg_stats(reg, stat_registry::indexed("L2_cache_bank",i));
+    m_stat_l2.reg_stats(reg, "L2_total_cache");
+
+    printf("GPGPU-Sim uArch: writing %u statistics to %s (%s)\n", 
+           reg.num_stats(), m_config.stat_dump_file, m_config.stat_dump_format);
+}
+
+void gpgpu_sim::stat_dump_record( enum stat_record_kind kind )
+{
+    struct cache_sub_stats css;
+    m_stat_l1i.clear();
+    m_stat_l1d.clear();
+    m_stat_l1c.clear();
+    m_stat_l1t.clear();
+    for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) {
+        m_cluster[i]->get_L1I_sub_stats(css);
+        m_stat_l1i += css;
+        m_cluster[i]->get_L1D_sub_stats(css);
+        m_stat_l1d += css;
+        m_cluster[i]->get_L1C_sub_stats(css);
+        m_stat_l1c += css;
+        m_cluster[i]->get_L1T_sub_stats(css);
+        m_stat_l1t += css;
+    }
+    m_stat_l2.clear();
+    for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++) {
+        m_stat_l2_bank[i].clear();
+        m_memory_sub_partition[i]->get_L2cache_sub_stats(m_stat_l2_bank[i]);
+        m_stat_l2 += m_stat_l2_bank[i];
+    }
+
+    // the record covers the kernels that ran since the last kernel record
+    if (m_stat_dump_kernel_first > m_executed_kernel_uids.size()) 
+        m_stat_dump_kernel_first = 0; // the list was cleared by gpu_print_stat()
+    std::stringstream label;
+    for (unsigned k = m_stat_dump_kernel_first; k < m_executed_kernel_uids.size(); k++) {
+        if (k > m_stat_dump_kernel_first) 
+            label << " ";
+        label << m_executed_kernel_uids[k] << ":" << m_executed_kernel_names[k];
+    }
+    m_stat_registry->write(kind, gpu_sim_cycle, label.str());
+    if (kind == STAT_RECORD_KERNEL) 
+        m_stat_dump_kernel_first = m_executed_kernel_uids.size();
 }
 
 void gpgpu_sim::deadlock_check()
@@ -957,11 +1162,14 @@ void gpgpu_sim::gpu_print_stat()
           printf("L2_total_cache_misses = %u\n", total_l2_css.misses);
           if(total_l2_css.accesses > 0)
               printf("L2_total_cache_miss_rate = %.4lf\n", (double)total_l2_css.misses/(double)total_l2_css.accesses);
+          if (m_memory_config->m_L2_config.is_sectored()) 
+              printf("L2_total_cache_sector_misses = %u\n", total_l2_css.sector_misses);
           printf("L2_total_cache_pending_hits = %u\n", total_l2_css.pending_hits);
           printf("L2_total_cache_reservation_fails = %u\n", total_l2_css.res_fails);
           printf("L2_total_cache_breakdown:\n");
           l2_stats.print_stats(stdout, "L2_cache_stats_breakdown");
           total_l2_css.print_port_stats(stdout, "L2_cache");
+          total_l2_css.print_prefetch_stats(stdout, "L2_cache");
        }
    }
 
@@ -1052,6 +1260,7 @@ void shader_core_ctx::mem_instruction_stats(const warp_inst_t &inst)
 
 void shader_core_ctx::issue_block2core( kernel_info_t &kernel ) 
 {
+    m_idle = false;
     set_max_cta(kernel);
 
     // find a free CTA context 
@@ -1081,15 +1290,23 @@ void shader_core_ctx::issue_block2core( kernel_info_t &kernel )
      
     // initalize scalar threads and determine which hardware warps they are allocated to
     // bind functional simulation state of threads to hardware resources (simulation) 
+    // (a trace replay has no functional state, the CTA is taken from the trace instead)
+    if( m_trace_file ) 
+        trace_init_cta(kernel,start_thread,end_thread);
     warp_set_t warps;
     unsigned nthreads_in_block= 0;
     for (unsigned i = start_thread; i<end_thread; i++) {
         m_threadState[i].m_cta_id = free_cta_hw_id;
         unsigned warp_id = i/m_config->warp_size;
-        nthreads_in_block += ptx_sim_init_thread(kernel,&m_thread[i],m_sid,i,cta_size-(i-start_thread),m_config->n_thread_per_shader,this,free_cta_hw_id,warp_id,m_cluster->get_gpu());
+        if( trace_replay() ) 
+            nthreads_in_block++;
+        else
+            nthreads_in_block += ptx_sim_init_thread(kernel,&m_thread[i],m_sid,i,cta_size-(i-start_thread),m_config->n_thread_per_shader,this,free_cta_hw_id,warp_id,m_cluster->get_gpu());
         m_threadState[i].m_active = true; 
         warps.set( warp_id );
     }
+    if( trace_replay() ) 
+        kernel.increment_cta_id();
     assert( nthreads_in_block > 0 && nthreads_in_block <= m_config->n_thread_per_shader); // should be at least one, but less than max
     m_cta_status[free_cta_hw_id]=nthreads_in_block;
 
@@ -1156,8 +1373,46 @@ void gpgpu_sim::issue_block2core()
 
 unsigned long long g_single_step=0; // set this in gdb to single step the pipeline
 
+// Memory partition work that gpgpu_sim::cycle() hands to m_thread_pool. Each
+// index only touches its own partition (or sub partition); state shared
+// between partitions is either updated afterwards on the calling thread or
+// through the thread-safe helpers in mem_latency_stat.h. mem_fetch uids are
+// deferred into a list per index and assigned in index order once the 
+// region has ended (see mem_fetch::defer_request_uids).
+class dram_cycle_task : public sim_parallel_task {
+public:
+   dram_cycle_task( memory_partition_unit **units, std::vector<mem_fetch*> *uid_pending ) 
+      : m_units(units), m_uid_pending(uid_pending) {}
+   virtual void run( unsigned i ) 
+   { 
+      mem_fetch::defer_request_uids(&m_uid_pending[i]);
+      m_units[i]->dram_cycle(); 
+      mem_fetch::defer_request_uids(NULL);
+   }
+private:
+   memory_partition_unit **m_units;
+   std::vector<mem_fetch*> *m_uid_pending;
+};
+
+class l2_cache_cycle_task : public sim_parallel_task {
+public:
+   l2_cache_cycle_task( memory_sub_partition **subs, unsigned cycle, std::vector<mem_fetch*> *uid_pending ) 
+      : m_subs(subs), m_cycle(cycle), m_uid_pending(uid_pending) {}
+   virtual void run( unsigned i ) 
+   { 
+      mem_fetch::defer_request_uids(&m_uid_pending[i]);
+      m_subs[i]->cache_cycle(m_cycle); 
+      mem_fetch::defer_request_uids(NULL);
+   }
+private:
+   memory_sub_partition **m_subs;
+   unsigned m_cycle;
+   std::vector<mem_fetch*> *m_uid_pending;
+};
+
 void gpgpu_sim::cycle()
 {
+   SIM_PROF_SCOPE(SIM_PROF_CYCLE_OTHER);
    int clock_mask = next_clock_domain();
    if (clock_mask & CORE ) {
        // shader core loading (pop from ICNT into core) follows CORE clock
@@ -1186,8 +1441,18 @@ void gpgpu_sim::cycle()
         }
     }
    if (clock_mask & DRAM) {
+      // Issue the dram command (scheduler + delay model)
+      SIM_PROF_SCOPE(SIM_PROF_DRAM);
+      if (m_thread_pool) {
+         dram_cycle_task task(m_memory_partition_unit, m_mf_uid_pending);
+         m_thread_pool->parallel_for(m_memory_config->m_n_mem, &task);
+         for (unsigned i=0;i<m_memory_config->m_n_mem;i++)
+            mem_fetch::assign_deferred_request_uids(m_mf_uid_pending[i]);
+      } else {
+         for (unsigned i=0;i<m_memory_config->m_n_mem;i++)
+            m_memory_partition_unit[i]->dram_cycle();
+      }
       for (unsigned i=0;i<m_memory_config->m_n_mem;i++){
-         m_memory_partition_unit[i]->dram_cycle(); // Issue the dram command (scheduler + delay model)
          // Update performance counters for DRAM
          m_memory_partition_unit[i]->set_dram_power_stats(m_power_stats->pwr_mem_stat->n_cmd[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_activity[CURRENT_STAT_IDX][i],
                         m_power_stats->pwr_mem_stat->n_nop[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_act[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_pre[CURRENT_STAT_IDX][i],
@@ -1207,11 +1472,27 @@ void gpgpu_sim::cycle()
               mem_fetch* mf = (mem_fetch*) icnt_pop( m_shader_config->mem2device(i) );
               m_memory_sub_partition[i]->push( mf, gpu_sim_cycle + gpu_tot_sim_cycle );
           }
-          m_memory_sub_partition[i]->cache_cycle(gpu_sim_cycle+gpu_tot_sim_cycle);
-          m_memory_sub_partition[i]->accumulate_L2cache_stats(m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX]);
        }
+       // A sub partition's L2 cycle only touches that sub partition, so 
+       // ticking all of them after the interconnect handoff above is 
+       // equivalent to interleaving the two per sub partition.
+       {
+          SIM_PROF_SCOPE(SIM_PROF_L2_CACHE);
+          if (m_thread_pool) {
+             l2_cache_cycle_task task(m_memory_sub_partition, gpu_sim_cycle+gpu_tot_sim_cycle, m_mf_uid_pending);
+             m_thread_pool->parallel_for(m_memory_config->m_n_mem_sub_partition, &task);
+             for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++)
+                mem_fetch::assign_deferred_request_uids(m_mf_uid_pending[i]);
+          } else {
+             for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++)
+                m_memory_sub_partition[i]->cache_cycle(gpu_sim_cycle+gpu_tot_sim_cycle);
+          }
+       }
+       for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++)
+          m_memory_sub_partition[i]->accumulate_L2cache_stats(m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX]);
    }
    if (clock_mask & ICNT) {
+      SIM_PROF_SCOPE(SIM_PROF_ICNT);
       icnt_transfer();
    }
 
@@ -1246,10 +1527,25 @@ void gpgpu_sim::cycle()
       // McPAT main cycle (interface with McPAT)
 #ifdef GPGPUSIM_POWER_MODEL
       if(m_config.g_power_simulation_enabled){
+          SIM_PROF_SCOPE(SIM_PROF_POWER);
           mcpat_cycle(m_config, getShaderCoreConfig(), m_gpgpusim_wrapper, m_power_stats, m_config.gpu_stat_sample_freq, gpu_tot_sim_cycle, gpu_sim_cycle, gpu_tot_sim_insn, gpu_sim_insn);
       }
 #endif
 
+      // DSENT interconnect power trace, sampled with the GPUWattch trace
+      if (m_icnt_power_trace && 
+          !((gpu_tot_sim_cycle+gpu_sim_cycle) % m_config.gpu_stat_sample_freq)) {
+          if (!m_icnt_power_trace_fp) {
+              m_icnt_power_trace_fp = fopen(m_config.g_icnt_power_trace_filename, "w");
+              if (!m_icnt_power_trace_fp) {
+                  printf("GPGPU-Sim uArch: ERROR ** cannot open interconnect power trace file %s\n", m_config.g_icnt_power_trace_filename);
+                  exit(1);
+              }
+          }
+          icnt_power_trace(m_icnt_power_trace_fp, gpu_tot_sim_cycle+gpu_sim_cycle);
+          fflush(m_icnt_power_trace_fp);
+      }
+
       issue_block2core();
       
       // Depending on configuration, flush the caches once all of threads are completed.
@@ -1286,6 +1582,9 @@ void gpgpu_sim::cycle()
          }
       }
 
+      if (m_stat_registry && m_config.stat_dump_interval && !(gpu_sim_cycle % m_config.stat_dump_interval)) 
+         stat_dump_record(STAT_RECORD_SAMPLE);
+
       if (!(gpu_sim_cycle % m_config.gpu_stat_sample_freq)) {
          time_t days, hrs, minutes, sec;
          time_t curr_time;
@@ -33,6 +33,7 @@
 #include "../trace.h"
 #include "addrdec.h"
 #include "shader.h"
+#include "stat_registry.h"
 #include <iostream>
 #include <fstream>
 #include <list>
@@ -71,6 +72,12 @@ enum dram_ctrl_t {
    DRAM_FRFCFS=1
 };
 
+enum dram_sched_policy_t {
+   DRAM_SCHED_FRFCFS=0,
+   DRAM_SCHED_FRFCFS_CAP=1,
+   DRAM_SCHED_BLISS=2
+};
+
 
 
 struct power_config {
@@ -103,6 +110,9 @@ struct power_config {
         char buf4[1024];
         snprintf(buf4,1024,"gpgpusim_steady_state_tracking_report__%s.log.gz",date);
         g_steady_state_tracking_filename = strdup(buf4);
+        char buf5[1024];
+        snprintf(buf5,1024,"gpgpusim_icnt_power_trace_report__%s.log",date);
+        g_icnt_power_trace_filename = strdup(buf5);
 
         if(g_steady_power_levels_enabled){
             sscanf(gpu_steady_state_definition,"%lf:%lf", &gpu_steady_power_deviation,&gpu_steady_min_period);
@@ -121,11 +131,13 @@ struct power_config {
 	bool m_valid;
     bool g_power_simulation_enabled;
     bool g_power_trace_enabled;
+    bool g_icnt_power_trace_enabled;
     bool g_steady_power_levels_enabled;
     bool g_power_per_cycle_dump;
     bool g_power_simulator_debug;
     char *g_power_filename;
     char *g_power_trace_filename;
+    char *g_icnt_power_trace_filename;
     char *g_metric_trace_filename;
     char * g_steady_state_tracking_filename;
     int g_power_trace_zlevel;
@@ -227,6 +239,10 @@ struct memory_config {
    unsigned gpgpu_frfcfs_dram_sched_queue_size;
    unsigned gpgpu_dram_return_queue_size;
    enum dram_ctrl_t scheduler_type;
+   enum dram_sched_policy_t frfcfs_policy;
+   unsigned frfcfs_row_hit_cap;
+   unsigned bliss_threshold;
+   unsigned bliss_clear_interval;
    bool gpgpu_memlatency_stat;
    unsigned m_n_mem;
    unsigned m_n_sub_partition_per_memory_channel;
@@ -344,6 +360,31 @@ private:
     int   gpgpu_cflog_interval;
     char * gpgpu_clock_domains;
     unsigned max_concurrent_kernel;
+    unsigned gpgpu_n_sim_threads; // host threads used to tick memory partitions
+
+    // kernel boundary checkpoints (kernel launch uids, 0 = off)
+    unsigned checkpoint_kernel;
+    unsigned resume_kernel;
+    char *checkpoint_file;
+
+    // trace driven simulation (file names, NULL = off)
+    char *warp_trace_capture;
+    char *warp_trace_replay;
+
+    // sampled simulation: kernels run functionally until either limit is 
+    // reached (0 = no limit), then the last accesses warm the caches
+    unsigned fast_forward_kernels;
+    unsigned fast_forward_insn;
+    unsigned fast_forward_warmup;
+
+    // machine readable statistics (file name, NULL = off; interval in 
+    // cycles, 0 = one record per kernel only)
+    char *stat_dump_file;
+    char *stat_dump_format;
+    unsigned stat_dump_interval;
+
+    // host time breakdown of the simulator's own hot paths (sim_profiler.h)
+    bool self_profile;
 
     // visualizer
     bool  g_visualizer_enabled;
@@ -370,6 +411,17 @@ public:
 
    void launch( kernel_info_t *kinfo );
    bool can_start_kernel();
+   // -checkpoint_kernel/-resume_kernel, called by the stream manager right 
+   // before a kernel launch is handed to the performance or functional model
+   bool resume_skips_kernel( const kernel_info_t &kernel ) const;
+   void checkpoint_kernel_launch( const kernel_info_t &kernel );
+   // -gpgpu_fast_forward_*: true while kernel launches should still go to the 
+   // functional model; the first launch that does not warms up the caches
+   bool fast_forward_kernel( const kernel_info_t &kernel );
+   // called by the functional model for every executed warp instruction
+   void fast_forward_record( unsigned cta, const warp_inst_t &inst );
+   // NULL unless a warp trace is captured or replayed
+   class warp_trace_file *get_warp_trace() const { return m_warp_trace; }
    unsigned finished_kernel();
    void set_kernel_done( kernel_info_t *kernel );
 
@@ -435,13 +487,46 @@ private:
 
    void gpgpu_debug();
 
+   void stat_dump_init();
+   void stat_dump_record( enum stat_record_kind kind );
+
+   void save_checkpoint( const kernel_info_t &kernel );
+   void load_checkpoint( const kernel_info_t &kernel );
+   void fast_forward_warm_caches();
+
 ///// data /////
 
    class simt_core_cluster **m_cluster;
    class memory_partition_unit **m_memory_partition_unit;
    class memory_sub_partition **m_memory_sub_partition;
 
+   // NULL when the memory system is ticked serially (-gpgpu_n_sim_threads 1)
+   class sim_thread_pool *m_thread_pool;
+   std::vector<class mem_fetch*> *m_mf_uid_pending; // per partition, while m_thread_pool ticks them
+   class mem_fetch_pool *m_mf_pool;
+
+   class warp_trace_file *m_warp_trace;
+
+   // -gpgpu_stat_dump (NULL = off) and the totals over units it reads, 
+   // refreshed right before each record
+   class stat_registry *m_stat_registry;
+   cache_sub_stats m_stat_l1i, m_stat_l1d, m_stat_l1c, m_stat_l1t, m_stat_l2;
+   std::vector<cache_sub_stats> m_stat_l2_bank;
+   unsigned m_stat_dump_kernel_first; // executed kernels before it are in an earlier kernel record
+
    std::vector<kernel_info_t*> m_running_kernels;
+
+   // functional fast-forward
+   struct fast_forward_access {
+      new_addr_type addr;
+      unsigned cta;   // linear CTA id within its grid
+      bool write;
+      bool constant;
+   };
+   bool m_fast_forward_done;
+   unsigned m_fast_forward_kernels; // launches run functionally so far
+   std::vector<fast_forward_access> m_fast_forward_trace; // ring of the last accesses
+   unsigned m_fast_forward_next;
    unsigned m_last_issued_kernel;
 
    std::list<unsigned> m_finished_kernel;
@@ -470,6 +555,8 @@ private:
    class memory_stats_t     *m_memory_stats;
    class power_stat_t *m_power_stats;
    class gpgpu_sim_wrapper *m_gpgpusim_wrapper;
+   bool m_icnt_power_trace; // -icnt_power_trace_enabled and the interconnect has a power model
+   FILE *m_icnt_power_trace_fp;
    unsigned long long  gpu_tot_issued_cta;
    unsigned long long  last_gpu_sim_insn;
 
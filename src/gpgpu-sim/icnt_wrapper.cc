@@ -29,6 +29,7 @@
 #include <assert.h>
 #include "../intersim2/globals.hpp"
 #include "../intersim2/interconnect_interface.hpp"
+#include "analytical_icnt.h"
 
 icnt_create_p                icnt_create;
 icnt_init_p                  icnt_init;
@@ -41,9 +42,15 @@ icnt_display_stats_p         icnt_display_stats;
 icnt_display_overall_stats_p icnt_display_overall_stats;
 icnt_display_state_p         icnt_display_state;
 icnt_get_flit_size_p         icnt_get_flit_size;
+icnt_power_trace_p           icnt_power_trace;
+icnt_has_power_model_p       icnt_has_power_model;
 
 int   g_network_mode;
 char* g_network_config_filename;
+bool  g_icnt_analytical_calibrate;
+int   g_icnt_analytical_latency_offset;
+
+static analytical_icnt *g_analytical_icnt = NULL;
 
 #include "../option_parser.h"
 
@@ -105,11 +112,126 @@ static unsigned intersim2_get_flit_size()
    return g_icnt_interface->GetFlitSize();
 }
 
+static void intersim2_power_trace(FILE *fp, unsigned long long cycle)
+{
+   g_icnt_interface->PowerTrace(fp, cycle);
+}
+
+static bool intersim2_has_power_model()
+{
+   return g_icnt_interface->HasPowerModel();
+}
+
+// intersim2 with the analytical model timing the same packets alongside
+
+static void intersim2_calibrated_create(unsigned int n_shader, unsigned int n_mem)
+{
+   g_icnt_interface->CreateInterconnect(n_shader, n_mem);
+   g_analytical_icnt->create(n_shader, n_mem);
+}
+
+static void intersim2_calibrated_push(unsigned input, unsigned output, void* data, unsigned int size)
+{
+   g_analytical_icnt->calibrate_push(input, output, data, size);
+   g_icnt_interface->Push(input, output, data, size);
+}
+
+static void* intersim2_calibrated_pop(unsigned output)
+{
+   void *data = g_icnt_interface->Pop(output);
+   if (data)
+      g_analytical_icnt->calibrate_pop(data);
+   return data;
+}
+
+static void intersim2_calibrated_transfer()
+{
+   g_icnt_interface->Advance();
+   g_analytical_icnt->transfer();
+}
+
+static void intersim2_calibrated_display_overall_stats()
+{
+   g_icnt_interface->DisplayOverallStats();
+   g_analytical_icnt->print_calibration(stdout);
+}
+
+// Wrapper to the analytical model
+
+static void analytical_create(unsigned int n_shader, unsigned int n_mem)
+{
+   g_analytical_icnt->create(n_shader, n_mem);
+}
+
+static void analytical_init()
+{
+   g_analytical_icnt->init();
+}
+
+static bool analytical_has_buffer(unsigned input, unsigned int size)
+{
+   return g_analytical_icnt->has_buffer(input, size);
+}
+
+static void analytical_push(unsigned input, unsigned output, void* data, unsigned int size)
+{
+   g_analytical_icnt->push(input, output, data, size);
+}
+
+static void* analytical_pop(unsigned output)
+{
+   return g_analytical_icnt->pop(output);
+}
+
+static void analytical_transfer()
+{
+   g_analytical_icnt->transfer();
+}
+
+static bool analytical_busy()
+{
+   return g_analytical_icnt->busy();
+}
+
+static void analytical_display_stats()
+{
+   g_analytical_icnt->display_stats();
+}
+
+static void analytical_display_overall_stats()
+{
+   g_analytical_icnt->display_overall_stats();
+}
+
+static void analytical_display_state(FILE *fp)
+{
+   g_analytical_icnt->display_state(fp);
+}
+
+static unsigned analytical_get_flit_size()
+{
+   return g_analytical_icnt->get_flit_size();
+}
+
+// the analytical model has no router activity to feed DSENT with
+static void analytical_power_trace(FILE *fp, unsigned long long cycle)
+{
+}
+
+static bool analytical_has_power_model()
+{
+   return false;
+}
+
 void icnt_reg_options( class OptionParser * opp )
 {
   // TODO look at this jgardea
-   option_parser_register(opp, "-network_mode", OPT_INT32, &g_network_mode, "Interconnection network mode", "1");
+   option_parser_register(opp, "-network_mode", OPT_INT32, &g_network_mode, "Interconnection network mode (1 = intersim2, 2 = analytical model)", "1");
    option_parser_register(opp, "-inter_config_file", OPT_CSTR, &g_network_config_filename, "Interconnection network config file", "mesh");
+   option_parser_register(opp, "-icnt_analytical_calibrate", OPT_BOOL, &g_icnt_analytical_calibrate, 
+                          "Time packets with the analytical interconnect model next to intersim2 and report its deviation", "0");
+   option_parser_register(opp, "-icnt_analytical_latency_offset", OPT_INT32, &g_icnt_analytical_latency_offset, 
+                          "Cycles added to every packet latency of the analytical interconnect model", "0");
 }
 
 void icnt_wrapper_init()
@@ -129,6 +251,32 @@ void icnt_wrapper_init()
          icnt_display_overall_stats = intersim2_display_overall_stats;
          icnt_display_state = intersim2_display_state;
          icnt_get_flit_size = intersim2_get_flit_size;
+         icnt_power_trace = intersim2_power_trace;
+         icnt_has_power_model = intersim2_has_power_model;
+         if (g_icnt_analytical_calibrate) {
+            g_analytical_icnt = new analytical_icnt(g_network_config_filename, g_icnt_analytical_latency_offset);
+            icnt_create     = intersim2_calibrated_create;
+            icnt_push       = intersim2_calibrated_push;
+            icnt_pop        = intersim2_calibrated_pop;
+            icnt_transfer   = intersim2_calibrated_transfer;
+            icnt_display_overall_stats = intersim2_calibrated_display_overall_stats;
+         }
+         break;
+      case ANALYTICAL:
+         g_analytical_icnt = new analytical_icnt(g_network_config_filename, g_icnt_analytical_latency_offset);
+         icnt_create     = analytical_create;
+         icnt_init       = analytical_init;
+         icnt_has_buffer = analytical_has_buffer;
+         icnt_push       = analytical_push;
+         icnt_pop        = analytical_pop;
+         icnt_transfer   = analytical_transfer;
+         icnt_busy       = analytical_busy;
+         icnt_display_stats = analytical_display_stats;
+         icnt_display_overall_stats = analytical_display_overall_stats;
+         icnt_display_state = analytical_display_state;
+         icnt_get_flit_size = analytical_get_flit_size;
+         icnt_power_trace = analytical_power_trace;
+         icnt_has_power_model = analytical_has_power_model;
          break;
       default:
          assert(0);
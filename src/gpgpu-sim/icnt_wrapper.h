@@ -44,6 +44,8 @@ typedef void (*icnt_display_stats_p)( );
 typedef void (*icnt_display_overall_stats_p)( );
 typedef void (*icnt_display_state_p)(FILE* fp);
 typedef unsigned (*icnt_get_flit_size_p)();
+typedef void (*icnt_power_trace_p)(FILE* fp, unsigned long long cycle);
+typedef bool (*icnt_has_power_model_p)();
 
 extern icnt_create_p     icnt_create;
 extern icnt_init_p       icnt_init;
@@ -57,10 +59,13 @@ extern icnt_display_stats_p icnt_display_stats;
 extern icnt_display_overall_stats_p icnt_display_overall_stats;
 extern icnt_display_state_p icnt_display_state;
 extern icnt_get_flit_size_p icnt_get_flit_size;
+extern icnt_power_trace_p icnt_power_trace;
+extern icnt_has_power_model_p icnt_has_power_model;
 extern int g_network_mode;
 
 enum network_mode {
    INTERSIM = 1,
+   ANALYTICAL = 2,
    N_NETWORK_MODE
 };
 
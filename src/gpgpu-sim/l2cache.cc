@@ -44,6 +44,7 @@
 #include "shader.h"
 #include "mem_latency_stat.h"
 #include "l2cache_trace.h"
+#include "stat_registry.h"
 
 
 mem_fetch * partition_mf_allocator::alloc(new_addr_type addr, mem_access_type type, unsigned size, bool wr ) const 
@@ -273,6 +274,11 @@ void memory_partition_unit::set_dram_power_stats(unsigned &n_cmd,
     m_dram->set_dram_power_stats(n_cmd, n_activity, n_nop, n_act, n_pre, n_rd, n_wr, n_req);
 }
 
+void memory_partition_unit::reg_stats( stat_registry &reg ) const
+{
+   m_dram->reg_stats(reg);
+}
+
 void memory_partition_unit::print( FILE *fp ) const
 {
     fprintf(fp, "Memory Partition %u: \n", m_id); 
@@ -535,6 +541,35 @@ unsigned memory_sub_partition::flushL2()
     return 0; // L2 is read only in this version
 }
 
+void memory_partition_unit::checkpoint_dram_stats( FILE *fp, bool save )
+{
+    m_dram->checkpoint_io(fp,save);
+}
+
+void memory_sub_partition::save_L2( FILE *fp ) const
+{
+    if (!m_config->m_L2_config.disabled()) 
+        m_L2cache->save(fp);
+}
+
+void memory_sub_partition::load_L2( FILE *fp )
+{
+    if (!m_config->m_L2_config.disabled()) 
+        m_L2cache->load(fp);
+}
+
+void memory_sub_partition::warm_L2( new_addr_type addr, unsigned time, bool write )
+{
+    if (!m_config->m_L2_config.disabled()) 
+        m_L2cache->warm(addr,time,write);
+}
+
+void memory_sub_partition::warm_L2_done()
+{
+    if (!m_config->m_L2_config.disabled()) 
+        m_L2cache->warm_done();
+}
+
 bool memory_sub_partition::busy() const 
 {
     return !m_request_tracker.empty();
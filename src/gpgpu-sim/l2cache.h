@@ -70,7 +70,9 @@ public:
 
    void visualizer_print( gzFile visualizer_file ) const;
    void print_stat( FILE *fp ) { m_dram->print_stat(fp); }
+   void reg_stats( class stat_registry &reg ) const;
    void visualize() const { m_dram->visualize(); }
+   void checkpoint_dram_stats( FILE *fp, bool save );
    void print( FILE *fp ) const;
 
    class memory_sub_partition * get_sub_partition(int sub_partition_id) 
@@ -160,6 +162,10 @@ public:
    void set_done( mem_fetch *mf );
 
    unsigned flushL2();
+   void save_L2( FILE *fp ) const;
+   void load_L2( FILE *fp );
+   void warm_L2( new_addr_type addr, unsigned time, bool write );
+   void warm_L2_done();
 
    // interface to L2_dram_queue
    bool L2_dram_queue_empty() const; 
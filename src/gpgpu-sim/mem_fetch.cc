@@ -30,8 +30,106 @@
 #include "shader.h"
 #include "visualizer.h"
 #include "gpu-sim.h"
+#include <stddef.h>
 
 unsigned mem_fetch::sm_next_mf_request_uid=1;
+mem_fetch_pool *mem_fetch::sm_pool=NULL;
+__thread std::vector<mem_fetch*> *mem_fetch::t_uid_pending=NULL;
+
+// mem_fetch objects are carved out of chunks of MEM_FETCH_POOL_CHUNK slots
+// that are only returned to the heap when their pool is destroyed
+#define MEM_FETCH_POOL_CHUNK 1024
+
+union mem_fetch_pool_slot {
+   mem_fetch_pool_slot *next;
+   char storage[sizeof(mem_fetch)];
+   long double align;
+};
+
+// a slot is preceded by the pool that owns it; the header keeps the slot 
+// aligned like the union itself
+union mem_fetch_pool_header {
+   mem_fetch_pool *owner;
+   long double align;
+};
+
+struct mem_fetch_pool_entry {
+   mem_fetch_pool_header header;
+   mem_fetch_pool_slot slot;
+};
+
+mem_fetch_pool::mem_fetch_pool()
+{
+   m_lock = 0;
+   m_free_list = NULL;
+   m_live = 0;
+   m_allocs = 0;
+}
+
+mem_fetch_pool::~mem_fetch_pool()
+{
+   for( unsigned i=0; i < m_chunks.size(); i++ ) 
+      ::free( m_chunks[i] );
+}
+
+void *mem_fetch_pool::alloc()
+{
+   lock();
+   mem_fetch_pool_slot *slot = m_free_list;
+   if( slot == NULL ) {
+      mem_fetch_pool_entry *chunk = (mem_fetch_pool_entry*) malloc( MEM_FETCH_POOL_CHUNK * sizeof(mem_fetch_pool_entry) );
+      if( chunk == NULL ) {
+         printf("GPGPU-Sim uArch: ERROR ** out of memory allocating mem_fetch pool\n");
+         abort();
+      }
+      for( unsigned i=0; i < MEM_FETCH_POOL_CHUNK; i++ ) {
+         chunk[i].header.owner = this;
+         chunk[i].slot.next = (i+1 < MEM_FETCH_POOL_CHUNK)? &chunk[i+1].slot : NULL;
+      }
+      m_chunks.push_back( chunk );
+      slot = &chunk[0].slot;
+   }
+   m_free_list = slot->next;
+   m_live++;
+   m_allocs++;
+   unlock();
+   return slot;
+}
+
+void mem_fetch_pool::free( void *p )
+{
+   // only the leading request uid/sid fields are overwritten by the link, 
+   // so m_status still reads MEM_FETCH_DELETED for a stale pointer
+   mem_fetch_pool_slot *slot = (mem_fetch_pool_slot*) p;
+   lock();
+   slot->next = m_free_list;
+   m_free_list = slot;
+   m_live--;
+   unlock();
+}
+
+void mem_fetch_pool::print_stats( FILE *fp ) const
+{
+   fprintf(fp, "mem_fetch_pool: allocs = %llu, live = %llu, chunks = %llu (%llu bytes)\n", 
+           m_allocs, m_live, (unsigned long long)m_chunks.size(), 
+           m_chunks.size() * MEM_FETCH_POOL_CHUNK * (unsigned long long)sizeof(mem_fetch_pool_entry) );
+}
+
+void *mem_fetch::operator new( size_t size )
+{
+   assert( size == sizeof(mem_fetch) );
+   if( sm_pool == NULL ) 
+      sm_pool = new mem_fetch_pool(); // no simulator has installed one yet
+   return sm_pool->alloc();
+}
+
+void mem_fetch::operator delete( void *p )
+{
+   if( p == NULL ) 
+      return;
+   mem_fetch_pool_entry *entry = (mem_fetch_pool_entry*)( (char*)p - offsetof(mem_fetch_pool_entry, slot) );
+   entry->header.owner->free( p );
+}
 
 mem_fetch::mem_fetch( const mem_access_t &access, 
                       const warp_inst_t *inst,
@@ -41,7 +139,13 @@ mem_fetch::mem_fetch( const mem_access_t &access,
                       unsigned tpc, 
                       const class memory_config *config )
 {
-   m_request_uid = sm_next_mf_request_uid++;
+   m_uid_pending = t_uid_pending;
+   if( m_uid_pending ) {
+      m_request_uid = m_uid_pending->size();
+      m_uid_pending->push_back(this);
+   } else {
+      m_request_uid = sm_next_mf_request_uid++;
+   }
    m_access = access;
    if( inst ) { 
        m_inst = *inst;
@@ -65,9 +169,24 @@ mem_fetch::mem_fetch( const mem_access_t &access,
 
 mem_fetch::~mem_fetch()
 {
+    // a fetch freed before its uid was assigned still uses up its uid
+    if( m_uid_pending ) 
+        (*m_uid_pending)[m_request_uid] = NULL;
     m_status = MEM_FETCH_DELETED;
 }
 
+void mem_fetch::assign_deferred_request_uids( std::vector<mem_fetch*> &pending )
+{
+    for( unsigned i=0; i < pending.size(); i++ ) {
+        unsigned uid = sm_next_mf_request_uid++;
+        if( pending[i] ) {
+            pending[i]->m_request_uid = uid;
+            pending[i]->m_uid_pending = NULL;
+        }
+    }
+    pending.clear();
+}
+
 #define MF_TUP_BEGIN(X) static const char* Status_str[] = {
 #define MF_TUP(X) #X
 #define MF_TUP_END(X) };
@@ -31,6 +31,35 @@
 #include "addrdec.h"
 #include "../abstract_hardware_model.h"
 #include <bitset>
+#include <vector>
+
+// Free-list arena that mem_fetch objects are allocated from. Each 
+// gpgpu_sim owns one and installs it with mem_fetch::set_pool(); every slot 
+// records the pool it came from, so a fetch always returns to its own pool.
+// The free list is shared by all host threads (memory partitions ticked on 
+// worker threads free fetches the cores allocated) and guarded by a spin 
+// lock, since each critical section is only a couple of pointer updates.
+class mem_fetch_pool {
+public:
+   mem_fetch_pool();
+   ~mem_fetch_pool();
+
+   void *alloc();
+   void free( void *p );
+
+   unsigned long long live() const { return m_live; }
+   void print_stats( FILE *fp ) const;
+
+private:
+   void lock() { while( __sync_lock_test_and_set(&m_lock, 1) ) while( m_lock ); }
+   void unlock() { __sync_lock_release(&m_lock); }
+
+   volatile int m_lock;
+   union mem_fetch_pool_slot *m_free_list;
+   std::vector<struct mem_fetch_pool_entry*> m_chunks;
+   unsigned long long m_live;
+   unsigned long long m_allocs;
+};
 
 enum mf_type {
    READ_REQUEST = 0,
@@ -58,6 +87,18 @@ public:
                const class memory_config *config );
    ~mem_fetch();
 
+   // mem_fetch storage is recycled through the installed mem_fetch_pool
+   static void *operator new( size_t size );
+   static void operator delete( void *p );
+   static void set_pool( mem_fetch_pool *pool ) { sm_pool = pool; }
+
+   // Fetches created while 'pending' is set on this host thread get their 
+   // uid only when assign_deferred_request_uids() walks that list. Parallel 
+   // regions keep one list per partition and walk them in partition order 
+   // afterwards, which hands out the uids the serial loop would have.
+   static void defer_request_uids( std::vector<mem_fetch*> *pending ) { t_uid_pending = pending; }
+   static void assign_deferred_request_uids( std::vector<mem_fetch*> &pending );
+
    void set_status( enum mem_fetch_status status, unsigned long long cycle );
    void set_reply() 
    { 
@@ -139,6 +180,9 @@ private:
    warp_inst_t m_inst;
 
    static unsigned sm_next_mf_request_uid;
+   static mem_fetch_pool *sm_pool;
+   static __thread std::vector<mem_fetch*> *t_uid_pending;
+   std::vector<mem_fetch*> *m_uid_pending; // list holding this fetch while its uid is deferred (m_request_uid is its index)
 
    const class memory_config *m_mem_config;
    unsigned icnt_flit_size;
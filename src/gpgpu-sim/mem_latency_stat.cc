@@ -37,6 +37,8 @@
 #include "../cuda-sim/ptx-stats.h"
 #include "visualizer.h"
 #include "dram.h"
+#include "stat_registry.h"
+#include "checkpoint.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -131,6 +133,63 @@ memory_stats_t::memory_stats_t( unsigned n_shader, const struct shader_core_conf
    L2_dramtoL2length = (unsigned int*) calloc(mem_config->m_n_mem, sizeof(unsigned int));
    L2_dramtoL2writelength = (unsigned int*) calloc(mem_config->m_n_mem, sizeof(unsigned int));
    L2_L2todramlength = (unsigned int*) calloc(mem_config->m_n_mem, sizeof(unsigned int));
+
+   pthread_mutex_init(&m_dram_access_lock, NULL);
+}
+
+void memory_stats_t::checkpoint_io( FILE *fp, bool save )
+{
+   unsigned n_mem = m_memory_config->m_n_mem;
+   unsigned nbk = m_memory_config->nbk;
+   ::checkpoint_io(fp,save,max_mrq_latency);
+   ::checkpoint_io(fp,save,max_dq_latency);
+   ::checkpoint_io(fp,save,max_mf_latency);
+   ::checkpoint_io(fp,save,max_icnt2mem_latency);
+   ::checkpoint_io(fp,save,max_icnt2sh_latency);
+   ::checkpoint_io(fp,save,mrq_lat_table);
+   ::checkpoint_io(fp,save,dq_lat_table);
+   ::checkpoint_io(fp,save,mf_lat_table);
+   ::checkpoint_io(fp,save,icnt2mem_lat_table);
+   ::checkpoint_io(fp,save,icnt2sh_lat_table);
+   ::checkpoint_io(fp,save,mf_lat_pw_table);
+   ::checkpoint_io(fp,save,mf_num_lat_pw);
+   ::checkpoint_io(fp,save,mf_tot_lat_pw);
+   ::checkpoint_io(fp,save,mf_total_lat);
+   ::checkpoint_io(fp,save,num_mfs);
+   ::checkpoint_io(fp,save,total_n_access);
+   ::checkpoint_io(fp,save,total_n_reads);
+   ::checkpoint_io(fp,save,total_n_writes);
+   for (unsigned i=0;i<n_mem;i++) {
+      checkpoint_io_array(fp,save,mf_total_lat_table[i],nbk);
+      checkpoint_io_array(fp,save,mf_max_lat_table[i],nbk);
+      checkpoint_io_array(fp,save,totalbankwrites[i],nbk);
+      checkpoint_io_array(fp,save,totalbankreads[i],nbk);
+      checkpoint_io_array(fp,save,totalbankaccesses[i],nbk);
+      checkpoint_io_array(fp,save,concurrent_row_access[i],nbk);
+      checkpoint_io_array(fp,save,num_activates[i],nbk);
+      checkpoint_io_array(fp,save,row_access[i],nbk);
+      checkpoint_io_array(fp,save,max_conc_access2samerow[i],nbk);
+      checkpoint_io_array(fp,save,max_servicetime2samerow[i],nbk);
+   }
+   for (unsigned i=0;i<m_n_shader;i++) {
+      for (unsigned j=0;j<n_mem;j++) {
+         checkpoint_io_array(fp,save,bankwrites[i][j],nbk);
+         checkpoint_io_array(fp,save,bankreads[i][j],nbk);
+      }
+   }
+   for (unsigned i=0;i<NUM_MEM_ACCESS_TYPE;i++) 
+      for (unsigned j=0;j<n_mem;j++) 
+         checkpoint_io_array(fp,save,mem_access_type_stats[i][j],nbk+1);
+   checkpoint_io_array(fp,save,num_MCBs_accessed,n_mem*nbk);
+   unsigned n_positions = m_memory_config->gpgpu_frfcfs_dram_sched_queue_size? 
+                          m_memory_config->gpgpu_frfcfs_dram_sched_queue_size : 1024;
+   checkpoint_io_array(fp,save,position_of_mrq_chosen,n_positions);
+   checkpoint_io_array(fp,save,L2_cbtoL2length,n_mem);
+   checkpoint_io_array(fp,save,L2_cbtoL2writelength,n_mem);
+   checkpoint_io_array(fp,save,L2_L2tocblength,n_mem);
+   checkpoint_io_array(fp,save,L2_dramtoL2length,n_mem);
+   checkpoint_io_array(fp,save,L2_dramtoL2writelength,n_mem);
+   checkpoint_io_array(fp,save,L2_L2todramlength,n_mem);
 }
 
 // record the total latency
@@ -166,8 +225,11 @@ void memory_stats_t::memlatstat_read_done(mem_fetch *mf)
 
 void memory_stats_t::memlatstat_dram_access(mem_fetch *mf)
 {
+   // arrays indexed by dram_id are only touched by the partition owning that
+   // dram; everything else goes through m_dram_access_lock
    unsigned dram_id = mf->get_tlx_addr().chip;
    unsigned bank = mf->get_tlx_addr().bk;
+   pthread_mutex_lock(&m_dram_access_lock);
    if (m_memory_config->gpgpu_memlatency_stat) { 
       if (mf->get_is_write()) {
          if ( mf->get_sid() < m_n_shader  ) {   //do not count L2_writebacks here 
@@ -184,6 +246,7 @@ void memory_stats_t::memlatstat_dram_access(mem_fetch *mf)
    }
    if (mf->get_pc() != (unsigned)-1) 
       ptx_file_line_stats_add_dram_traffic(mf->get_pc(), mf->get_data_size());
+   pthread_mutex_unlock(&m_dram_access_lock);
 }
 
 void memory_stats_t::memlatstat_icnt2mem_pop(mem_fetch *mf)
@@ -460,3 +523,34 @@ void memory_stats_t::memlatstat_print( unsigned n_mem, unsigned gpu_mem_n_bk )
       printf("\naverage position of mrq chosen = %f\n", (float)l/k);
    }
 }
+
+void memory_stats_t::reg_stats( stat_registry &reg ) const
+{
+   reg.reg("maxmrqlatency", &max_mrq_latency);
+   reg.reg("maxdqlatency", &max_dq_latency);
+   reg.reg("maxmflatency", &max_mf_latency);
+   reg.reg("max_icnt2mem_latency", &max_icnt2mem_latency);
+   reg.reg("max_icnt2sh_latency", &max_icnt2sh_latency);
+   reg.reg("mf_total_lat", &mf_total_lat);
+   reg.reg("num_mfs", &num_mfs);
+   reg.reg("total_n_access", &total_n_access);
+   reg.reg("total_n_reads", &total_n_reads);
+   reg.reg("total_n_writes", &total_n_writes);
+   // latency histograms indexed by LOGB2(latency)
+   reg.reg("mrq_lat_table", mrq_lat_table, 32);
+   reg.reg("dq_lat_table", dq_lat_table, 32);
+   reg.reg("mf_lat_table", mf_lat_table, 32);
+   reg.reg("icnt2mem_lat_table", icnt2mem_lat_table, 24);
+   reg.reg("icnt2sh_lat_table", icnt2sh_lat_table, 24);
+   // one value per bank of each DRAM chip
+   unsigned nbk = m_memory_config->nbk;
+   for (unsigned i=0;i<m_memory_config->m_n_mem;i++) {
+      reg.reg(stat_registry::indexed("totalbankreads",i), totalbankreads[i], nbk);
+      reg.reg(stat_registry::indexed("totalbankwrites",i), totalbankwrites[i], nbk);
+      reg.reg(stat_registry::indexed("totalbankaccesses",i), totalbankaccesses[i], nbk);
+      reg.reg(stat_registry::indexed("mf_total_lat_table",i), mf_total_lat_table[i], nbk);
+      reg.reg(stat_registry::indexed("mf_max_lat_table",i), mf_max_lat_table[i], nbk);
+      reg.reg(stat_registry::indexed("row_access",i), row_access[i], nbk);
+      reg.reg(stat_registry::indexed("num_activates",i), num_activates[i], nbk);
+   }
+}
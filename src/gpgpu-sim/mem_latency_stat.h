@@ -30,8 +30,29 @@
 
 #include <stdio.h>
 #include <zlib.h>
+#include <pthread.h>
 #include <map>
 
+// Counters below that are shared between memory partitions are updated with
+// these helpers so that memory partitions can be ticked from multiple host
+// threads (-gpgpu_n_sim_threads). Both operations commute, so the final
+// values do not depend on the order in which partitions are ticked.
+inline void stat_atomic_inc( unsigned &counter )
+{
+   __sync_fetch_and_add(&counter, 1);
+}
+
+inline void stat_atomic_max( unsigned &max_value, unsigned value )
+{
+   unsigned old = max_value;
+   while (value > old) {
+      unsigned seen = __sync_val_compare_and_swap(&max_value, old, value);
+      if (seen == old)
+         break;
+      old = seen;
+   }
+}
+
 class memory_stats_t {
 public:
    memory_stats_t( unsigned n_shader, 
@@ -46,6 +67,9 @@ public:
    void memlatstat_print(unsigned n_mem, unsigned gpu_mem_n_bk);
 
    void visualizer_print( gzFile visualizer_file );
+   void reg_stats( class stat_registry &reg ) const;
+   // save (or restore) every counter to a kernel boundary checkpoint
+   void checkpoint_io( FILE *fp, bool save );
 
    unsigned m_n_shader;
 
@@ -100,6 +124,11 @@ public:
    unsigned total_n_access;
    unsigned total_n_reads;
    unsigned total_n_writes;
+
+private:
+   // serializes per-dram-access logging into state shared by all partitions 
+   // (cflog loggers and ptx source line stats)
+   pthread_mutex_t m_dram_access_lock;
 };
 
 #endif /*MEM_LATENCY_STAT_H*/
@@ -373,7 +373,7 @@ public:
 
     unsigned get_constant_c_accesses(){
         enum mem_access_type access_type[] = {CONST_ACC_R};
-        enum cache_request_status request_status[] = {HIT, MISS, HIT_RESERVED};
+        enum cache_request_status request_status[] = {HIT, MISS, HIT_RESERVED, SECTOR_MISS};
         unsigned num_access_type = sizeof(access_type)/sizeof(enum mem_access_type);
         unsigned num_request_status = sizeof(request_status)/sizeof(enum cache_request_status);
 
@@ -382,7 +382,7 @@ public:
     }
     unsigned get_constant_c_misses(){
         enum mem_access_type access_type[] = {CONST_ACC_R};
-        enum cache_request_status request_status[] = {MISS};
+        enum cache_request_status request_status[] = {MISS, SECTOR_MISS};
         unsigned num_access_type = sizeof(access_type)/sizeof(enum mem_access_type);
         unsigned num_request_status = sizeof(request_status)/sizeof(enum cache_request_status);
 
@@ -394,7 +394,7 @@ public:
     }
     unsigned get_texture_c_accesses(){
         enum mem_access_type access_type[] = {TEXTURE_ACC_R};
-        enum cache_request_status request_status[] = {HIT, MISS, HIT_RESERVED};
+        enum cache_request_status request_status[] = {HIT, MISS, HIT_RESERVED, SECTOR_MISS};
         unsigned num_access_type = sizeof(access_type)/sizeof(enum mem_access_type);
         unsigned num_request_status = sizeof(request_status)/sizeof(enum cache_request_status);
 
@@ -403,7 +403,7 @@ public:
     }
     unsigned get_texture_c_misses(){
         enum mem_access_type access_type[] = {TEXTURE_ACC_R};
-        enum cache_request_status request_status[] = {MISS};
+        enum cache_request_status request_status[] = {MISS, SECTOR_MISS};
         unsigned num_access_type = sizeof(access_type)/sizeof(enum mem_access_type);
         unsigned num_request_status = sizeof(request_status)/sizeof(enum cache_request_status);
 
@@ -415,7 +415,7 @@ public:
     }
     unsigned get_inst_c_accesses(){
         enum mem_access_type access_type[] = {INST_ACC_R};
-        enum cache_request_status request_status[] = {HIT, MISS, HIT_RESERVED};
+        enum cache_request_status request_status[] = {HIT, MISS, HIT_RESERVED, SECTOR_MISS};
         unsigned num_access_type = sizeof(access_type)/sizeof(enum mem_access_type);
         unsigned num_request_status = sizeof(request_status)/sizeof(enum cache_request_status);
 
@@ -424,7 +424,7 @@ public:
     }
     unsigned get_inst_c_misses(){
         enum mem_access_type access_type[] = {INST_ACC_R};
-        enum cache_request_status request_status[] = {MISS};
+        enum cache_request_status request_status[] = {MISS, SECTOR_MISS};
         unsigned num_access_type = sizeof(access_type)/sizeof(enum mem_access_type);
         unsigned num_request_status = sizeof(request_status)/sizeof(enum cache_request_status);
 
@@ -437,7 +437,7 @@ public:
 
     unsigned get_l1d_read_accesses(){
         enum mem_access_type access_type[] = {GLOBAL_ACC_R, LOCAL_ACC_R};
-        enum cache_request_status request_status[] = {HIT, MISS, HIT_RESERVED};
+        enum cache_request_status request_status[] = {HIT, MISS, HIT_RESERVED, SECTOR_MISS};
         unsigned num_access_type = sizeof(access_type)/sizeof(enum mem_access_type);
         unsigned num_request_status = sizeof(request_status)/sizeof(enum cache_request_status);
 
@@ -446,7 +446,7 @@ public:
     }
     unsigned get_l1d_read_misses(){
         enum mem_access_type access_type[] = {GLOBAL_ACC_R, LOCAL_ACC_R};
-        enum cache_request_status request_status[] = {MISS};
+        enum cache_request_status request_status[] = {MISS, SECTOR_MISS};
         unsigned num_access_type = sizeof(access_type)/sizeof(enum mem_access_type);
         unsigned num_request_status = sizeof(request_status)/sizeof(enum cache_request_status);
 
@@ -458,7 +458,7 @@ public:
     }
     unsigned get_l1d_write_accesses(){
         enum mem_access_type access_type[] = {GLOBAL_ACC_W, LOCAL_ACC_W};
-        enum cache_request_status request_status[] = {HIT, MISS, HIT_RESERVED};
+        enum cache_request_status request_status[] = {HIT, MISS, HIT_RESERVED, SECTOR_MISS};
         unsigned num_access_type = sizeof(access_type)/sizeof(enum mem_access_type);
         unsigned num_request_status = sizeof(request_status)/sizeof(enum cache_request_status);
 
@@ -467,7 +467,7 @@ public:
     }
     unsigned get_l1d_write_misses(){
         enum mem_access_type access_type[] = {GLOBAL_ACC_W, LOCAL_ACC_W};
-        enum cache_request_status request_status[] = {MISS};
+        enum cache_request_status request_status[] = {MISS, SECTOR_MISS};
         unsigned num_access_type = sizeof(access_type)/sizeof(enum mem_access_type);
         unsigned num_request_status = sizeof(request_status)/sizeof(enum cache_request_status);
 
@@ -499,7 +499,7 @@ public:
 
     unsigned get_l2_read_accesses(){
         enum mem_access_type access_type[] = {GLOBAL_ACC_R, LOCAL_ACC_R, CONST_ACC_R, TEXTURE_ACC_R, INST_ACC_R};
-        enum cache_request_status request_status[] = {HIT, MISS, HIT_RESERVED};
+        enum cache_request_status request_status[] = {HIT, MISS, HIT_RESERVED, SECTOR_MISS};
         unsigned num_access_type = sizeof(access_type)/sizeof(enum mem_access_type);
         unsigned num_request_status = sizeof(request_status)/sizeof(enum cache_request_status);
 
@@ -509,7 +509,7 @@ public:
 
     unsigned get_l2_read_misses(){
         enum mem_access_type access_type[] = {GLOBAL_ACC_R, LOCAL_ACC_R, CONST_ACC_R, TEXTURE_ACC_R, INST_ACC_R};
-        enum cache_request_status request_status[] = {MISS};
+        enum cache_request_status request_status[] = {MISS, SECTOR_MISS};
         unsigned num_access_type = sizeof(access_type)/sizeof(enum mem_access_type);
         unsigned num_request_status = sizeof(request_status)/sizeof(enum cache_request_status);
 
@@ -523,7 +523,7 @@ public:
 
     unsigned get_l2_write_accesses(){
         enum mem_access_type access_type[] = {GLOBAL_ACC_W, LOCAL_ACC_W, L1_WRBK_ACC};
-        enum cache_request_status request_status[] = {HIT, MISS, HIT_RESERVED};
+        enum cache_request_status request_status[] = {HIT, MISS, HIT_RESERVED, SECTOR_MISS};
         unsigned num_access_type = sizeof(access_type)/sizeof(enum mem_access_type);
         unsigned num_request_status = sizeof(request_status)/sizeof(enum cache_request_status);
 
@@ -533,7 +533,7 @@ public:
 
     unsigned get_l2_write_misses(){
         enum mem_access_type access_type[] = {GLOBAL_ACC_W, LOCAL_ACC_W, L1_WRBK_ACC};
-        enum cache_request_status request_status[] = {MISS};
+        enum cache_request_status request_status[] = {MISS, SECTOR_MISS};
         unsigned num_access_type = sizeof(access_type)/sizeof(enum mem_access_type);
         unsigned num_request_status = sizeof(request_status)/sizeof(enum cache_request_status);
 
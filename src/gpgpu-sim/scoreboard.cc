@@ -31,53 +31,93 @@
 #include "shader_trace.h"
 
 
+extern unsigned g_max_regs_per_thread;
+
 //Constructor
 Scoreboard::Scoreboard( unsigned sid, unsigned n_warps )
 : longopregs()
 {
 	m_sid = sid;
-	//Initialize size of table
-	reg_table.resize(n_warps);
-	longopregs.resize(n_warps);
+	m_n_warps = n_warps;
+	m_words = 0;
+	//Initialize size of table from the largest register number parsed so far;
+	//kernels loaded later grow it on demand in set_reg()
+	m_pending.resize(n_warps,0);
+	resize(g_max_regs_per_thread);
+}
+
+// Grow the per-warp masks so that register max_regnum fits
+void Scoreboard::resize( unsigned max_regnum )
+{
+	unsigned words = max_regnum / REG_MASK_BITS + 1;
+	if( words <= m_words ) 
+		return;
+	std::vector<reg_mask_t> new_reg_table(m_n_warps*words,0);
+	std::vector<reg_mask_t> new_longopregs(m_n_warps*words,0);
+	for(unsigned i=0; i<m_n_warps; i++) {
+		for(unsigned w=0; w<m_words; w++) {
+			new_reg_table[i*words+w] = reg_table[i*m_words+w];
+			new_longopregs[i*words+w] = longopregs[i*m_words+w];
+		}
+	}
+	reg_table.swap(new_reg_table);
+	longopregs.swap(new_longopregs);
+	m_words = words;
+}
+
+void Scoreboard::set_reg( std::vector<reg_mask_t> &table, unsigned wid, unsigned regnum )
+{
+	if( regnum / REG_MASK_BITS >= m_words ) 
+		resize(regnum);
+	table[wid*m_words + regnum/REG_MASK_BITS] |= ((reg_mask_t)1) << (regnum % REG_MASK_BITS);
+}
+
+void Scoreboard::clear_reg( std::vector<reg_mask_t> &table, unsigned wid, unsigned regnum )
+{
+	if( regnum / REG_MASK_BITS >= m_words ) 
+		return;
+	table[wid*m_words + regnum/REG_MASK_BITS] &= ~(((reg_mask_t)1) << (regnum % REG_MASK_BITS));
 }
 
 // Print scoreboard contents
 void Scoreboard::printContents() const
 {
 	printf("scoreboard contents (sid=%d): \n", m_sid);
-	for(unsigned i=0; i<reg_table.size(); i++) {
-		if(reg_table[i].size() == 0 ) continue;
+	for(unsigned i=0; i<m_n_warps; i++) {
+		if(m_pending[i] == 0 ) continue;
 		printf("  wid = %2d: ", i);
-		std::set<unsigned>::const_iterator it;
-		for( it=reg_table[i].begin() ; it != reg_table[i].end(); it++ )
-			printf("%u ", *it);
+		for( unsigned r=0; r < m_words*REG_MASK_BITS; r++ )
+			if( test_reg(reg_table,i,r) ) 
+				printf("%u ", r);
 		printf("\n");
 	}
 }
 
 void Scoreboard::reserveRegister(unsigned wid, unsigned regnum) 
 {
-	if( !(reg_table[wid].find(regnum) == reg_table[wid].end()) ){
+	if( test_reg(reg_table,wid,regnum) ){
 		printf("Error: trying to reserve an already reserved register (sid=%d, wid=%d, regnum=%d).", m_sid, wid, regnum);
         abort();
 	}
     SHADER_DPRINTF( SCOREBOARD,
                     "Reserved Register - warp:%d, reg: %d\n", wid, regnum );
-	reg_table[wid].insert(regnum);
+	set_reg(reg_table,wid,regnum);
+	m_pending[wid]++;
 }
 
 // Unmark register as write-pending
 void Scoreboard::releaseRegister(unsigned wid, unsigned regnum) 
 {
-	if( !(reg_table[wid].find(regnum) != reg_table[wid].end()) ) 
+	if( !test_reg(reg_table,wid,regnum) ) 
         return;
     SHADER_DPRINTF( SCOREBOARD,
                     "Release register - warp:%d, reg: %d\n", wid, regnum );
-	reg_table[wid].erase(regnum);
+	clear_reg(reg_table,wid,regnum);
+	m_pending[wid]--;
 }
 
 const bool Scoreboard::islongop (unsigned warp_id,unsigned regnum) {
-	return longopregs[warp_id].find(regnum) != longopregs[warp_id].end();
+	return test_reg(longopregs,warp_id,regnum);
 }
 
 void Scoreboard::reserveRegisters(const class warp_inst_t* inst) 
@@ -106,7 +146,7 @@ void Scoreboard::reserveRegisters(const class warp_inst_t* inst)
                                 "New longopreg marked - warp:%d, reg: %d\n",
                                 inst->warp_id(),
                                 inst->out[r] );
-                longopregs[inst->warp_id()].insert(inst->out[r]);
+                set_reg(longopregs,inst->warp_id(),inst->out[r]);
             }
     	}
     }
@@ -122,7 +162,7 @@ void Scoreboard::releaseRegisters(const class warp_inst_t *inst)
                             inst->warp_id(),
                             inst->out[r] );
             releaseRegister(inst->warp_id(), inst->out[r]);
-            longopregs[inst->warp_id()].erase(inst->out[r]);
+            clear_reg(longopregs,inst->warp_id(),inst->out[r]);
         }
     }
 }
@@ -135,31 +175,22 @@ void Scoreboard::releaseRegisters(const class warp_inst_t *inst)
  **/ 
 bool Scoreboard::checkCollision( unsigned wid, const class inst_t *inst ) const
 {
-	// Get list of all input and output registers
-	std::set<int> inst_regs;
-
-	if(inst->out[0] > 0) inst_regs.insert(inst->out[0]);
-	if(inst->out[1] > 0) inst_regs.insert(inst->out[1]);
-	if(inst->out[2] > 0) inst_regs.insert(inst->out[2]);
-	if(inst->out[3] > 0) inst_regs.insert(inst->out[3]);
-	if(inst->in[0] > 0) inst_regs.insert(inst->in[0]);
-	if(inst->in[1] > 0) inst_regs.insert(inst->in[1]);
-	if(inst->in[2] > 0) inst_regs.insert(inst->in[2]);
-	if(inst->in[3] > 0) inst_regs.insert(inst->in[3]);
-	if(inst->pred > 0) inst_regs.insert(inst->pred);
-	if(inst->ar1 > 0) inst_regs.insert(inst->ar1);
-	if(inst->ar2 > 0) inst_regs.insert(inst->ar2);
-
-	// Check for collision, get the intersection of reserved registers and instruction registers
-	std::set<int>::const_iterator it2;
-	for ( it2=inst_regs.begin() ; it2 != inst_regs.end(); it2++ )
-		if(reg_table[wid].find(*it2) != reg_table[wid].end()) {
-			return true;
-		}
-	return false;
+	// Test each input and output register against the warp's pending-write
+	// mask; register 0 means the operand slot is unused
+	const reg_mask_t *mask = &reg_table[wid*m_words];
+	const unsigned regs[11] = { inst->out[0], inst->out[1], inst->out[2], inst->out[3],
+	                            inst->in[0], inst->in[1], inst->in[2], inst->in[3],
+	                            (unsigned)inst->pred, (unsigned)inst->ar1, (unsigned)inst->ar2 };
+	reg_mask_t hit = 0;
+	for( unsigned i=0; i < 11; i++ ) {
+		unsigned w = regs[i] / REG_MASK_BITS;
+		if( regs[i] > 0 && w < m_words ) 
+			hit |= mask[w] & (((reg_mask_t)1) << (regs[i] % REG_MASK_BITS));
+	}
+	return hit != 0;
 }
 
 bool Scoreboard::pendingWrites(unsigned wid) const
 {
-	return !reg_table[wid].empty();
+	return m_pending[wid] != 0;
 }
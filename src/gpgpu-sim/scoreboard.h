@@ -28,7 +28,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <vector>
-#include <set>
 #include "assert.h"
 
 #ifndef SCOREBOARD_H_
@@ -49,16 +48,34 @@ public:
     void printContents() const;
     const bool islongop(unsigned warp_id, unsigned regnum);
 private:
+    typedef unsigned long long reg_mask_t;
+    static const unsigned REG_MASK_BITS = 8*sizeof(reg_mask_t);
+
     void reserveRegister(unsigned wid, unsigned regnum);
     int get_sid() const { return m_sid; }
 
+    bool test_reg( const std::vector<reg_mask_t> &table, unsigned wid, unsigned regnum ) const
+    {
+        unsigned w = regnum / REG_MASK_BITS;
+        if( w >= m_words ) 
+            return false;
+        return (table[wid*m_words+w] >> (regnum % REG_MASK_BITS)) & 1;
+    }
+    void set_reg( std::vector<reg_mask_t> &table, unsigned wid, unsigned regnum );
+    void clear_reg( std::vector<reg_mask_t> &table, unsigned wid, unsigned regnum );
+    void resize( unsigned max_regnum );
+
     unsigned m_sid;
+    unsigned m_n_warps;
+    unsigned m_words; // mask words per warp
 
     // keeps track of pending writes to registers
-    // indexed by warp id, reg_id => pending write count
-    std::vector< std::set<unsigned> > reg_table;
+    // bit reg_id of warp wid is at word wid*m_words + reg_id/REG_MASK_BITS
+    std::vector<reg_mask_t> reg_table;
     //Register that depend on a long operation (global, local or tex memory)
-    std::vector< std::set<unsigned> > longopregs;
+    std::vector<reg_mask_t> longopregs;
+    // number of registers reserved per warp, makes pendingWrites() O(1)
+    std::vector<unsigned> m_pending;
 };
 
 
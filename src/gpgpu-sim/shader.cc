@@ -45,7 +45,10 @@
 #include <string.h>
 #include <limits.h>
 #include "traffic_breakdown.h"
+#include "stat_registry.h"
 #include "shader_trace.h"
+#include "sim_profiler.h"
+#include "checkpoint.h"
 
 #define PRIORITIZE_MSHR_OVER_WB 1
 #define MAX(a,b) (((a)>(b))?(a):(b))
@@ -121,6 +124,12 @@ shader_core_ctx::shader_core_ctx( class gpgpu_sim *gpu,
     
     m_warp.resize(m_config->max_warps_per_shader, shd_warp_t(this, warp_size));
     m_scoreboard = new Scoreboard(m_sid, m_config->max_warps_per_shader);
+
+    m_trace_file = gpu->get_warp_trace();
+    if( m_trace_file ) {
+        m_warp_trace.resize(m_config->max_warps_per_shader);
+        m_trace_thread_done.assign(m_config->n_thread_per_shader,true);
+    }
     
     //scedulers
     //must currently occur after all inputs have been initialized.
@@ -209,6 +218,8 @@ shader_core_ctx::shader_core_ctx( class gpgpu_sim *gpu,
     for ( int i = 0; i < m_config->gpgpu_num_sched_per_core; ++i ) {
         schedulers[i]->done_adding_supervised_warps();
     }
+    m_idle = false;
+    m_idle_sched_distro.resize( schedulers.size(), 0 );
     
     //op collector configuration
     enum { SP_CUS, SFU_CUS, MEM_CUS, GEN_CUS };
@@ -300,6 +311,7 @@ shader_core_ctx::shader_core_ctx( class gpgpu_sim *gpu,
 
 void shader_core_ctx::reinit(unsigned start_thread, unsigned end_thread, bool reset_not_completed ) 
 {
+   m_idle = false;
    if( reset_not_completed ) {
        m_not_completed = 0;
        m_active_threads.reset();
@@ -345,6 +357,8 @@ address_type shader_core_ctx::next_pc( int tid ) const
 {
     if( tid == -1 ) 
         return -1;
+    if( trace_replay() ) 
+        return m_warp_trace[tid/m_config->warp_size].peek_pc();
     ptx_thread_info *the_thread = m_thread[tid];
     if ( the_thread == NULL )
         return -1;
@@ -363,6 +377,159 @@ void shader_core_ctx::get_pdom_stack_top_info( unsigned tid, unsigned *pc, unsig
     m_simt_stack[warp_id]->get_pdom_stack_top_info(pc,rpc);
 }
 
+void shader_core_stats::reg_stats( stat_registry &reg ) const
+{
+    // per core counters: one value per shader core
+    unsigned n = m_config->num_shader();
+    reg.reg("shader_cycles", shader_cycles, n);
+    reg.reg("shader_num_sim_insn", m_num_sim_insn, n);
+    reg.reg("shader_num_sim_winsn", m_num_sim_winsn, n);
+    reg.reg("shader_num_decoded_insn", m_num_decoded_insn, n);
+    reg.reg("shader_num_FPdecoded_insn", m_num_FPdecoded_insn, n);
+    reg.reg("shader_num_INTdecoded_insn", m_num_INTdecoded_insn, n);
+    reg.reg("shader_num_storequeued_insn", m_num_storequeued_insn, n);
+    reg.reg("shader_num_loadqueued_insn", m_num_loadqueued_insn, n);
+    reg.reg("shader_num_ialu_acesses", m_num_ialu_acesses, n);
+    reg.reg("shader_num_fp_acesses", m_num_fp_acesses, n);
+    reg.reg("shader_num_imul_acesses", m_num_imul_acesses, n);
+    reg.reg("shader_num_imul24_acesses", m_num_imul24_acesses, n);
+    reg.reg("shader_num_imul32_acesses", m_num_imul32_acesses, n);
+    reg.reg("shader_num_tex_inst", m_num_tex_inst, n);
+    reg.reg("shader_num_fpmul_acesses", m_num_fpmul_acesses, n);
+    reg.reg("shader_num_idiv_acesses", m_num_idiv_acesses, n);
+    reg.reg("shader_num_fpdiv_acesses", m_num_fpdiv_acesses, n);
+    reg.reg("shader_num_sp_acesses", m_num_sp_acesses, n);
+    reg.reg("shader_num_sfu_acesses", m_num_sfu_acesses, n);
+    reg.reg("shader_num_trans_acesses", m_num_trans_acesses, n);
+    reg.reg("shader_num_mem_acesses", m_num_mem_acesses, n);
+    reg.reg("shader_num_sp_committed", m_num_sp_committed, n);
+    reg.reg("shader_num_sfu_committed", m_num_sfu_committed, n);
+    reg.reg("shader_num_mem_committed", m_num_mem_committed, n);
+    reg.reg("shader_num_tlb_hits", m_num_tlb_hits, n);
+    reg.reg("shader_num_tlb_accesses", m_num_tlb_accesses, n);
+    reg.reg("shader_read_regfile_acesses", m_read_regfile_acesses, n);
+    reg.reg("shader_write_regfile_acesses", m_write_regfile_acesses, n);
+    reg.reg("shader_non_rf_operands", m_non_rf_operands, n);
+    reg.reg("shader_active_sp_lanes", m_active_sp_lanes, n);
+    reg.reg("shader_active_sfu_lanes", m_active_sfu_lanes, n);
+    reg.reg("shader_active_fu_lanes", m_active_fu_lanes, n);
+    reg.reg("shader_active_fu_mem_lanes", m_active_fu_mem_lanes, n);
+    reg.reg("shader_n_diverge", m_n_diverge, n);
+    reg.reg("shader_pipeline_duty_cycle", m_pipeline_duty_cycle, n);
+    reg.reg("shader_n_shmem_bank_access", gpgpu_n_shmem_bank_access, n);
+    reg.reg("shader_n_simt_to_mem", n_simt_to_mem, n);
+    reg.reg("shader_n_mem_to_simt", n_mem_to_simt, n);
+    // cycles by number of active threads (see print_shader_cycle_distro)
+    reg.reg("shader_cycle_distro", shader_cycle_distro, m_config->warp_size+3);
+
+    reg.reg("gpgpu_n_stall_shd_mem", &gpgpu_n_stall_shd_mem);
+    reg.reg("gpgpu_n_scoreboard_check", &gpgpu_n_scoreboard_check);
+    reg.reg("gpgpu_n_mem_read_local", &gpgpu_n_mem_read_local);
+    reg.reg("gpgpu_n_mem_write_local", &gpgpu_n_mem_write_local);
+    reg.reg("gpgpu_n_mem_read_global", &gpgpu_n_mem_read_global);
+    reg.reg("gpgpu_n_mem_write_global", &gpgpu_n_mem_write_global);
+    reg.reg("gpgpu_n_mem_texture", &gpgpu_n_mem_texture);
+    reg.reg("gpgpu_n_mem_const", &gpgpu_n_mem_const);
+    reg.reg("gpgpu_n_mem_read_inst", &gpgpu_n_mem_read_inst);
+    reg.reg("gpgpu_n_mem_l2_writeback", &gpgpu_n_mem_l2_writeback);
+    reg.reg("gpgpu_n_mem_l1_write_allocate", &gpgpu_n_mem_l1_write_allocate);
+    reg.reg("gpgpu_n_mem_l2_write_allocate", &gpgpu_n_mem_l2_write_allocate);
+    reg.reg("gpgpu_n_load_insn", &gpgpu_n_load_insn);
+    reg.reg("gpgpu_n_store_insn", &gpgpu_n_store_insn);
+    reg.reg("gpgpu_n_shmem_insn", &gpgpu_n_shmem_insn);
+    reg.reg("gpgpu_n_tex_insn", &gpgpu_n_tex_insn);
+    reg.reg("gpgpu_n_const_insn", &gpgpu_n_const_insn);
+    reg.reg("gpgpu_n_param_insn", &gpgpu_n_param_insn);
+    reg.reg("gpgpu_n_shmem_bkconflict", &gpgpu_n_shmem_bkconflict);
+    reg.reg("gpgpu_n_cache_bkconflict", &gpgpu_n_cache_bkconflict);
+    reg.reg("gpgpu_n_intrawarp_mshr_merge", &gpgpu_n_intrawarp_mshr_merge);
+    reg.reg("gpgpu_n_cmem_portconflict", &gpgpu_n_cmem_portconflict);
+    reg.reg("gpu_reg_bank_conflict_stalls", &gpu_reg_bank_conflict_stalls);
+    // [mem_stage_access_type][mem_stage_stall_type], row major
+    reg.reg("gpgpu_stall_shd_mem", &gpu_stall_shd_mem_breakdown[0][0], N_MEM_STAGE_ACCESS_TYPE*N_MEM_STAGE_STALL_TYPE);
+}
+
+void shader_core_stats::checkpoint_io( FILE *fp, bool save )
+{
+    unsigned n = m_config->num_shader();
+    checkpoint_io_array(fp,save,shader_cycles,n);
+    checkpoint_io_array(fp,save,m_num_sim_insn,n);
+    checkpoint_io_array(fp,save,m_num_sim_winsn,n);
+    checkpoint_io_array(fp,save,m_last_num_sim_insn,n);
+    checkpoint_io_array(fp,save,m_last_num_sim_winsn,n);
+    checkpoint_io_array(fp,save,m_num_decoded_insn,n);
+    checkpoint_io_array(fp,save,m_pipeline_duty_cycle,n);
+    checkpoint_io_array(fp,save,m_num_FPdecoded_insn,n);
+    checkpoint_io_array(fp,save,m_num_INTdecoded_insn,n);
+    checkpoint_io_array(fp,save,m_num_storequeued_insn,n);
+    checkpoint_io_array(fp,save,m_num_loadqueued_insn,n);
+    checkpoint_io_array(fp,save,m_num_ialu_acesses,n);
+    checkpoint_io_array(fp,save,m_num_fp_acesses,n);
+    checkpoint_io_array(fp,save,m_num_imul_acesses,n);
+    checkpoint_io_array(fp,save,m_num_tex_inst,n);
+    checkpoint_io_array(fp,save,m_num_fpmul_acesses,n);
+    checkpoint_io_array(fp,save,m_num_idiv_acesses,n);
+    checkpoint_io_array(fp,save,m_num_fpdiv_acesses,n);
+    checkpoint_io_array(fp,save,m_num_sp_acesses,n);
+    checkpoint_io_array(fp,save,m_num_sfu_acesses,n);
+    checkpoint_io_array(fp,save,m_num_trans_acesses,n);
+    checkpoint_io_array(fp,save,m_num_mem_acesses,n);
+    checkpoint_io_array(fp,save,m_num_sp_committed,n);
+    checkpoint_io_array(fp,save,m_num_tlb_hits,n);
+    checkpoint_io_array(fp,save,m_num_tlb_accesses,n);
+    checkpoint_io_array(fp,save,m_num_sfu_committed,n);
+    checkpoint_io_array(fp,save,m_num_mem_committed,n);
+    checkpoint_io_array(fp,save,m_read_regfile_acesses,n);
+    checkpoint_io_array(fp,save,m_write_regfile_acesses,n);
+    checkpoint_io_array(fp,save,m_non_rf_operands,n);
+    checkpoint_io_array(fp,save,m_num_imul24_acesses,n);
+    checkpoint_io_array(fp,save,m_num_imul32_acesses,n);
+    checkpoint_io_array(fp,save,m_active_sp_lanes,n);
+    checkpoint_io_array(fp,save,m_active_sfu_lanes,n);
+    checkpoint_io_array(fp,save,m_active_fu_lanes,n);
+    checkpoint_io_array(fp,save,m_active_fu_mem_lanes,n);
+    checkpoint_io_array(fp,save,m_n_diverge,n);
+    checkpoint_io_array(fp,save,gpgpu_n_shmem_bank_access,n);
+    checkpoint_io_array(fp,save,n_simt_to_mem,n);
+    checkpoint_io_array(fp,save,n_mem_to_simt,n);
+    checkpoint_io_array(fp,save,shader_cycle_distro,m_config->warp_size+3);
+    checkpoint_io_array(fp,save,last_shader_cycle_distro,m_config->warp_size+3);
+
+    ::checkpoint_io(fp,save,gpgpu_n_load_insn);
+    ::checkpoint_io(fp,save,gpgpu_n_store_insn);
+    ::checkpoint_io(fp,save,gpgpu_n_shmem_insn);
+    ::checkpoint_io(fp,save,gpgpu_n_tex_insn);
+    ::checkpoint_io(fp,save,gpgpu_n_const_insn);
+    ::checkpoint_io(fp,save,gpgpu_n_param_insn);
+    ::checkpoint_io(fp,save,gpgpu_n_shmem_bkconflict);
+    ::checkpoint_io(fp,save,gpgpu_n_cache_bkconflict);
+    ::checkpoint_io(fp,save,gpgpu_n_intrawarp_mshr_merge);
+    ::checkpoint_io(fp,save,gpgpu_n_cmem_portconflict);
+    ::checkpoint_io(fp,save,gpu_stall_shd_mem_breakdown);
+    ::checkpoint_io(fp,save,gpu_reg_bank_conflict_stalls);
+    ::checkpoint_io(fp,save,gpgpu_n_stall_shd_mem);
+    ::checkpoint_io(fp,save,gpgpu_n_scoreboard_check);
+    ::checkpoint_io(fp,save,gpgpu_n_mem_read_local);
+    ::checkpoint_io(fp,save,gpgpu_n_mem_write_local);
+    ::checkpoint_io(fp,save,gpgpu_n_mem_texture);
+    ::checkpoint_io(fp,save,gpgpu_n_mem_const);
+    ::checkpoint_io(fp,save,gpgpu_n_mem_read_global);
+    ::checkpoint_io(fp,save,gpgpu_n_mem_write_global);
+    ::checkpoint_io(fp,save,gpgpu_n_mem_read_inst);
+    ::checkpoint_io(fp,save,gpgpu_n_mem_l2_writeback);
+    ::checkpoint_io(fp,save,gpgpu_n_mem_l1_write_allocate);
+    ::checkpoint_io(fp,save,gpgpu_n_mem_l2_write_allocate);
+    ::checkpoint_io(fp,save,made_write_mfs);
+    ::checkpoint_io(fp,save,made_read_mfs);
+
+    m_outgoing_traffic_stats->checkpoint_io(fp,save);
+    m_incoming_traffic_stats->checkpoint_io(fp,save);
+    ::checkpoint_io(fp,save,m_shader_dynamic_warp_issue_distro);
+    ::checkpoint_io(fp,save,m_last_shader_dynamic_warp_issue_distro);
+    ::checkpoint_io(fp,save,m_shader_warp_slot_issue_distro);
+    ::checkpoint_io(fp,save,m_last_shader_warp_slot_issue_distro);
+}
+
 void shader_core_stats::print( FILE* fout ) const
 {
 	unsigned long long  thread_icount_uarch=0;
@@ -376,6 +543,9 @@ void shader_core_stats::print( FILE* fout ) const
     fprintf(fout,"gpgpu_n_tot_w_icount = %lld\n", warp_icount_uarch);
 
     fprintf(fout,"gpgpu_n_stall_shd_mem = %d\n", gpgpu_n_stall_shd_mem );
+    fprintf(fout,"gpgpu_n_scoreboard_check = %llu\n", gpgpu_n_scoreboard_check );
+    fprintf(fout,"gpgpu_scoreboard_check_per_cycle = %.4f\n", 
+            (gpu_tot_sim_cycle+gpu_sim_cycle) ? (double)gpgpu_n_scoreboard_check/(gpu_tot_sim_cycle+gpu_sim_cycle) : 0.0 );
     fprintf(fout,"gpgpu_n_mem_read_local = %d\n", gpgpu_n_mem_read_local);
     fprintf(fout,"gpgpu_n_mem_write_local = %d\n", gpgpu_n_mem_write_local);
     fprintf(fout,"gpgpu_n_mem_read_global = %d\n", gpgpu_n_mem_read_global);
@@ -612,12 +782,17 @@ void shader_core_ctx::fetch()
                         register_cta_thread_exit(cta_id);
                         m_not_completed -= 1;
                         m_active_threads.reset(tid);
-                        assert( m_thread[tid]!= NULL );
+                        assert( trace_replay() || m_thread[tid]!= NULL );
                         did_exit=true;
                     }
                 }
-                if( did_exit ) 
+                if( did_exit ) {
                     m_warp[warp_id].set_done_exit();
+                    if( m_trace_file && !m_trace_file->replay() ) 
+                        m_trace_file->write_warp(m_warp_trace[warp_id]);
+                    if( m_trace_file ) 
+                        m_warp_trace[warp_id].clear();
+                }
             }
 
             // this code fetches instructions from the i-cache or generates memory requests
@@ -671,11 +846,113 @@ void shader_core_ctx::fetch()
 
 void shader_core_ctx::func_exec_inst( warp_inst_t &inst )
 {
-    execute_warp_inst_t(inst);
+    if( trace_replay() ) {
+        trace_replay_inst(inst);
+    } else {
+        active_mask_t issued = inst.get_active_mask();
+        execute_warp_inst_t(inst);
+        if( m_trace_file ) 
+            trace_capture_inst(inst,issued);
+    }
+    // the trace keeps local addresses untranslated as the mapping depends on the core configuration
+    if( inst.space.is_local() && (inst.is_load() || inst.is_store()) ) {
+        for( unsigned t=0; t < m_config->warp_size; t++ ) {
+            if( !inst.active(t) ) 
+                continue;
+            unsigned tid = inst.warp_id()*m_config->warp_size + t;
+            new_addr_type localaddrs[MAX_ACCESSES_PER_INSN_PER_THREAD];
+            unsigned num_addrs;
+            num_addrs = translate_local_memaddr(inst.get_addr(t), tid, m_config->n_simt_clusters*m_config->n_simt_cores_per_cluster,
+                   inst.data_size, (new_addr_type*) localaddrs );
+            inst.set_addr(t, (new_addr_type*) localaddrs, num_addrs);
+        }
+    }
     if( inst.is_load() || inst.is_store() )
         inst.generate_mem_accesses();
 }
 
+void shader_core_ctx::trace_init_cta( kernel_info_t &kernel, unsigned start_thread, unsigned end_thread )
+{
+    dim3 cta = kernel.get_next_cta_id();
+    dim3 grid = kernel.get_grid_dim();
+    unsigned cta_id = cta.x + grid.x*(cta.y + grid.y*cta.z);
+    unsigned start_warp = start_thread / m_config->warp_size;
+    unsigned end_warp = (end_thread + m_config->warp_size - 1) / m_config->warp_size;
+    for( unsigned w = start_warp; w < end_warp; w++ ) {
+        if( trace_replay() ) {
+            m_trace_file->read_warp(kernel.get_uid(),cta_id,w-start_warp,m_warp_trace[w]);
+        } else {
+            m_warp_trace[w].clear();
+            m_warp_trace[w].set_position(kernel.get_uid(),cta_id,w-start_warp);
+        }
+    }
+    if( trace_replay() ) {
+        for( unsigned t = start_thread; t < end_thread; t++ ) 
+            m_trace_thread_done[t] = false;
+    }
+}
+
+void shader_core_ctx::trace_capture_inst( const warp_inst_t &inst, const active_mask_t &issued )
+{
+    // the same thread state updateSIMTStack() is about to read
+    unsigned warp_id = inst.warp_id();
+    unsigned wtid = warp_id * m_config->warp_size;
+    simt_mask_t done;
+    addr_vector_t next_pc( m_config->warp_size, (address_type)-1 );
+    address_type rpc = inst.reconvergence_pc;
+    for( unsigned t=0; t < m_config->warp_size; t++ ) {
+        if( core_t::ptx_thread_done(wtid+t) ) {
+            done.set(t);
+        } else {
+            if( rpc == RECONVERGE_RETURN_PC ) 
+                rpc = get_return_pc(m_thread[wtid+t]);
+            next_pc[t] = m_thread[wtid+t]->get_pc();
+        }
+    }
+    m_warp_trace[warp_id].record(inst,issued,done,next_pc,rpc);
+}
+
+void shader_core_ctx::trace_replay_inst( warp_inst_t &inst )
+{
+    unsigned warp_id = inst.warp_id();
+    unsigned wtid = warp_id * m_config->warp_size;
+    active_mask_t issued = inst.get_active_mask();
+    warp_trace &trace = m_warp_trace[warp_id];
+    trace.replay(inst,issued);
+    bool exited = false;
+    for( unsigned t=0; t < m_config->warp_size; t++ ) {
+        if( trace.done().test(t) && !m_trace_thread_done[wtid+t] ) {
+            m_trace_thread_done[wtid+t] = true;
+            exited = true;
+        }
+    }
+    if( exited ) 
+        warp_exit(warp_id);
+    for( unsigned t=0; t < m_config->warp_size; t++ ) {
+        if( issued.test(t) ) 
+            checkExecutionStatusAndUpdate(inst,t,wtid+t);
+    }
+}
+
+bool shader_core_ctx::ptx_thread_done( unsigned hw_thread_id ) const
+{
+    if( trace_replay() ) 
+        return m_trace_thread_done[hw_thread_id];
+    return core_t::ptx_thread_done(hw_thread_id);
+}
+
+void shader_core_ctx::updateSIMTStack( unsigned warp_id, warp_inst_t *inst )
+{
+    if( !trace_replay() ) {
+        core_t::updateSIMTStack(warp_id,inst);
+        return;
+    }
+    warp_trace &trace = m_warp_trace[warp_id];
+    simt_mask_t done = trace.done();
+    inst->reconvergence_pc = trace.rpc();
+    m_simt_stack[warp_id]->update(done,trace.next_pc(),inst->reconvergence_pc,inst->op,inst->isize,inst->pc);
+}
+
 void shader_core_ctx::issue_warp( register_set& pipe_reg_set, const warp_inst_t* next_inst, const active_mask_t &active_mask, unsigned warp_id )
 {
     warp_inst_t** pipe_reg = pipe_reg_set.get_free();
@@ -686,7 +963,10 @@ void shader_core_ctx::issue_warp( register_set& pipe_reg_set, const warp_inst_t*
     **pipe_reg = *next_inst; // static instruction information
     (*pipe_reg)->issue( active_mask, warp_id, gpu_tot_sim_cycle + gpu_sim_cycle, m_warp[warp_id].get_dynamic_warp_id() ); // dynamic instruction information
     m_stats->shader_cycle_distro[2+(*pipe_reg)->active_count()]++;
-    func_exec_inst( **pipe_reg );
+    {
+        SIM_PROF_SCOPE(SIM_PROF_CORE_FUNC_EXEC);
+        func_exec_inst( **pipe_reg );
+    }
     if( next_inst->op == BARRIER_OP ){
     	m_warp[warp_id].store_info_of_last_inst_at_barrier(*pipe_reg);
         m_barriers.warp_reaches_barrier(m_warp[warp_id].get_cta_id(),warp_id,const_cast<warp_inst_t*> (next_inst));
@@ -839,6 +1119,7 @@ void scheduler_unit::cycle()
                     warp(warp_id).ibuffer_flush();
                 } else {
                     valid_inst = true;
+                    m_stats->gpgpu_n_scoreboard_check++;
                     if ( !m_scoreboard->checkCollision(warp_id, pI) ) {
                         SCHED_DPRINTF( "Warp (warp_id %u, dynamic_warp_id %u) passes scoreboard\n",
                                        (*iter)->get_warp_id(), (*iter)->get_dynamic_warp_id() );
@@ -916,6 +1197,43 @@ void scheduler_unit::cycle()
         m_stats->shader_cycle_distro[2]++; // pipeline stalled
 }
 
+bool scheduler_unit::idle( unsigned &distro )
+{
+    // same walk as cycle(), giving up at the first warp it would act on
+    bool valid_inst = false;
+    order_warps();
+    for ( std::vector< shd_warp_t* >::const_iterator iter = m_next_cycle_prioritized_warps.begin();
+          iter != m_next_cycle_prioritized_warps.end();
+          iter++ ) {
+        if ( (*iter) == NULL || (*iter)->done_exit() ) {
+            continue;
+        }
+        if ( m_shader->m_config->gpgpu_max_insn_issue_per_warp <= 0 ) 
+            break;
+        unsigned warp_id = (*iter)->get_warp_id();
+        // waiting() would release a memory barrier whose stores have drained
+        if( warp(warp_id).get_membar() && !m_scoreboard->pendingWrites(warp_id) ) 
+            return false;
+        if( warp(warp_id).waiting() || warp(warp_id).ibuffer_empty() ) 
+            continue;
+        const warp_inst_t *pI = warp(warp_id).ibuffer_next_inst();
+        bool valid = warp(warp_id).ibuffer_next_valid();
+        unsigned pc,rpc;
+        m_simt_stack[warp_id]->get_pdom_stack_top_info(&pc,&rpc);
+        if( pI ) {
+            if( pc != pI->pc ) 
+                return false; // control hazard flush
+            valid_inst = true;
+            if( !m_scoreboard->checkCollision(warp_id, pI) ) 
+                return false; // ready to issue
+        } else if( valid ) {
+            return false; // return from diverged warp flush
+        }
+    }
+    distro = valid_inst ? 1 : 0;
+    return true;
+}
+
 void scheduler_unit::do_on_warp_issued( unsigned warp_id,
                                         unsigned num_issued,
                                         const std::vector< shd_warp_t* >::const_iterator& prioritized_iter )
@@ -1225,14 +1543,18 @@ void shader_core_ctx::warp_inst_complete(const warp_inst_t &inst)
   inst.completed(gpu_tot_sim_cycle + gpu_sim_cycle);
 }
 
-void shader_core_ctx::writeback()
+void shader_core_ctx::update_pipeline_duty_cycle()
 {
-
 	unsigned max_committed_thread_instructions=m_config->warp_size * (m_config->pipe_widths[EX_WB]); //from the functional units
 	m_stats->m_pipeline_duty_cycle[m_sid]=((float)(m_stats->m_num_sim_insn[m_sid]-m_stats->m_last_num_sim_insn[m_sid]))/max_committed_thread_instructions;
 
     m_stats->m_last_num_sim_insn[m_sid]=m_stats->m_num_sim_insn[m_sid];
     m_stats->m_last_num_sim_winsn[m_sid]=m_stats->m_num_sim_winsn[m_sid];
+}
+
+void shader_core_ctx::writeback()
+{
+    update_pipeline_duty_cycle();
 
     warp_inst_t** preg = m_pipeline_reg[EX_WB].get_ready();
     warp_inst_t* pipe_reg = (preg==NULL)? NULL:*preg;
@@ -1446,6 +1768,34 @@ void ldst_unit::flush(){
 	m_L1D->flush();
 }
 
+void ldst_unit::save_caches( FILE *fp ) const
+{
+    m_L1T->save(fp);
+    m_L1C->save(fp);
+    if( m_L1D ) m_L1D->save(fp);
+}
+
+void ldst_unit::load_caches( FILE *fp )
+{
+    m_L1T->load(fp);
+    m_L1C->load(fp);
+    if( m_L1D ) m_L1D->load(fp);
+}
+
+void ldst_unit::warm_L1( new_addr_type addr, unsigned time, bool write, bool constant )
+{
+    if( constant ) 
+        m_L1C->warm(addr,time,write);
+    else if( m_L1D ) 
+        m_L1D->warm(addr,time,write);
+}
+
+void ldst_unit::warm_L1_done()
+{
+    m_L1C->warm_done();
+    if( m_L1D ) m_L1D->warm_done();
+}
+
 simd_function_unit::simd_function_unit( const shader_core_config *config )
 { 
     m_config=config;
@@ -1769,6 +2119,32 @@ unsigned ldst_unit::clock_multiplier() const
 { 
     return m_config->mem_warp_parts; 
 }
+
+bool ldst_unit::idle() const
+{
+    for( unsigned stage=0; stage < m_pipeline_depth; stage++ ) {
+        if( !m_pipeline_reg[stage]->empty() ) 
+            return false;
+    }
+    // shared_cycle() keeps counting bank conflict cycles of the last shared access
+    if( !m_dispatch_reg->empty() || 
+        (m_dispatch_reg->space.get_type() == shared_space && m_dispatch_reg->has_dispatch_delay()) ) 
+        return false;
+    if( m_mem_rc != NO_RC_FAIL ) 
+        return false;
+    if( !m_next_wb.empty() || m_next_global || !m_response_fifo.empty() ) 
+        return false;
+    if( !m_L1T->idle() || !m_L1C->idle() || (m_L1D && !m_L1D->idle()) ) 
+        return false;
+    return m_operand_collector->idle();
+}
+
+void ldst_unit::idle_cycle()
+{
+    m_operand_collector->idle_step();
+    m_L1C->idle_cycle();
+    if( m_L1D ) m_L1D->idle_cycle();
+}
 /*
 void ldst_unit::issue( register_set &reg_set )
 {
@@ -1794,6 +2170,7 @@ void ldst_unit::issue( register_set &reg_set )
 */
 void ldst_unit::cycle()
 {
+   SIM_PROF_SCOPE(SIM_PROF_CORE_LDST);
    writeback();
    m_operand_collector->step();
    for( unsigned stage=0; (stage+1)<m_pipeline_depth; stage++ ) 
@@ -1822,7 +2199,9 @@ void ldst_unit::cycle()
                assert( !mf->get_is_write() ); // L1 cache is write evict, allocate line on load miss only
 
                bool bypassL1D = false; 
-               if ( CACHE_GLOBAL == mf->get_inst().cache_op || (m_L1D == NULL) ) {
+               if ( m_L1D && m_L1D->waiting_for_fill(mf) ) {
+                   bypassL1D = false; // the L1D sent it (e.g. a prefetch) and holds an MSHR entry for it
+               } else if ( CACHE_GLOBAL == mf->get_inst().cache_op || (m_L1D == NULL) ) {
                    bypassL1D = true; 
                } else if (mf->get_access_type() == GLOBAL_ACC_R || mf->get_access_type() == GLOBAL_ACC_W) { // global memory access 
                    if (m_core->get_config()->gmem_skip_L1D)
@@ -2043,9 +2422,12 @@ void gpgpu_sim::shader_print_cache_stats( FILE *fout ) const{
         if(total_css.accesses > 0){
             fprintf(fout, "\tL1D_total_cache_miss_rate = %.4lf\n", (double)total_css.misses / (double)total_css.accesses);
         }
+        if(m_shader_config->m_L1D_config.is_sectored())
+            fprintf(fout, "\tL1D_total_cache_sector_misses = %u\n", total_css.sector_misses);
         fprintf(fout, "\tL1D_total_cache_pending_hits = %u\n", total_css.pending_hits);
         fprintf(fout, "\tL1D_total_cache_reservation_fails = %u\n", total_css.res_fails);
         total_css.print_port_stats(fout, "\tL1D_cache"); 
+        total_css.print_prefetch_stats(fout, "\tL1D_cache"); 
     }
 
     // L1C
@@ -2230,7 +2612,7 @@ void shader_core_ctx::display_simt_state(FILE *fout, int mask ) const
              unsigned tid = i*m_config->warp_size + j;
              int done = ptx_thread_done(tid);
              nactive += (ptx_thread_done(tid)?0:1);
-             if ( done && (mask & 8) ) {
+             if ( done && (mask & 8) && m_thread[tid] ) {
                 unsigned done_cycle = m_thread[tid]->donecycle();
                 if ( done_cycle ) {
                    printf("\n w%02u:t%03u: done @ cycle %u", i, tid, done_cycle );
@@ -2441,22 +2823,101 @@ unsigned int shader_core_config::max_cta( const kernel_info_t &k ) const
 
 void shader_core_ctx::cycle()
 {
+    if( m_idle ) {
+        idle_cycle();
+        return;
+    }
 	m_stats->shader_cycles[m_sid]++;
-    writeback();
-    execute();
-    read_operands();
-    issue();
-    decode();
-    fetch();
+    { SIM_PROF_SCOPE(SIM_PROF_CORE_WRITEBACK); writeback(); }
+    { SIM_PROF_SCOPE(SIM_PROF_CORE_EXECUTE); execute(); }
+    { SIM_PROF_SCOPE(SIM_PROF_CORE_READ_OPERANDS); read_operands(); }
+    { SIM_PROF_SCOPE(SIM_PROF_CORE_ISSUE); issue(); }
+    { SIM_PROF_SCOPE(SIM_PROF_CORE_DECODE); decode(); }
+    { SIM_PROF_SCOPE(SIM_PROF_CORE_FETCH); fetch(); }
+    if( m_config->gpgpu_core_idle_skip ) 
+        m_idle = idle();
+}
+
+// True when the next cycle() could not change anything but statistics: every
+// warp is blocked on the scoreboard, a barrier or an instruction cache miss and
+// nothing is in flight inside the core.  Only a response from the interconnect,
+// a new CTA or a cache flush can change that, and those clear m_idle.
+bool shader_core_ctx::idle()
+{
+    if( m_inst_fetch_buffer.m_valid ) 
+        return false;
+    for( unsigned i=0; i < N_PIPELINE_STAGES; i++ ) {
+        if( m_pipeline_reg[i].has_ready() ) 
+            return false;
+    }
+    for( unsigned i=0; i < num_result_bus; i++ ) {
+        if( m_result_bus[i]->any() ) 
+            return false;
+    }
+    for( unsigned n=0; n < m_num_function_units; n++ ) {
+        if( !m_fu[n]->idle() ) 
+            return false;
+    }
+    if( !m_L1I->idle() ) 
+        return false;
+    for( unsigned w=0; w < m_config->max_warps_per_shader; w++ ) {
+        if( m_warp[w].hardware_done() && !m_scoreboard->pendingWrites(w) && !m_warp[w].done_exit() ) 
+            return false; // fetch() would reclaim it
+        if( !m_warp[w].functional_done() && !m_warp[w].imiss_pending() && m_warp[w].ibuffer_empty() ) 
+            return false; // fetch() would access the instruction cache
+    }
+    for( unsigned i=0; i < schedulers.size(); i++ ) {
+        if( !schedulers[i]->idle(m_idle_sched_distro[i]) ) 
+            return false;
+    }
+    return true;
+}
+
+// Statistics cycle() records while idle() holds
+void shader_core_ctx::idle_cycle()
+{
+    m_stats->shader_cycles[m_sid]++;
+    update_pipeline_duty_cycle();
+    for( unsigned n=0; n < m_num_function_units; n++ ) {
+        unsigned multiplier = m_fu[n]->clock_multiplier();
+        for( unsigned c=0; c < multiplier; c++ ) 
+            m_fu[n]->idle_cycle();
+    }
+    for( unsigned i=0; i < schedulers.size(); i++ ) 
+        m_stats->shader_cycle_distro[m_idle_sched_distro[i]]++;
+    m_L1I->idle_cycle();
 }
 
 // Flushes all content of the cache to memory
 
 void shader_core_ctx::cache_flush()
 {
+   m_idle = false;
    m_ldst_unit->flush();
 }
 
+void shader_core_ctx::save_caches( FILE *fp ) const
+{
+   m_L1I->save(fp);
+   m_ldst_unit->save_caches(fp);
+}
+
+void shader_core_ctx::load_caches( FILE *fp )
+{
+   m_L1I->load(fp);
+   m_ldst_unit->load_caches(fp);
+}
+
+void shader_core_ctx::warm_L1( new_addr_type addr, unsigned time, bool write, bool constant )
+{
+   m_ldst_unit->warm_L1(addr,time,write,constant);
+}
+
+void shader_core_ctx::warm_L1_done()
+{
+   m_ldst_unit->warm_L1_done();
+}
+
 // modifiers
 std::list<opndcoll_rfu_t::op_t> opndcoll_rfu_t::arbiter_t::allocate_reads() 
 {
@@ -2716,7 +3177,7 @@ void shader_core_ctx::warp_exit( unsigned warp_id )
 //		}
 
 
-		if (m_thread[i] && !m_thread[i]->is_done()) done = false;
+		if (!ptx_thread_done(i)) done = false;
 	}
 	//if (m_warp[warp_id].get_n_completed() == get_config()->warp_size)
 	//if (this->m_simt_stack[warp_id]->get_num_entries() == 0)
@@ -2785,6 +3246,7 @@ bool shader_core_ctx::fetch_unit_response_buffer_full() const
 
 void shader_core_ctx::accept_fetch_response( mem_fetch *mf )
 {
+    m_idle = false;
     mf->set_status(IN_SHADER_FETCHED,gpu_sim_cycle+gpu_tot_sim_cycle);
     m_L1I->fill(mf,gpu_sim_cycle+gpu_tot_sim_cycle);
 }
@@ -2796,6 +3258,7 @@ bool shader_core_ctx::ldst_unit_response_buffer_full() const
 
 void shader_core_ctx::accept_ldst_unit_response(mem_fetch * mf) 
 {
+   m_idle = false;
    m_ldst_unit->fill(mf);
 }
 
@@ -3256,6 +3719,29 @@ void simt_core_cluster::cache_flush()
         m_core[i]->cache_flush();
 }
 
+void simt_core_cluster::save_caches( FILE *fp ) const
+{
+    for( unsigned i=0; i < m_config->n_simt_cores_per_cluster; i++ ) 
+        m_core[i]->save_caches(fp);
+}
+
+void simt_core_cluster::load_caches( FILE *fp )
+{
+    for( unsigned i=0; i < m_config->n_simt_cores_per_cluster; i++ ) 
+        m_core[i]->load_caches(fp);
+}
+
+void simt_core_cluster::warm_L1( unsigned cid, new_addr_type addr, unsigned time, bool write, bool constant )
+{
+    m_core[cid]->warm_L1(addr,time,write,constant);
+}
+
+void simt_core_cluster::warm_L1_done()
+{
+    for( unsigned i=0; i < m_config->n_simt_cores_per_cluster; i++ ) 
+        m_core[i]->warm_L1_done();
+}
+
 bool simt_core_cluster::icnt_injection_buffer_full(unsigned size, bool write)
 {
     unsigned request_size = size;
@@ -3433,13 +3919,6 @@ void shader_core_ctx::checkExecutionStatusAndUpdate(warp_inst_t &inst, unsigned
 {
     if(inst.isatomic())
            m_warp[inst.warp_id()].inc_n_atomic();
-        if (inst.space.is_local() && (inst.is_load() || inst.is_store())) {
-            new_addr_type localaddrs[MAX_ACCESSES_PER_INSN_PER_THREAD];
-            unsigned num_addrs;
-            num_addrs = translate_local_memaddr(inst.get_addr(t), tid, m_config->n_simt_clusters*m_config->n_simt_cores_per_cluster,
-                   inst.data_size, (new_addr_type*) localaddrs );
-            inst.set_addr(t, (new_addr_type*) localaddrs, num_addrs);
-        }
         if ( ptx_thread_done(tid) ) {
             m_warp[inst.warp_id()].set_completed(t);
             m_warp[inst.warp_id()].ibuffer_flush();
@@ -53,6 +53,7 @@
 #include "stats.h"
 #include "gpu-cache.h"
 #include "traffic_breakdown.h"
+#include "warp_trace.h"
 
 
 
@@ -323,6 +324,9 @@ public:
     // all the derived schedulers.  The scheduler's behaviour can be
     // modified by changing the contents of the m_next_cycle_prioritized_warps list.
     void cycle();
+    // True if cycle() would issue nothing and leave every warp untouched;
+    // distro is the shader_cycle_distro bucket cycle() would count.
+    virtual bool idle( unsigned &distro );
 
     // These are some common ordering fucntions that the
     // higher order schedulers can take advantage of
@@ -449,6 +453,9 @@ public:
     }
 	virtual ~two_level_active_scheduler () {}
     virtual void order_warps();
+    // order_warps() moves warps between the active and pending sets, so a
+    // cycle of this scheduler is never free of side effects
+    virtual bool idle( unsigned &distro ) { return false; }
 	void add_supervised_warp_id(int i) {
         if ( m_next_cycle_prioritized_warps.size() < m_max_active_warps ) {
             m_next_cycle_prioritized_warps.push_back( &warp(i) );
@@ -536,6 +543,17 @@ public:
 
    shader_core_ctx *shader_core() { return m_shader; }
 
+   // true when step() would only advance the read arbiter (see idle_step())
+   bool idle() const
+   {
+      for( unsigned n=0; n < m_cu.size(); n++ ) {
+         if( !m_cu[n]->is_free() ) 
+            return false;
+      }
+      return m_arbiter.idle();
+   }
+   void idle_step() { m_arbiter.idle_step(); }
+
 private:
 
    void process_banks()
@@ -746,6 +764,20 @@ private:
          for( unsigned b=0; b < m_num_banks; b++ ) 
             m_allocated_bank[b].reset();
       }
+      bool idle() const
+      {
+         for( unsigned b=0; b < m_num_banks; b++ ) {
+            if( !m_queue[b].empty() || !m_allocated_bank[b].is_free() ) 
+               return false;
+         }
+         return true;
+      }
+      // allocate_reads() with no requests only rotates the priority diagonal
+      void idle_step()
+      {
+         unsigned square = ( m_num_banks > m_num_collectors ) ? m_num_banks : m_num_collectors;
+         m_last_cu = ( m_last_cu + 1 ) % square;
+      }
 
    private:
       unsigned m_num_banks;
@@ -819,7 +851,7 @@ private:
     	  return m_warp->get_num_regs();
       }
       void dispatch();
-      bool is_free(){return m_free;}
+      bool is_free() const {return m_free;}
 
    private:
       bool m_free;
@@ -970,6 +1002,9 @@ public:
     virtual unsigned clock_multiplier() const { return 1; }
     virtual bool can_issue( const warp_inst_t &inst ) const { return m_dispatch_reg->empty() && !occupied.test(inst.latency); }
     virtual bool stallable() const = 0;
+    // idle() is true when cycle() would only have the side effects replayed by idle_cycle()
+    virtual bool idle() const { return m_dispatch_reg->empty() && occupied.none(); }
+    virtual void idle_cycle() {}
     virtual void print( FILE *fp ) const
     {
         fprintf(fp,"%s dispatch= ", m_name.c_str() );
@@ -1015,6 +1050,14 @@ public:
     {
         return simd_function_unit::can_issue(inst);
     }
+    virtual bool idle() const
+    {
+        for( unsigned stage=0; stage < m_pipeline_depth; stage++ ) {
+            if( !m_pipeline_reg[stage]->empty() ) 
+                return false;
+        }
+        return simd_function_unit::idle();
+    }
     virtual void print(FILE *fp) const
     {
         simd_function_unit::print(fp);
@@ -1092,6 +1135,10 @@ public:
     void fill( mem_fetch *mf );
     void flush();
     void writeback();
+    void save_caches( FILE *fp ) const;
+    void load_caches( FILE *fp );
+    void warm_L1( new_addr_type addr, unsigned time, bool write, bool constant );
+    void warm_L1_done();
 
     // accessors
     virtual unsigned clock_multiplier() const;
@@ -1109,6 +1156,8 @@ public:
 
     virtual void active_lanes_in_pipeline();
     virtual bool stallable() const { return true; }
+    virtual bool idle() const;
+    virtual void idle_cycle();
     bool response_buffer_full() const;
     void print(FILE *fout) const;
     void print_cache_stats( FILE *fp, unsigned& dl1_accesses, unsigned& dl1_misses );
@@ -1249,6 +1298,10 @@ struct shader_core_config : public core_config
         m_L1T_config.init(m_L1T_config.m_config_string,FuncCachePreferNone);
         m_L1C_config.init(m_L1C_config.m_config_string,FuncCachePreferNone);
         m_L1D_config.init(m_L1D_config.m_config_string,FuncCachePreferNone);
+        if (m_L1I_config.is_sectored() || m_L1T_config.is_sectored() || m_L1C_config.is_sectored()) {
+           printf("GPGPU-Sim uArch: ERROR ** only the data caches (L1D, L2) can be sectored\n");
+           exit(1);
+        }
         gpgpu_cache_texl1_linesize = m_L1T_config.get_line_sz();
         gpgpu_cache_constl1_linesize = m_L1C_config.get_line_sz();
         m_valid = true;
@@ -1325,6 +1378,7 @@ struct shader_core_config : public core_config
     unsigned ldst_unit_response_queue_size;
 
     int simt_core_sim_order; 
+    bool gpgpu_core_idle_skip;
     
     unsigned mem2device(unsigned memid) const { return memid + n_simt_clusters; }
 };
@@ -1385,6 +1439,7 @@ struct shader_core_stats_pod {
     unsigned *last_shader_cycle_distro;
     unsigned *num_warps_issuable;
     unsigned gpgpu_n_stall_shd_mem;
+    unsigned long long gpgpu_n_scoreboard_check; // scheduler scoreboard collision checks
 
     //memory access classification
     int gpgpu_n_mem_read_local;
@@ -1486,6 +1541,9 @@ public:
     void visualizer_print( gzFile visualizer_file );
 
     void print( FILE *fout ) const;
+    void reg_stats( class stat_registry &reg ) const;
+    // save (or restore) every counter to a kernel boundary checkpoint
+    void checkpoint_io( FILE *fp, bool save );
 
     const std::vector< std::vector<unsigned> >& get_dynamic_warp_issue() const
     {
@@ -1575,6 +1633,10 @@ public:
     void reinit(unsigned start_thread, unsigned end_thread, bool reset_not_completed );
     void issue_block2core( class kernel_info_t &kernel );
     void cache_flush();
+    void save_caches( FILE *fp ) const;
+    void load_caches( FILE *fp );
+    void warm_L1( new_addr_type addr, unsigned time, bool write, bool constant );
+    void warm_L1_done();
     void accept_fetch_response( mem_fetch *mf );
     void accept_ldst_unit_response( class mem_fetch * mf );
     void broadcast_barrier_reduction(unsigned cta_id, unsigned bar_id,warp_set_t warps);
@@ -1599,6 +1661,9 @@ public:
 // used by functional simulation:
     // modifiers
     virtual void warp_exit( unsigned warp_id );
+    // take the thread state from the warp trace instead of the PTX threads when replaying
+    virtual bool ptx_thread_done( unsigned hw_thread_id ) const;
+    virtual void updateSIMTStack( unsigned warp_id, warp_inst_t *inst );
     
     // accessors
     virtual bool warp_waiting_at_barrier( unsigned warp_id ) const;
@@ -1759,6 +1824,10 @@ public:
     friend class LooseRoundRobbinScheduler;
     void issue_warp( register_set& warp, const warp_inst_t *pI, const active_mask_t &active_mask, unsigned warp_id );
     void func_exec_inst( warp_inst_t &inst );
+    bool trace_replay() const { return m_trace_file && m_trace_file->replay(); }
+    void trace_init_cta( kernel_info_t &kernel, unsigned start_thread, unsigned end_thread );
+    void trace_capture_inst( const warp_inst_t &inst, const active_mask_t &issued );
+    void trace_replay_inst( warp_inst_t &inst );
 
      // Returns numbers of addresses in translated_addrs
     unsigned translate_local_memaddr( address_type localaddr, unsigned tid, unsigned num_shader, unsigned datasize, new_addr_type* translated_addrs );
@@ -1768,6 +1837,10 @@ public:
     void execute();
     
     void writeback();
+    void update_pipeline_duty_cycle();
+
+    bool idle();
+    void idle_cycle();
     
     // used in display_pipeline():
     void dump_warp_state( FILE *fout ) const;
@@ -1823,6 +1896,16 @@ public:
     unsigned num_result_bus;
     std::vector< std::bitset<MAX_ALU_LATENCY>* > m_result_bus;
 
+    // idle skipping (-gpgpu_core_idle_skip): once idle() holds, cycle() only 
+    // replays idle_cycle() until a response, a new CTA or a flush wakes the core
+    bool m_idle;
+    std::vector<unsigned> m_idle_sched_distro; // stall bucket each scheduler counts while idle
+
+    // trace driven simulation, NULL unless -warp_trace_capture/-warp_trace_replay is set
+    warp_trace_file *m_trace_file;
+    std::vector<warp_trace> m_warp_trace; // instruction stream of each hardware warp
+    std::vector<bool> m_trace_thread_done; // replay: hardware threads that exited
+
     // used for local address mapping with single kernel launch
     unsigned kernel_max_cta_per_shader;
     unsigned kernel_padded_threads_per_cta;
@@ -1848,6 +1931,10 @@ public:
     void reinit();
     unsigned issue_block2core();
     void cache_flush();
+    void save_caches( FILE *fp ) const;
+    void load_caches( FILE *fp );
+    void warm_L1( unsigned cid, new_addr_type addr, unsigned time, bool write, bool constant );
+    void warm_L1_done();
     bool icnt_injection_buffer_full(unsigned size, bool write);
     void icnt_inject_request_packet(class mem_fetch *mf);
 
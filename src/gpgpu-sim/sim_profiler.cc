@@ -0,0 +1,150 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "sim_profiler.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define SIM_PROF_MAX_DEPTH 16
+
+bool g_sim_prof_enabled = false;
+
+static const char *sim_prof_zone_name[SIM_PROF_NUM_ZONES] = {
+   "cycle (other)",
+   "core fetch",
+   "core decode",
+   "core issue",
+   "core functional exec",
+   "core read_operands",
+   "core execute",
+   "core ldst_unit",
+   "core writeback",
+   "L2 cache_cycle",
+   "dram_cycle",
+   "icnt_transfer",
+   "mcpat_cycle"
+};
+
+static unsigned long long sim_prof_ticks[SIM_PROF_NUM_ZONES];
+static unsigned long long sim_prof_calls[SIM_PROF_NUM_ZONES];
+static enum sim_prof_zone sim_prof_stack[SIM_PROF_MAX_DEPTH];
+static unsigned sim_prof_depth;
+static unsigned long long sim_prof_last;
+
+// tick counts and wall clock when the profiler was enabled, used to convert
+// ticks to seconds without assuming a fixed TSC frequency
+static unsigned long long sim_prof_start_ticks;
+static unsigned long long sim_prof_start_ns;
+
+static unsigned long long sim_prof_wall_ns()
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline unsigned long long sim_prof_now()
+{
+#if defined(__x86_64__) || defined(__i386__)
+   unsigned lo, hi;
+   __asm__ __volatile__ ("rdtsc" : "=a"(lo), "=d"(hi));
+   return ((unsigned long long)hi << 32) | lo;
+#else
+   return sim_prof_wall_ns();
+#endif
+}
+
+static void sim_prof_atexit()
+{
+   sim_prof_print(stdout);
+   fflush(stdout);
+}
+
+void sim_prof_enable()
+{
+   if( g_sim_prof_enabled ) 
+      return;
+   for( unsigned z=0; z < SIM_PROF_NUM_ZONES; z++ ) {
+      sim_prof_ticks[z] = 0;
+      sim_prof_calls[z] = 0;
+   }
+   sim_prof_depth = 0;
+   sim_prof_start_ns = sim_prof_wall_ns();
+   sim_prof_start_ticks = sim_prof_now();
+   sim_prof_last = sim_prof_start_ticks;
+   g_sim_prof_enabled = true;
+   atexit(sim_prof_atexit);
+}
+
+void sim_prof_enter( enum sim_prof_zone zone )
+{
+   unsigned long long now = sim_prof_now();
+   if( sim_prof_depth ) 
+      sim_prof_ticks[sim_prof_stack[sim_prof_depth-1]] += now - sim_prof_last;
+   assert( sim_prof_depth < SIM_PROF_MAX_DEPTH );
+   sim_prof_stack[sim_prof_depth++] = zone;
+   sim_prof_calls[zone]++;
+   sim_prof_last = now;
+}
+
+void sim_prof_exit()
+{
+   unsigned long long now = sim_prof_now();
+   assert( sim_prof_depth > 0 );
+   sim_prof_ticks[sim_prof_stack[--sim_prof_depth]] += now - sim_prof_last;
+   sim_prof_last = now;
+}
+
+void sim_prof_print( FILE *fout )
+{
+   if( !g_sim_prof_enabled ) 
+      return;
+   unsigned long long wall_ns = sim_prof_wall_ns() - sim_prof_start_ns;
+   unsigned long long ticks = sim_prof_now() - sim_prof_start_ticks;
+   double sec_per_tick = (ticks && wall_ns)? (wall_ns * 1e-9) / ticks : 1e-9;
+   double wall = wall_ns * 1e-9;
+
+   unsigned long long in_cycle = 0;
+   for( unsigned z=0; z < SIM_PROF_NUM_ZONES; z++ ) 
+      in_cycle += sim_prof_ticks[z];
+
+   fprintf(fout, "\nGPGPU-Sim: self profile (host time, exclusive of nested zones)\n");
+   fprintf(fout, "%-24s %12s %7s %14s %10s\n", "zone", "seconds", "%", "calls", "ns/call");
+   for( unsigned z=0; z < SIM_PROF_NUM_ZONES; z++ ) {
+      double t = sim_prof_ticks[z] * sec_per_tick;
+      fprintf(fout, "%-24s %12.3f %6.2f%% %14llu %10.1f\n", sim_prof_zone_name[z], t, 
+              wall? 100.0 * t / wall : 0.0, sim_prof_calls[z], 
+              sim_prof_calls[z]? t * 1e9 / sim_prof_calls[z] : 0.0);
+   }
+   double t_cycle = in_cycle * sec_per_tick;
+   double t_outside = (wall > t_cycle)? wall - t_cycle : 0.0;
+   fprintf(fout, "%-24s %12.3f %6.2f%%\n", "outside cycle()", t_outside, wall? 100.0 * t_outside / wall : 0.0);
+   fprintf(fout, "%-24s %12.3f\n", "total", wall);
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef SIM_PROFILER_H
+#define SIM_PROFILER_H
+
+#include <stdio.h>
+
+// Host-time profiler of the simulator itself (-gpgpu_self_profile). Scoped 
+// zones around the per-cycle work of the performance model accumulate the 
+// host CPU ticks spent in each subsystem; the breakdown is printed when the 
+// process exits. Zones nest and the accounting is exclusive: time spent in 
+// an inner zone (e.g. the LD/ST unit inside the execute stage) is charged to 
+// the inner zone only. Time inside gpgpu_sim::cycle() not covered by any 
+// other zone is charged to SIM_PROF_CYCLE_OTHER.
+//
+// When the profiler is off a zone costs one load and a predictable branch 
+// on entry and exit. Zones must only be entered from the simulation thread; 
+// work handed to sim_thread_pool is timed around the parallel_for.
+
+enum sim_prof_zone {
+   SIM_PROF_CYCLE_OTHER = 0,
+   SIM_PROF_CORE_FETCH,
+   SIM_PROF_CORE_DECODE,
+   SIM_PROF_CORE_ISSUE,
+   SIM_PROF_CORE_FUNC_EXEC,
+   SIM_PROF_CORE_READ_OPERANDS,
+   SIM_PROF_CORE_EXECUTE,
+   SIM_PROF_CORE_LDST,
+   SIM_PROF_CORE_WRITEBACK,
+   SIM_PROF_L2_CACHE,
+   SIM_PROF_DRAM,
+   SIM_PROF_ICNT,
+   SIM_PROF_POWER,
+   SIM_PROF_NUM_ZONES
+};
+
+extern bool g_sim_prof_enabled;
+
+// starts the profiler and prints the report at process exit
+void sim_prof_enable();
+void sim_prof_enter( enum sim_prof_zone zone );
+void sim_prof_exit();
+void sim_prof_print( FILE *fout );
+
+class sim_prof_scope {
+public:
+   sim_prof_scope( enum sim_prof_zone zone ) 
+   { 
+      m_active = g_sim_prof_enabled; 
+      if( m_active ) 
+         sim_prof_enter(zone); 
+   }
+   ~sim_prof_scope() 
+   { 
+      if( m_active ) 
+         sim_prof_exit(); 
+   }
+private:
+   bool m_active; // the profiler may be enabled while the zone is open
+};
+
+#define SIM_PROF_SCOPE(zone) sim_prof_scope sim_prof_scope_guard(zone)
+
+#endif
@@ -0,0 +1,250 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "stat_registry.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define STAT_DUMP_MAGIC   0x54535047 // "GPST"
+#define STAT_DUMP_VERSION 1
+
+stat_registry::stat_registry( const char *filename, enum stat_dump_format format )
+{
+   m_filename = filename;
+   m_format = format;
+   m_records = 0;
+   m_file = fopen(filename, (format == STAT_DUMP_BINARY)? "wb" : "w");
+   if( m_file == NULL ) {
+      printf("GPGPU-Sim uArch: ERROR ** could not open statistics dump file %s\n", filename);
+      exit(1);
+   }
+}
+
+stat_registry::~stat_registry()
+{
+   fclose(m_file);
+}
+
+void stat_registry::add( const std::string &name, enum stat_type type, const void *ptr, unsigned n )
+{
+   if( find(name) ) {
+      printf("GPGPU-Sim uArch: ERROR ** statistic %s registered twice\n", name.c_str());
+      exit(1);
+   }
+   stat_part part;
+   part.ptr = ptr;
+   part.n = n;
+   stat_entry e;
+   e.name = name;
+   e.type = type;
+   e.parts.push_back(part);
+   e.n = n;
+   m_stats.push_back(e);
+}
+
+void stat_registry::reg_unit( const std::string &name, unsigned unit, const unsigned *p, unsigned n )
+{
+   stat_entry *e = find(name);
+   if( e == NULL && unit == 0 ) {
+      add(name,STAT_U32,p,n);
+      return;
+   }
+   if( e == NULL || e->type != STAT_U32 || e->parts.size() != unit ) {
+      printf("GPGPU-Sim uArch: ERROR ** statistic %s registered out of order for unit %u\n", name.c_str(), unit);
+      exit(1);
+   }
+   stat_part part;
+   part.ptr = p;
+   part.n = n;
+   e->parts.push_back(part);
+   e->n += n;
+}
+
+stat_registry::stat_entry *stat_registry::find( const std::string &name )
+{
+   if( m_records ) {
+      printf("GPGPU-Sim uArch: ERROR ** statistic %s registered after the first record of %s\n", 
+             name.c_str(), m_filename.c_str());
+      exit(1);
+   }
+   for( unsigned i=0; i < m_stats.size(); i++ ) {
+      if( m_stats[i].name == name ) 
+         return &m_stats[i];
+   }
+   return NULL;
+}
+
+std::string stat_registry::indexed( const char *base, unsigned i )
+{
+   char buf[16];
+   snprintf(buf,sizeof(buf),"[%u]",i);
+   return base + std::string(buf);
+}
+
+char stat_registry::column_type( enum stat_type type )
+{
+   switch( type ) {
+   case STAT_U32: case STAT_U64: return 'u';
+   case STAT_I32: case STAT_LONG: case STAT_I64: return 'i';
+   case STAT_FLOAT: case STAT_DOUBLE: return 'f';
+   }
+   abort();
+}
+
+void stat_registry::put_string( const std::string &s )
+{
+   unsigned short len = s.size() < 0xffff? s.size() : 0xffff;
+   put(&len,sizeof(len));
+   put(s.data(),len);
+}
+
+void stat_registry::flush()
+{
+   if( !m_buffer.empty() && fwrite(&m_buffer[0],1,m_buffer.size(),m_file) != m_buffer.size() ) {
+      printf("GPGPU-Sim uArch: ERROR ** write to statistics dump file %s failed\n", m_filename.c_str());
+      exit(1);
+   }
+   fflush(m_file);
+   m_buffer.clear();
+}
+
+void stat_registry::write_header()
+{
+   unsigned magic = STAT_DUMP_MAGIC;
+   unsigned version = STAT_DUMP_VERSION;
+   unsigned n_stats = m_stats.size();
+   put(&magic,sizeof(magic));
+   put(&version,sizeof(version));
+   put(&n_stats,sizeof(n_stats));
+   for( unsigned i=0; i < m_stats.size(); i++ ) {
+      char type = column_type(m_stats[i].type);
+      put(&type,sizeof(type));
+      put(&m_stats[i].n,sizeof(m_stats[i].n));
+      put_string(m_stats[i].name);
+   }
+}
+
+void stat_registry::write( enum stat_record_kind kind, unsigned long long cycle, const std::string &label )
+{
+   if( m_format == STAT_DUMP_BINARY ) {
+      if( m_records == 0 ) 
+         write_header();
+      write_binary(kind,cycle,label);
+   } else {
+      write_json(kind,cycle,label);
+   }
+   flush();
+   m_records++;
+}
+
+void stat_registry::write_binary( enum stat_record_kind kind, unsigned long long cycle, const std::string &label )
+{
+   char k = kind;
+   put(&k,sizeof(k));
+   put(&cycle,sizeof(cycle));
+   put_string(label);
+   for( unsigned i=0; i < m_stats.size(); i++ ) {
+      const stat_entry &e = m_stats[i];
+      for( unsigned k=0; k < e.parts.size(); k++ ) {
+         const void *ptr = e.parts[k].ptr;
+         for( unsigned j=0; j < e.parts[k].n; j++ ) {
+            unsigned long long u = 0;
+            long long s = 0;
+            double d = 0;
+            switch( e.type ) {
+            case STAT_U32:    u = ((const unsigned*)ptr)[j]; put(&u,sizeof(u)); break;
+            case STAT_U64:    u = ((const unsigned long long*)ptr)[j]; put(&u,sizeof(u)); break;
+            case STAT_I32:    s = ((const int*)ptr)[j]; put(&s,sizeof(s)); break;
+            case STAT_LONG:   s = ((const long*)ptr)[j]; put(&s,sizeof(s)); break;
+            case STAT_I64:    s = ((const long long*)ptr)[j]; put(&s,sizeof(s)); break;
+            case STAT_FLOAT:  d = ((const float*)ptr)[j]; put(&d,sizeof(d)); break;
+            case STAT_DOUBLE: d = ((const double*)ptr)[j]; put(&d,sizeof(d)); break;
+            }
+         }
+      }
+   }
+}
+
+void stat_registry::write_json( enum stat_record_kind kind, unsigned long long cycle, const std::string &label )
+{
+   char buf[64];
+   std::string out = (kind == STAT_RECORD_KERNEL)? "{\"kind\":\"kernel\"" : "{\"kind\":\"sample\"";
+   snprintf(buf,sizeof(buf),",\"cycle\":%llu,\"label\":\"",cycle);
+   out += buf;
+   for( unsigned i=0; i < label.size(); i++ ) {
+      unsigned char c = label[i];
+      if( c == '"' || c == '\\' ) {
+         out += '\\';
+         out += c;
+      } else if( c < 0x20 ) {
+         snprintf(buf,sizeof(buf),"\\u%04x",c);
+         out += buf;
+      } else {
+         out += c;
+      }
+   }
+   out += "\",\"stats\":{";
+   for( unsigned i=0; i < m_stats.size(); i++ ) {
+      const stat_entry &e = m_stats[i];
+      if( i ) 
+         out += ',';
+      out += '"' + e.name + "\":";
+      if( e.n != 1 ) 
+         out += '[';
+      for( unsigned k=0; k < e.parts.size(); k++ ) {
+         const void *ptr = e.parts[k].ptr;
+         for( unsigned j=0; j < e.parts[k].n; j++ ) {
+            double d = 0;
+            if( k || j ) 
+               out += ',';
+            switch( e.type ) {
+            case STAT_U32:    snprintf(buf,sizeof(buf),"%u",((const unsigned*)ptr)[j]); break;
+            case STAT_U64:    snprintf(buf,sizeof(buf),"%llu",((const unsigned long long*)ptr)[j]); break;
+            case STAT_I32:    snprintf(buf,sizeof(buf),"%d",((const int*)ptr)[j]); break;
+            case STAT_LONG:   snprintf(buf,sizeof(buf),"%ld",((const long*)ptr)[j]); break;
+            case STAT_I64:    snprintf(buf,sizeof(buf),"%lld",((const long long*)ptr)[j]); break;
+            case STAT_FLOAT:  d = ((const float*)ptr)[j]; break;
+            case STAT_DOUBLE: d = ((const double*)ptr)[j]; break;
+            }
+            if( e.type == STAT_FLOAT || e.type == STAT_DOUBLE ) {
+               if( isfinite(d) ) 
+                  snprintf(buf,sizeof(buf),"%.17g",d);
+               else 
+                  snprintf(buf,sizeof(buf),"null"); // JSON has no inf or nan
+            }
+            out += buf;
+         }
+      }
+      if( e.n != 1 ) 
+         out += ']';
+   }
+   out += "}}\n";
+   put(out.data(),out.size());
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef STAT_REGISTRY_H
+#define STAT_REGISTRY_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Machine readable statistics (-gpgpu_stat_dump). Every counter is registered 
+// once, by name, with a pointer to where the simulator keeps it; the registry 
+// reads all of them whenever a record is written: at the end of each kernel 
+// and, with -gpgpu_stat_dump_interval, every n cycles while kernels run.
+//
+// The binary format (host byte order, like checkpoints) is
+//    header:  "GPST" <version u32> <number of stats u32>
+//             per stat: <type u8: 'u', 'i' or 'f'> <length u32> <name>
+//    record:  <kind u8: 'K' kernel end, 'S' sample> <cycle u64> <label> 
+//             then 8 bytes per value (u64, i64 or double) in header order
+// where strings are <length u16> followed by the characters. Per unit 
+// counters (one per core, bank, ...) are a single stat of length > 1. The 
+// JSON format writes one object per record and line.
+
+enum stat_dump_format {
+   STAT_DUMP_BINARY,
+   STAT_DUMP_JSON
+};
+
+enum stat_record_kind {
+   STAT_RECORD_KERNEL = 'K',
+   STAT_RECORD_SAMPLE = 'S'
+};
+
+class stat_registry {
+public:
+   stat_registry( const char *filename, enum stat_dump_format format );
+   ~stat_registry();
+
+   // p points to n consecutive values; registration ends with the first record
+   void reg( const std::string &name, const unsigned *p, unsigned n = 1 ) { add(name,STAT_U32,p,n); }
+   void reg( const std::string &name, const int *p, unsigned n = 1 ) { add(name,STAT_I32,p,n); }
+   void reg( const std::string &name, const long *p, unsigned n = 1 ) { add(name,STAT_LONG,p,n); }
+   void reg( const std::string &name, const unsigned long long *p, unsigned n = 1 ) { add(name,STAT_U64,p,n); }
+   void reg( const std::string &name, const long long *p, unsigned n = 1 ) { add(name,STAT_I64,p,n); }
+   void reg( const std::string &name, const float *p, unsigned n = 1 ) { add(name,STAT_FLOAT,p,n); }
+   void reg( const std::string &name, const double *p, unsigned n = 1 ) { add(name,STAT_DOUBLE,p,n); }
+
+   // appends the n values at p to the per unit stat name, for units that keep 
+   // their counters in their own objects; units register in order 0, 1, ...
+   void reg_unit( const std::string &name, unsigned unit, const unsigned *p, unsigned n = 1 );
+
+   // "<base>[i]", for per unit arrays (one stat per unit)
+   static std::string indexed( const char *base, unsigned i );
+
+   // label says which kernels the record covers
+   void write( enum stat_record_kind kind, unsigned long long cycle, const std::string &label );
+
+   unsigned num_stats() const { return m_stats.size(); }
+   unsigned num_records() const { return m_records; }
+
+private:
+   enum stat_type {
+      STAT_U32,
+      STAT_I32,
+      STAT_LONG,
+      STAT_U64,
+      STAT_I64,
+      STAT_FLOAT,
+      STAT_DOUBLE
+   };
+   struct stat_part {
+      const void *ptr;
+      unsigned n;
+   };
+   struct stat_entry {
+      std::string name;
+      enum stat_type type;
+      std::vector<stat_part> parts; // one per unit for reg_unit()
+      unsigned n;
+   };
+
+   void add( const std::string &name, enum stat_type type, const void *ptr, unsigned n );
+   stat_entry *find( const std::string &name );
+   static char column_type( enum stat_type type );
+   void write_header();
+   void write_binary( enum stat_record_kind kind, unsigned long long cycle, const std::string &label );
+   void write_json( enum stat_record_kind kind, unsigned long long cycle, const std::string &label );
+   void put( const void *data, unsigned len ) { m_buffer.insert(m_buffer.end(),(const char*)data,(const char*)data+len); }
+   void put_string( const std::string &s );
+   void flush();
+
+   std::string m_filename;
+   enum stat_dump_format m_format;
+   FILE *m_file;
+   std::vector<stat_entry> m_stats;
+   std::vector<char> m_buffer; // one record, written with a single fwrite
+   unsigned m_records;
+};
+
+#endif
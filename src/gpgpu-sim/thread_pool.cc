@@ -0,0 +1,125 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "thread_pool.h"
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+// number of polls of the generation counter before a waiting thread
+// starts giving up its host CPU
+#define SIM_THREAD_POOL_SPIN_LIMIT 4096
+
+sim_thread_pool::sim_thread_pool( unsigned n_threads )
+{
+   assert( n_threads > 0 );
+   m_n_threads = n_threads;
+   m_task = NULL;
+   m_n_items = 0;
+   m_generation = 0;
+   m_n_done = 0;
+   m_exit = false;
+   m_threads = new pthread_t[m_n_threads];
+   m_args = new worker_arg[m_n_threads];
+   for (unsigned t = 1; t < m_n_threads; t++) {
+      m_args[t].pool = this;
+      m_args[t].tid = t;
+      if (pthread_create(&m_threads[t], NULL, worker_main, &m_args[t])) {
+         fprintf(stderr, "GPGPU-Sim: ERROR - unable to create simulation thread %u\n", t);
+         abort();
+      }
+   }
+}
+
+sim_thread_pool::~sim_thread_pool()
+{
+   m_exit = true;
+   __sync_synchronize();
+   for (unsigned t = 1; t < m_n_threads; t++)
+      pthread_join(m_threads[t], NULL);
+   delete[] m_threads;
+   delete[] m_args;
+}
+
+void sim_thread_pool::parallel_for( unsigned n, sim_parallel_task *task )
+{
+   if (m_n_threads == 1 || n <= 1) {
+      for (unsigned i = 0; i < n; i++)
+         task->run(i);
+      return;
+   }
+   m_task = task;
+   m_n_items = n;
+   m_n_done = 0;
+   __sync_synchronize();
+   __sync_fetch_and_add(&m_generation, 1);
+
+   run_slice(0);
+
+   unsigned spins = 0;
+   while (m_n_done != m_n_threads - 1) {
+      if (++spins > SIM_THREAD_POOL_SPIN_LIMIT)
+         sched_yield();
+   }
+   __sync_synchronize();
+   m_task = NULL;
+}
+
+void *sim_thread_pool::worker_main( void *arg )
+{
+   worker_arg *a = (worker_arg*) arg;
+   a->pool->worker_loop(a->tid);
+   return NULL;
+}
+
+void sim_thread_pool::worker_loop( unsigned tid )
+{
+   unsigned seen = 0;
+   while (true) {
+      unsigned spins = 0;
+      while (m_generation == seen && !m_exit) {
+         if (++spins > SIM_THREAD_POOL_SPIN_LIMIT)
+            sched_yield();
+      }
+      if (m_exit)
+         return;
+      __sync_synchronize();
+      seen = m_generation;
+      run_slice(tid);
+      __sync_fetch_and_add(&m_n_done, 1);
+   }
+}
+
+void sim_thread_pool::run_slice( unsigned tid )
+{
+   sim_parallel_task *task = m_task;
+   unsigned n = m_n_items;
+   for (unsigned i = tid; i < n; i += m_n_threads)
+      task->run(i);
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+
+// A unit of work that can be split across host threads. run(i) is called
+// exactly once for every index in [0,n) passed to sim_thread_pool::parallel_for
+// and must only touch state that belongs to index i.
+class sim_parallel_task {
+public:
+   virtual ~sim_parallel_task() {}
+   virtual void run( unsigned i ) = 0;
+};
+
+// Fork/join pool used to tick independent hardware units (e.g. memory
+// partitions) concurrently inside a single simulated cycle.
+//
+// The calling thread participates in every parallel_for, so a pool created
+// with n_threads = N spawns N-1 workers. Index i is always run by thread
+// (i % N); the assignment is static so the pool does not introduce any
+// scheduling-dependent behaviour of its own. Workers spin for a short while
+// between parallel regions before yielding the host CPU, since the regions
+// are typically only a few microseconds apart.
+class sim_thread_pool {
+public:
+   sim_thread_pool( unsigned n_threads );
+   ~sim_thread_pool();
+
+   // run task->run(i) for every i in [0,n); returns once all have completed
+   void parallel_for( unsigned n, sim_parallel_task *task );
+
+   unsigned n_threads() const { return m_n_threads; }
+
+private:
+   struct worker_arg {
+      sim_thread_pool *pool;
+      unsigned tid;
+   };
+
+   static void *worker_main( void *arg );
+   void worker_loop( unsigned tid );
+   void run_slice( unsigned tid );
+
+   unsigned m_n_threads; // including the calling thread
+   pthread_t *m_threads;
+   worker_arg *m_args;
+
+   // parallel region being executed; published by bumping m_generation
+   sim_parallel_task *volatile m_task;
+   volatile unsigned m_n_items;
+   volatile unsigned m_generation;
+   volatile unsigned m_n_done;
+   volatile bool m_exit;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "traffic_breakdown.h" 
 #include "mem_fetch.h" 
+#include "checkpoint.h"
 
 void traffic_breakdown::print(FILE* fout)
 {
@@ -49,3 +50,7 @@ std::string traffic_breakdown::classify_memfetch(class mem_fetch * mf)
    return traffic_name; 
 }
 
+void traffic_breakdown::checkpoint_io(FILE* fp, bool save)
+{
+   ::checkpoint_io(fp, save, m_stats); 
+}
@@ -18,6 +18,9 @@ public:
    // record the amount and type of traffic introduced by this mem_fetch object 
    void record_traffic(class mem_fetch * mf, unsigned int size); 
 
+   // save (or restore) the recorded traffic to a checkpoint 
+   void checkpoint_io(FILE* fp, bool save); 
+
 protected:
 
    std::string m_network_name; 
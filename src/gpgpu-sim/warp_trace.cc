@@ -0,0 +1,357 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "warp_trace.h"
+#include "../cuda-sim/cuda-sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define WARP_TRACE_MAGIC   0x54575047 // "GPWT"
+#define WARP_TRACE_VERSION 1
+
+#define WARP_TRACE_KERNEL 'K'
+#define WARP_TRACE_WARP   'W'
+
+// record flags
+#define WARP_TRACE_MEM    0x1
+#define WARP_TRACE_ATOMIC 0x2
+#define WARP_TRACE_RPC    0x4
+
+// Records are variable length integers (7 bits per byte, low bits first); 
+// PCs and addresses are stored as zigzag encoded deltas so that sequential 
+// code and coalesced accesses take one or two bytes each.
+
+static void put_varint( std::vector<unsigned char> &buf, unsigned long long v )
+{
+   while( v >= 0x80 ) {
+      buf.push_back( (unsigned char)(v | 0x80) );
+      v >>= 7;
+   }
+   buf.push_back( (unsigned char)v );
+}
+
+static unsigned long long get_varint( const std::vector<unsigned char> &buf, size_t &pos )
+{
+   unsigned long long v = 0;
+   for( unsigned shift=0; ; shift += 7 ) {
+      if( pos >= buf.size() || shift > 63 ) {
+         printf("GPGPU-Sim: ERROR ** corrupted warp trace record\n");
+         exit(1);
+      }
+      unsigned char b = buf[pos++];
+      v |= (unsigned long long)(b & 0x7f) << shift;
+      if( !(b & 0x80) ) 
+         return v;
+   }
+}
+
+static unsigned long long zigzag( long long v ) { return ((unsigned long long)v << 1) ^ (unsigned long long)(v >> 63); }
+static long long unzigzag( unsigned long long v ) { return (long long)(v >> 1) ^ -(long long)(v & 1); }
+
+void warp_trace::clear()
+{
+   m_kernel_uid = 0;
+   m_cta = 0;
+   m_warp = 0;
+   m_data.clear();
+   m_pos = 0;
+   m_last_pc = 0;
+   m_done.reset();
+   m_next_pc.clear();
+   m_rpc = 0;
+}
+
+void warp_trace::record( const warp_inst_t &inst, const active_mask_t &issued, const simt_mask_t &done, 
+                         const addr_vector_t &next_pc, address_type rpc )
+{
+   const active_mask_t &active = inst.get_active_mask();
+   put_varint( m_data, zigzag((long long)inst.pc - (long long)m_last_pc) );
+   m_last_pc = inst.pc;
+   put_varint( m_data, active.to_ulong() );
+   put_varint( m_data, done.to_ulong() );
+
+   // group the issued threads that did not exit by next PC
+   std::vector< std::pair<address_type,unsigned long> > groups;
+   for( unsigned t=0; t < inst.warp_size(); t++ ) {
+      if( !issued.test(t) || done.test(t) ) 
+         continue;
+      unsigned g=0;
+      while( g < groups.size() && groups[g].first != next_pc[t] ) 
+         g++;
+      if( g == groups.size() ) 
+         groups.push_back( std::make_pair(next_pc[t],0UL) );
+      groups[g].second |= 1UL << t;
+   }
+   put_varint( m_data, groups.size() );
+   for( unsigned g=0; g < groups.size(); g++ ) {
+      put_varint( m_data, groups[g].second );
+      put_varint( m_data, zigzag((long long)groups[g].first - (long long)(inst.pc + inst.isize)) );
+   }
+
+   unsigned char flags = 0;
+   bool mem = (inst.is_load() || inst.is_store()) && active.any();
+   if( mem ) flags |= WARP_TRACE_MEM;
+   if( mem && inst.isatomic() ) flags |= WARP_TRACE_ATOMIC;
+   if( inst.reconvergence_pc == RECONVERGE_RETURN_PC ) flags |= WARP_TRACE_RPC;
+   m_data.push_back(flags);
+   if( flags & WARP_TRACE_RPC ) 
+      put_varint( m_data, rpc );
+   if( mem ) {
+      put_varint( m_data, inst.space.get_type() );
+      put_varint( m_data, inst.space.get_bank() );
+      put_varint( m_data, inst.data_size );
+      new_addr_type last_addr = 0;
+      for( unsigned t=0; t < inst.warp_size(); t++ ) {
+         if( !active.test(t) ) 
+            continue;
+         new_addr_type addr = inst.get_addr(t);
+         put_varint( m_data, zigzag((long long)addr - (long long)last_addr) );
+         last_addr = addr;
+      }
+   }
+}
+
+address_type warp_trace::peek_pc() const
+{
+   size_t pos = m_pos;
+   return m_last_pc + unzigzag( get_varint(m_data,pos) );
+}
+
+void warp_trace::replay( warp_inst_t &inst, const active_mask_t &issued )
+{
+   if( finished() ) {
+      printf("GPGPU-Sim: ERROR ** warp trace of kernel %u, CTA %u, warp %u ends before the warp exits\n", 
+             m_kernel_uid, m_cta, m_warp );
+      exit(1);
+   }
+   address_type pc = m_last_pc + unzigzag( get_varint(m_data,m_pos) );
+   if( pc != inst.pc ) {
+      printf("GPGPU-Sim: ERROR ** warp trace of kernel %u, CTA %u, warp %u has pc 0x%x where 0x%x is issued\n", 
+             m_kernel_uid, m_cta, m_warp, pc, inst.pc );
+      exit(1);
+   }
+   m_last_pc = pc;
+   active_mask_t active( (unsigned long)get_varint(m_data,m_pos) );
+   for( unsigned t=0; t < inst.warp_size(); t++ ) {
+      if( issued.test(t) && !active.test(t) ) 
+         inst.set_not_active(t);
+   }
+   m_done = simt_mask_t( (unsigned long)get_varint(m_data,m_pos) );
+
+   m_next_pc.assign( inst.warp_size(), (address_type)-1 );
+   unsigned n_groups = get_varint(m_data,m_pos);
+   for( unsigned g=0; g < n_groups; g++ ) {
+      unsigned long mask = get_varint(m_data,m_pos);
+      address_type group_pc = inst.pc + inst.isize + unzigzag( get_varint(m_data,m_pos) );
+      for( unsigned t=0; t < inst.warp_size(); t++ ) 
+         if( mask & (1UL << t) ) 
+            m_next_pc[t] = group_pc;
+   }
+
+   if( m_pos >= m_data.size() ) 
+      get_varint(m_data,m_pos); // reports the truncated record
+   unsigned char flags = m_data[m_pos++];
+   m_rpc = inst.reconvergence_pc;
+   if( flags & WARP_TRACE_RPC ) 
+      m_rpc = get_varint(m_data,m_pos);
+   if( flags & WARP_TRACE_MEM ) {
+      memory_space_t space( (enum _memory_space_t)get_varint(m_data,m_pos) );
+      space.set_bank( get_varint(m_data,m_pos) );
+      inst.space = space;
+      inst.data_size = get_varint(m_data,m_pos);
+      new_addr_type addr = 0;
+      for( unsigned t=0; t < inst.warp_size(); t++ ) {
+         if( !active.test(t) ) 
+            continue;
+         addr += unzigzag( get_varint(m_data,m_pos) );
+         inst.set_addr(t,addr);
+         // marks the instruction atomic; there is no functional update to do
+         if( flags & WARP_TRACE_ATOMIC ) 
+            inst.add_callback(t,NULL,NULL,NULL,true);
+      }
+   }
+}
+
+warp_trace_file::warp_trace_file( const char *filename, bool replay, unsigned warp_size )
+{
+   m_filename = filename;
+   m_replay = replay;
+   m_warp_size = warp_size;
+   m_file = gzopen( filename, replay ? "rb" : "wb" );
+   if( m_file == NULL ) 
+      fail("could not open");
+   unsigned header[3] = { WARP_TRACE_MAGIC, WARP_TRACE_VERSION, warp_size };
+   if( replay ) {
+      unsigned file_header[3];
+      if( !read(file_header,sizeof(file_header)) || file_header[0] != WARP_TRACE_MAGIC ) 
+         fail("not a warp trace:");
+      if( file_header[1] != WARP_TRACE_VERSION ) 
+         fail("unsupported version of");
+      if( file_header[2] != warp_size ) 
+         fail("different warp size in");
+      printf("GPGPU-Sim: replaying warp instruction trace %s\n", filename);
+   } else {
+      write(header,sizeof(header));
+      gzclose(m_file);
+      m_file = NULL;
+      printf("GPGPU-Sim: capturing warp instruction trace to %s\n", filename);
+   }
+}
+
+warp_trace_file::~warp_trace_file()
+{
+   if( m_file ) 
+      gzclose(m_file);
+}
+
+void warp_trace_file::fail( const char *what ) const
+{
+   printf("GPGPU-Sim: ERROR ** %s trace file %s\n", what, m_filename.c_str());
+   exit(1);
+}
+
+void warp_trace_file::open_append()
+{
+   if( m_file == NULL ) {
+      m_file = gzopen( m_filename.c_str(), "ab" );
+      if( m_file == NULL ) 
+         fail("could not reopen");
+   }
+}
+
+void warp_trace_file::write( const void *data, unsigned len )
+{
+   if( len && gzwrite(m_file,data,len) != (int)len ) 
+      fail("could not write to");
+}
+
+bool warp_trace_file::read( void *data, unsigned len )
+{
+   return len == 0 || gzread(m_file,data,len) == (int)len;
+}
+
+void warp_trace_file::kernel_launch( const kernel_info_t &kernel )
+{
+   if( m_replay ) {
+      while( m_kernels.find(kernel.get_uid()) == m_kernels.end() ) {
+         if( !read_block() ) {
+            printf("GPGPU-Sim: ERROR ** warp trace %s has no launch of kernel %u \'%s\'\n", 
+                   m_filename.c_str(), kernel.get_uid(), kernel.name().c_str() );
+            exit(1);
+         }
+      }
+      if( m_kernels[kernel.get_uid()] != kernel.name() ) {
+         printf("GPGPU-Sim: ERROR ** warp trace %s launches \'%s\' as kernel %u, the application launches \'%s\'\n", 
+                m_filename.c_str(), m_kernels[kernel.get_uid()].c_str(), kernel.get_uid(), kernel.name().c_str() );
+         exit(1);
+      }
+      return;
+   }
+   std::vector<unsigned char> block;
+   block.push_back(WARP_TRACE_KERNEL);
+   put_varint( block, kernel.get_uid() );
+   std::string name = kernel.name();
+   put_varint( block, name.size() );
+   block.insert( block.end(), name.begin(), name.end() );
+   open_append();
+   write( &block[0], block.size() );
+}
+
+void warp_trace_file::kernels_idle()
+{
+   if( !m_replay && m_file ) {
+      gzclose(m_file);
+      m_file = NULL;
+   }
+}
+
+void warp_trace_file::write_warp( const warp_trace &trace )
+{
+   std::vector<unsigned char> block;
+   block.push_back(WARP_TRACE_WARP);
+   put_varint( block, trace.m_kernel_uid );
+   put_varint( block, trace.m_cta );
+   put_varint( block, trace.m_warp );
+   put_varint( block, trace.m_data.size() );
+   open_append();
+   write( &block[0], block.size() );
+   if( !trace.m_data.empty() ) 
+      write( &trace.m_data[0], trace.m_data.size() );
+}
+
+void warp_trace_file::read_warp( unsigned kernel_uid, unsigned cta, unsigned warp, warp_trace &trace )
+{
+   warp_key key( kernel_uid, std::make_pair(cta,warp) );
+   std::map<warp_key, std::vector<unsigned char> >::iterator w;
+   while( (w = m_warps.find(key)) == m_warps.end() ) {
+      if( !read_block() ) {
+         printf("GPGPU-Sim: ERROR ** warp trace %s has no warp %u of CTA %u of kernel %u\n", 
+                m_filename.c_str(), warp, cta, kernel_uid );
+         exit(1);
+      }
+   }
+   trace.clear();
+   trace.set_position(kernel_uid,cta,warp);
+   trace.m_data.swap(w->second);
+   m_warps.erase(w);
+}
+
+// reads the next block into m_kernels or m_warps, false at the end of the trace
+bool warp_trace_file::read_block()
+{
+   unsigned char tag;
+   if( !read(&tag,1) ) 
+      return false;
+   // the block headers are short, so read them a byte at a time
+   std::vector<unsigned char> header;
+   unsigned n_fields = (tag == WARP_TRACE_KERNEL) ? 2 : 4;
+   if( tag != WARP_TRACE_KERNEL && tag != WARP_TRACE_WARP ) 
+      fail("corrupted block in");
+   unsigned long long fields[4];
+   for( unsigned f=0; f < n_fields; f++ ) {
+      size_t pos = header.size();
+      unsigned char b;
+      do {
+         if( !read(&b,1) ) 
+            fail("truncated block in");
+         header.push_back(b);
+      } while( b & 0x80 );
+      fields[f] = get_varint(header,pos);
+   }
+   // the last field is the length of the payload
+   std::vector<unsigned char> payload( fields[n_fields-1] );
+   if( !payload.empty() && !read(&payload[0],payload.size()) ) 
+      fail("truncated block in");
+   if( tag == WARP_TRACE_KERNEL ) {
+      m_kernels[fields[0]] = std::string( payload.begin(), payload.end() );
+   } else {
+      warp_key key( fields[0], std::make_pair((unsigned)fields[1],(unsigned)fields[2]) );
+      m_warps[key].swap(payload);
+   }
+   return true;
+}
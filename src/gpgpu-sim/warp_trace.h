@@ -0,0 +1,126 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef WARP_TRACE_H
+#define WARP_TRACE_H
+
+#include <zlib.h>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../abstract_hardware_model.h"
+
+// Trace driven simulation (-warp_trace_capture/-warp_trace_replay). A capture run 
+// records the dynamic instruction stream of every warp of every CTA as the 
+// performance model issues it: PC, active mask, the next PC of each thread, 
+// the threads that exited and the memory space, size and per-thread address 
+// of memory instructions. Opcodes and register operands are not stored, they 
+// are decoded from the PTX at the recorded PC like in a normal run. A replay 
+// run drives the SIMT stacks and the memory pipeline from the trace instead 
+// of executing the PTX, so the hardware configuration can change between the 
+// two runs (but not the warp size). Device memory is not updated in replay.
+
+// the instruction stream of one warp of a CTA
+class warp_trace {
+public:
+   warp_trace() { clear(); }
+   void clear();
+   void set_position( unsigned kernel_uid, unsigned cta, unsigned warp ) 
+   { 
+      m_kernel_uid = kernel_uid; 
+      m_cta = cta; 
+      m_warp = warp; 
+   }
+   unsigned kernel_uid() const { return m_kernel_uid; }
+   unsigned cta() const { return m_cta; }
+   unsigned warp() const { return m_warp; }
+
+   // capture: inst has been executed with the threads in 'issued'
+   void record( const warp_inst_t &inst, const active_mask_t &issued, const simt_mask_t &done, 
+                const addr_vector_t &next_pc, address_type rpc );
+
+   // replay: fill in the dynamic information of the next instruction; the 
+   // control flow it produced is left in done(), next_pc() and rpc()
+   bool finished() const { return m_pos >= m_data.size(); }
+   address_type peek_pc() const;
+   void replay( warp_inst_t &inst, const active_mask_t &issued );
+   const simt_mask_t &done() const { return m_done; }
+   addr_vector_t &next_pc() { return m_next_pc; }
+   address_type rpc() const { return m_rpc; }
+
+private:
+   friend class warp_trace_file;
+
+   unsigned m_kernel_uid;
+   unsigned m_cta;   // linear CTA id within the grid
+   unsigned m_warp;  // warp within the CTA
+   std::vector<unsigned char> m_data;
+   size_t m_pos;
+   address_type m_last_pc;
+
+   simt_mask_t m_done;
+   addr_vector_t m_next_pc;
+   address_type m_rpc;
+};
+
+// the trace file: one header per kernel launch, then the warp streams of the 
+// kernel in the order the warps completed (gzip compressed)
+class warp_trace_file {
+public:
+   warp_trace_file( const char *filename, bool replay, unsigned warp_size );
+   ~warp_trace_file();
+
+   bool replay() const { return m_replay; }
+
+   // capture: writes the kernel header; replay: checks it against the trace
+   void kernel_launch( const kernel_info_t &kernel );
+   // capture: closes the file while no kernel runs so it is always complete
+   void kernels_idle();
+
+   void write_warp( const warp_trace &trace );
+   void read_warp( unsigned kernel_uid, unsigned cta, unsigned warp, warp_trace &trace );
+
+private:
+   void open_append();
+   void write( const void *data, unsigned len );
+   bool read( void *data, unsigned len );
+   void fail( const char *what ) const;
+   bool read_block();
+
+   std::string m_filename;
+   bool m_replay;
+   unsigned m_warp_size;
+   gzFile m_file;
+
+   // replay: launches and warp streams read ahead of their use
+   std::map<unsigned,std::string> m_kernels;
+   typedef std::pair<unsigned, std::pair<unsigned,unsigned> > warp_key;
+   std::map<warp_key, std::vector<unsigned char> > m_warps;
+};
+
+#endif
@@ -45,9 +45,12 @@ BookSimConfig::BookSimConfig( )
   AddStrField( "channel_file", "" ) ;
 
   // Physical sub-networks
-  _int_map["subnet_selection"] = 0;    // jgardea
+  _int_map["subnet_selection"] = 0;    // jgardea 0 = packet type, 1 = round robin, 2 = random, 3 = packet size, 4 = load aware
   _int_map["subnets"] = 1;
 
+  // Step only routers and channels that have work in a given cycle
+  _int_map["active_worklist"] = 0;
+
   //==== Topology options =======================
   AddStrField( "topology", "torus" );
   AddStrField( "topology", "mesh3D"); //jgardea
@@ -38,6 +38,7 @@
 #define _CHANNEL_HPP
 
 #include <queue>
+#include <vector>
 #include <cassert>
 
 #include "globals.hpp"
@@ -67,11 +68,18 @@ public:
   virtual void WriteOutputs();
   virtual T * IsBusy(); // jgardea
 
+  // Module that reads this channel and has to be activated on delivery
+  void AddSinkModule(TimedModule * sink) { _sink_modules.push_back(sink); }
+  virtual bool IsIdle() const {
+    return !_input && !_output && _wait_queue.empty();
+  }
+
 protected:
   int _delay;
   T * _input;
   T * _output;
   queue<pair<int, T *> > _wait_queue;
+  vector<TimedModule *> _sink_modules;
 
 };
 
@@ -91,6 +99,7 @@ void Channel<T>::SetLatency(int cycles) {
 template<typename T>
 void Channel<T>::Send(T * data) {
   _input = data;
+  Activate();
 }
 
 template<typename T>
@@ -121,6 +130,9 @@ void Channel<T>::WriteOutputs() {
   _output = item.second;
   assert(_output);
   _wait_queue.pop();
+  for(size_t i = 0; i < _sink_modules.size(); ++i) {
+    _sink_modules[i]->Activate();
+  }
 }
 
 template<typename T>  // jgardea
@@ -35,6 +35,8 @@
 
 stack<Credit *> Credit::_all;
 stack<Credit *> Credit::_free;
+bool Credit::_thread_safe = false;
+pthread_mutex_t Credit::_lock = PTHREAD_MUTEX_INITIALIZER;
 //vector<Credit *> Credit::credits;
 //int Credit::count = 0;
 
@@ -55,6 +57,9 @@ void Credit::Reset()
 
 Credit * Credit::New() {
   Credit * c;
+  if(_thread_safe) {
+    pthread_mutex_lock(&_lock);
+  }
   if(_free.empty()) {
     c = new Credit();
     //c->id = count++;
@@ -67,12 +72,25 @@ Credit * Credit::New() {
     _free.pop();
     //credits.pop_back();
   }
+  if(_thread_safe) {
+    pthread_mutex_unlock(&_lock);
+  }
   return c;
 }
 
 void Credit::Free() {
   //credits.push_back(this);
+  if(_thread_safe) {
+    pthread_mutex_lock(&_lock);
+  }
   _free.push(this);
+  if(_thread_safe) {
+    pthread_mutex_unlock(&_lock);
+  }
+}
+
+void Credit::SetThreadSafe( bool thread_safe ) {
+  _thread_safe = thread_safe;
 }
 
 void Credit::FreeAll() {
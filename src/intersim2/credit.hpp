@@ -31,6 +31,7 @@
 #include <set>
 #include <stack>
 #include <vector>
+#include <pthread.h>
 
 class Credit {
 
@@ -49,6 +50,8 @@ public:
   void Free();
   static void FreeAll();
   static int OutStanding();
+  // New() and Free() lock the pools, for routers stepped on several threads
+  static void SetThreadSafe( bool thread_safe );
 
   static stack<Credit *> _all;
   static stack<Credit *> _free;
@@ -57,6 +60,9 @@ public:
 
 private:
 
+  static bool _thread_safe;
+  static pthread_mutex_t _lock;
+
   Credit();
   ~Credit() {}
 
@@ -32,6 +32,8 @@
 #include "gputrafficmanager.hpp"
 #include "interconnect_interface.hpp"
 #include "globals.hpp"
+#include "random_utils.hpp"
+#include "thread_pool.h"
 
 
 GPUTrafficManager::GPUTrafficManager( const Configuration &config, const vector<Network *> &net)
@@ -47,10 +49,64 @@ GPUTrafficManager::GPUTrafficManager( const Configuration &config, const vector<
       _input_queue[subnet][node].resize(_classes);
     }
   }
+
+  _subnet_packets.resize(_subnets, 0);
+  _subnet_flits.resize(_subnets, 0);
+  _subnet_retired_packets.resize(_subnets, 0);
+  _subnet_plat_sum.resize(_subnets, 0);
+  _subnet_nlat_sum.resize(_subnets, 0);
+  _subnet_recent_nlat.resize(_subnets, vector<double>(_nodes, 0.0));
+
+  _subnet_pool = NULL;
+  int const subnet_threads = min(config.GetInt("subnet_threads"), _subnets);
+  if ( subnet_threads > 1 ) {
+    _subnet_pool = new sim_thread_pool(subnet_threads);
+    Credit::SetThreadSafe(true);
+  }
 }
 
 GPUTrafficManager::~GPUTrafficManager()
 {
+  delete _subnet_pool;
+}
+
+// One subnet's share of a network step. Subnets share no routers or 
+// channels, so they can be stepped by different host threads; everything 
+// the traffic manager does at the network boundary (ejection into the 
+// InterconnectInterface buffers, injection, credits and flit retirement) 
+// stays on the calling thread in subnet order, so the result does not 
+// depend on the number of threads.
+class subnet_step_task : public sim_parallel_task {
+public:
+  subnet_step_task( const vector<Network *> &net, bool read_inputs ) 
+    : _net(net), _read_inputs(read_inputs) {}
+  virtual void run( unsigned subnet ) {
+    if ( _read_inputs ) {
+      _net[subnet]->ReadInputs( );
+    } else {
+      _net[subnet]->Evaluate( );
+      _net[subnet]->WriteOutputs( );
+    }
+  }
+private:
+  const vector<Network *> &_net;
+  bool _read_inputs;
+};
+
+void GPUTrafficManager::_StepSubnets( bool read_inputs )
+{
+  subnet_step_task task(_net, read_inputs);
+  if ( _subnet_pool ) {
+    // the RNG is shared by all subnets, its use would make the result 
+    // depend on thread timing (see ran_next)
+    gParallelSubnetStep = true;
+    _subnet_pool->parallel_for(_subnets, &task);
+    gParallelSubnetStep = false;
+  } else {
+    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+      task.run(subnet);
+    }
+  }
 }
 
 void GPUTrafficManager::Init()
@@ -145,6 +201,14 @@ void GPUTrafficManager::_RetireFlit( Flit *f, int dest )
     }
 #endif
 
+    int const subnet = f->subnetwork;
+    int const nlat = f->atime - head->itime;
+    ++_subnet_retired_packets[subnet];
+    _subnet_plat_sum[subnet] += f->atime - head->ctime;
+    _subnet_nlat_sum[subnet] += nlat;
+    double & recent = _subnet_recent_nlat[subnet][head->src];
+    recent += 0.125 * (nlat - recent);
+
     if(f->type == Flit::READ_REPLY || f->type == Flit::WRITE_REPLY  ){
       _requestsOutstanding[dest]--;
     } else if(f->type == Flit::ANY_TYPE) {
@@ -189,6 +253,41 @@ int  GPUTrafficManager::_IssuePacket( int source, int cl )
   return 0;
 }
 
+void GPUTrafficManager::DisplaySubnetStats( ostream & os ) const
+{
+  long long total_flits = 0;
+  for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+    total_flits += _subnet_flits[subnet];
+  }
+  os << "====== Subnet Traffic ======" << endl;
+  for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+    long long channel_flits = 0;
+    const vector<FlitChannel *> & channels = _net[subnet]->GetChannels();
+    for ( size_t c = 0; c < channels.size(); ++c ) {
+      const vector<int> & activity = channels[c]->GetActivity();
+      for ( size_t cl = 0; cl < activity.size(); ++cl ) {
+        channel_flits += activity[cl];
+      }
+    }
+    long long const retired = _subnet_retired_packets[subnet];
+    os << "Subnet " << subnet << ":" << endl
+       << "  packets = " << _subnet_packets[subnet] << endl
+       << "  flits = " << _subnet_flits[subnet] << endl
+       << "  share of flits = "
+       << (total_flits ? (double)_subnet_flits[subnet] / (double)total_flits : 0.0) << endl
+       << "  injection rate = "
+       << (_time ? (double)_subnet_flits[subnet] / ((double)_time * _nodes) : 0.0)
+       << " (flits/cycle/node)" << endl
+       << "  channel utilization = "
+       << ((_time && !channels.empty()) ? (double)channel_flits / ((double)_time * channels.size()) : 0.0)
+       << endl
+       << "  average packet latency = "
+       << (retired ? (double)_subnet_plat_sum[subnet] / retired : 0.0) << endl
+       << "  average network latency = "
+       << (retired ? (double)_subnet_nlat_sum[subnet] / retired : 0.0) << endl;
+  }
+}
+
 //TODO: Remove stype?
 void GPUTrafficManager::_GeneratePacket(int source, int stype, int cl, int time, int subnet, int packet_size, const Flit::FlitType& packet_type, void* const data, int dest)
 {
@@ -260,6 +359,9 @@ void GPUTrafficManager::_GeneratePacket(int source, int stype, int cl, int time,
     << "." << endl;
   }
   
+  ++_subnet_packets[subnet];
+  _subnet_flits[subnet] += size;
+
   for ( int i = 0; i < size; ++i ) {
     Flit * f  = Flit::New();
     f->id     = _cur_id++;
@@ -403,8 +505,9 @@ void GPUTrafficManager::_Step()
         c->Free();
       }
     }
-    _net[subnet]->ReadInputs( );
   }
+  // a subnet's network only depends on its own boundary handled above
+  _StepSubnets( true );
 
 // GPGPUSim will generate/inject packets from interconnection interface
 #if 0
@@ -669,10 +772,9 @@ void GPUTrafficManager::_Step()
       }
     }
     flits[subnet].clear();
-    // _InteralStep here
-    _net[subnet]->Evaluate( );
-    _net[subnet]->WriteOutputs( );
   }
+  // _InteralStep here
+  _StepSubnets( false );
   
   ++_time;
   assert(_time);
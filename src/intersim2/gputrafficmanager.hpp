@@ -39,6 +39,8 @@
 #include "booksim_config.hpp"
 #include "flit.hpp"
 
+class sim_thread_pool;
+
 class GPUTrafficManager : public TrafficManager {
   
 protected:
@@ -47,8 +49,25 @@ protected:
   virtual int  _IssuePacket( int source, int cl );
   virtual void _Step();
   
+  // ReadInputs() (read_inputs) or Evaluate() and WriteOutputs() of every 
+  // subnet, in parallel when _subnet_pool is set
+  void _StepSubnets( bool read_inputs );
+  
+  // steps the subnets on separate host threads (subnet_threads > 1)
+  sim_thread_pool *_subnet_pool;
+  
   // record size of _partial_packets for each subnet
   vector<vector<vector<list<Flit *> > > > _input_queue;
+
+  // per subnet traffic, for load-aware subnet selection and DisplaySubnetStats
+  vector<long long> _subnet_packets;
+  vector<long long> _subnet_flits;
+  vector<long long> _subnet_retired_packets;
+  vector<long long> _subnet_plat_sum;
+  vector<long long> _subnet_nlat_sum;
+  // size: [subnets][nodes], moving average of the network latency of the 
+  // packets a node sent on a subnet
+  vector<vector<double> > _subnet_recent_nlat;
   
 public:
   
@@ -57,6 +76,11 @@ public:
   
   // correspond to TrafficManger::Run/SingleSim
   void Init();
+
+  inline double RecentLatency( int subnet, int node ) const {
+    return _subnet_recent_nlat[subnet][node];
+  }
+  void DisplaySubnetStats( ostream & os = cout ) const;
   
   // TODO: if it is not good...
   friend class InterconnectInterface;
@@ -46,7 +46,7 @@
 #include "network.hpp"
 #include "random_utils.hpp"     // jgardea
 
-enum NetSelection { _pckt_type, _round_robin, _random, _pckt_size }; // subnetwork selection jgardea
+enum NetSelection { _pckt_type, _round_robin, _random, _pckt_size, _load_aware }; // subnetwork selection jgardea
 
 InterconnectInterface* InterconnectInterface::New(const char* const config_file)
 {
@@ -62,7 +62,7 @@ InterconnectInterface* InterconnectInterface::New(const char* const config_file)
 
 InterconnectInterface::InterconnectInterface()
 {
-
+  dsent_module = NULL;
 }
 
 InterconnectInterface::~InterconnectInterface() 
@@ -169,11 +169,15 @@ void InterconnectInterface::Push(unsigned input_deviceID, unsigned output_device
   }
 
   int subnet;
-  for ( int net = 0; net < _subnets; net++ )
-  {
+  if ( gNetSelec == _load_aware ) {
+    subnet = LoadAwareSelection(input_icntID, n_flits);
+  } else {
+    for ( int net = 0; net < _subnets; net++ )
+    {
 	  subnet = NetworkSelection(packet_type, input_deviceID);
 	  if (NetworkHasBuffer(subnet, input_icntID, size, n_flits)) break;
 	  subnet = -1;
+    }
   }
  
   //it should have subnet >= 0
@@ -310,6 +314,32 @@ int InterconnectInterface::NetworkSelection( int pckt_info, unsigned icntID  )
 	return subnet;
 }
 
+// Load-aware selection: among the subnets with room for the packet, take the 
+// one with the fewest flits queued at this node; ties go to the subnet on 
+// which this node's recent packets saw the lowest network latency, then 
+// round robin
+int InterconnectInterface::LoadAwareSelection( unsigned icntID, unsigned int n_flits )
+{
+  int subnet = -1;
+  size_t best_occupancy = 0;
+  double best_latency = 0.0;
+  for ( int i = 0; i < _subnets; i++ )
+  {
+    int const s = (_load_aware_turn[icntID] + i) % _subnets;
+    size_t const occupancy = _traffic_manager->_input_queue[s][icntID][0].size();
+    if ( occupancy + n_flits > _input_buffer_capacity ) continue;
+    double const latency = _traffic_manager->RecentLatency(s, icntID);
+    if ( subnet < 0 || occupancy < best_occupancy ||
+         ( occupancy == best_occupancy && latency < best_latency ) ) {
+      subnet = s;
+      best_occupancy = occupancy;
+      best_latency = latency;
+    }
+  }
+  if ( subnet >= 0 ) _load_aware_turn[icntID] = (subnet + 1) % _subnets;
+  return subnet;
+}
+
 // For multiple networks it is necessary to check which network is avialable
 bool InterconnectInterface::NetworkHasBuffer(int subnet, unsigned icntID, unsigned int size, unsigned int n_flits ) const
 {
@@ -336,6 +366,7 @@ bool InterconnectInterface::HasBuffer(unsigned deviceID, unsigned int size) cons
   	  break;
   	case _round_robin:		// default for 4 symmetric subnetworks
 	case _random:
+	case _load_aware:
 	  for ( int net = 0; net < _subnets; net++)
 	  {
 	    has_buffer = _traffic_manager->_input_queue[net][icntID][0].size() +n_flits <= _input_buffer_capacity;
@@ -383,6 +414,7 @@ void InterconnectInterface::DisplayOverallStats() //const
   _traffic_manager->_UpdateOverallStats();
   _traffic_manager->DisplayOverallStats();
   _traffic_manager->_ChannelUtilizationStats(); // jgardea
+  _traffic_manager->DisplaySubnetStats();
   if(_traffic_manager->_print_csv_results) {
     _traffic_manager->DisplayOverallStatsCSV();
   }
@@ -396,6 +428,20 @@ void InterconnectInterface::DisplayOverallStats() //const
   }
 }
 
+bool InterconnectInterface::HasPowerModel() const
+{
+  return _icnt_config->GetInt("sim_power") > 0;
+}
+
+void InterconnectInterface::PowerTrace(FILE *fp, unsigned long long gpu_cycle)
+{
+  if ( !HasPowerModel() ) return;
+  // DSENT is evaluated once, when the module is built; every sample after 
+  // that only reads the activity counters
+  if ( !dsent_module ) dsent_module = new Power_Module(_net, *_icnt_config);
+  dsent_module->powerTrace(fp, gpu_cycle);
+}
+
 void InterconnectInterface::DisplayState(FILE *fp) const
 {
   fprintf(fp, "GPGPU-Sim uArch: ICNT:Display State: Under implementation\n");
@@ -479,6 +525,7 @@ void InterconnectInterface::_CreateBuffer()
   _ejected_flit_queue.resize(_subnets);
 
   _round_robin_subnet_turn.resize(nodes,0); // jgardea
+  _load_aware_turn.resize(nodes,0);
 
   for (int subnet = 0; subnet < _subnets; ++subnet) {
     _ejection_buffer[subnet].resize(nodes);
@@ -67,6 +67,9 @@ public:
   unsigned GetFlitSize() const;
   
   virtual void DisplayState(FILE* fp) const;
+  // NoC power since the previous call, from the DSENT model
+  virtual void PowerTrace(FILE* fp, unsigned long long gpu_cycle);
+  bool HasPowerModel() const;
   
   //booksim side functions
   void WriteOutBuffer( int subnet, int output, Flit* flit );
@@ -101,6 +104,7 @@ protected:
   void _DisplayMap(int dim,int count);
  
   bool NetworkHasBuffer(int subnet, unsigned icntID, unsigned int size, unsigned int n_flits) const; // jgardea
+  int LoadAwareSelection(unsigned icntID, unsigned int n_flits);
 
   // size: [subnets][nodes][vcs]
   vector<vector<vector<_BoundaryBufferItem> > > _boundary_buffer;
@@ -115,6 +119,7 @@ protected:
   
   vector<vector<int> > _round_robin_turn; //keep track of _boundary_buffer last used in icnt_pop
   vector<int> _round_robin_subnet_turn; // keep track of subnet las used in icnt_pop // jgardea
+  vector<int> _load_aware_turn; // subnet after the one last picked by LoadAwareSelection, per node
 
   GPUTrafficManager* _traffic_manager;
  
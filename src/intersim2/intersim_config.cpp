@@ -46,6 +46,8 @@ IntersimConfig::IntersimConfig()
   _int_map["input_buffer_size"] = 0;
   _int_map["ejection_buffer_size"] = 0; // if left zero the simulator will use the vc_buf_size instead
   _int_map["boundary_buffer_size"] = 16;
+
+  _int_map["subnet_threads"] = 1; // host threads stepping the subnets in parallel (1 = serial)
   
 
   // FIXME: obsolete, unsupport configs
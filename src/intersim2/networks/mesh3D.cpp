@@ -71,11 +71,7 @@ void Mesh3D::RegisterRoutingFunctions() {
 
 void Mesh3D::Evaluate( )
 {
-  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin(); iter != _timed_modules.end(); ++iter) {
-
-     (*iter)->Evaluate( );
-          
-  }
+  Network::Evaluate( );
 
   // =================== Vertical Arbitration ========================= jgardea
   // It is necessary to devide iq3d routers evaluation to pre and post swich allocation 
@@ -86,12 +82,14 @@ void Mesh3D::Evaluate( )
 
   for( iter = _routers.begin(); iter != _routers.end(); iter++ )
   {
+    if ( !_IsScheduled( *iter ) ) continue;
     r = (IQ3DRouter *) (*iter);
     r->Evaluate_AfterSA( );
   }
 
   for( iter = _routers.begin(); iter != _routers.end(); iter++ )
   {
+    if ( !_IsScheduled( *iter ) ) continue;
     r = (IQ3DRouter *) (*iter);
       r->ClearVerticalArbiters();
   }
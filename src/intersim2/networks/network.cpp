@@ -34,6 +34,7 @@
 
 #include <cassert>
 #include <sstream>
+#include <algorithm>
 
 #include "booksim.hpp"
 #include "network.hpp"
@@ -49,6 +50,9 @@ Network::Network( const Configuration &config, const string & name ) :
   _nodes    = -1; 
   _channels = -1;
   _classes  = config.GetInt("classes");
+
+  _use_worklist   = false;
+  _worklist_cycle = 0;
 }
 
 Network::~Network( )
@@ -96,6 +100,9 @@ Network * Network::New(const Configuration & config, const string & name)
   if ( n && ( config.GetInt( "link_failures" ) > 0 ) ) {
     n->InsertRandomFaults( config );
   }
+  if ( n ) {
+    n->_InitWorklist( config );
+  }
   return n;
 }
 
@@ -154,8 +161,70 @@ void Network::_Alloc( )
   }
 }
 
+/*with active_worklist set, routers and channels that have no buffered work
+ *are dropped from the per-cycle loops; a channel is put back when something
+ *is sent on it, a router when one of its input or credit channels delivers.
+ *an idle module's phases are no-ops, so the simulation stays cycle-exact
+ */
+void Network::_InitWorklist( const Configuration &config )
+{
+  _use_worklist = ( config.GetInt( "active_worklist" ) > 0 );
+  if ( !_use_worklist ) {
+    return;
+  }
+  int const modules = _timed_modules.size( );
+  _worklist.Resize( modules );
+  _scheduled.resize( modules );
+  _idle_since.assign( modules, -1 );
+  for ( int m = 0; m < modules; ++m ) {
+    _timed_modules[m]->SetWorklist( &_worklist, m );
+    _scheduled[m] = m;
+  }
+}
+
+void Network::_UpdateWorklist( )
+{
+  _scheduled_next.clear( );
+  for ( size_t i = 0; i < _scheduled.size( ); ++i ) {
+    int const m = _scheduled[i];
+    if ( _worklist.IsPending( m ) ) {
+      continue;
+    }
+    if ( _timed_modules[m]->IsIdle( ) ) {
+      _idle_since[m] = _worklist_cycle;
+    } else {
+      _scheduled_next.push_back( m );
+    }
+  }
+
+  vector<int> const & pending = _worklist.Pending( );
+  for ( size_t i = 0; i < pending.size( ); ++i ) {
+    int const m = pending[i];
+    if ( _idle_since[m] >= 0 ) {
+      _timed_modules[m]->SkipCycles( _worklist_cycle - _idle_since[m] );
+      _idle_since[m] = -1;
+    }
+    _scheduled_next.push_back( m );
+  }
+  if ( !pending.empty( ) ) {
+    // keep the original module order
+    sort( _scheduled_next.begin( ), _scheduled_next.end( ) );
+  }
+  _worklist.Clear( );
+
+  _scheduled.swap( _scheduled_next );
+  ++_worklist_cycle;
+}
+
 void Network::ReadInputs( )
 {
+  if ( _use_worklist ) {
+    _UpdateWorklist( );
+    for ( size_t i = 0; i < _scheduled.size( ); ++i ) {
+      _timed_modules[_scheduled[i]]->ReadInputs( );
+    }
+    return;
+  }
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
@@ -165,6 +234,12 @@ void Network::ReadInputs( )
 
 void Network::Evaluate( )
 {
+  if ( _use_worklist ) {
+    for ( size_t i = 0; i < _scheduled.size( ); ++i ) {
+      _timed_modules[_scheduled[i]]->Evaluate( );
+    }
+    return;
+  }
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
@@ -174,6 +249,12 @@ void Network::Evaluate( )
 
 void Network::WriteOutputs( )
 {
+  if ( _use_worklist ) {
+    for ( size_t i = 0; i < _scheduled.size( ); ++i ) {
+      _timed_modules[_scheduled[i]]->WriteOutputs( );
+    }
+    return;
+  }
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
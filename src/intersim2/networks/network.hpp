@@ -66,11 +66,26 @@ protected:
 
   deque<TimedModule *> _timed_modules;
 
+  // Active-module worklist: only the modules listed in _scheduled (indices
+  // into _timed_modules, in order) are stepped in the current cycle
+  bool _use_worklist;
+  int _worklist_cycle;
+  ModuleWorklist _worklist;
+  vector<int> _scheduled;
+  vector<int> _scheduled_next;
+  vector<int> _idle_since;
+
   virtual void _ComputeSize( const Configuration &config ) = 0;
   virtual void _BuildNet( const Configuration &config ) = 0;
 
   void _Alloc( );
 
+  void _InitWorklist( const Configuration &config );
+  void _UpdateWorklist( );
+  inline bool _IsScheduled( TimedModule const * m ) const {
+    return !_use_worklist || ( _idle_since[m->GetWorklistId( )] < 0 );
+  }
+
 public:
   Network( const Configuration &config, const string & name );
   virtual ~Network( );
@@ -72,6 +72,28 @@ Power_Module::Power_Module(vector<Network *> n , const Configuration &config)
 
   runDsent();  
 
+  // the energy per event only depends on the configuration, keep it for 
+  // every later power calculation
+  subnet_energy.resize(nets.size());
+  for (unsigned n = 0; n < nets.size(); n++ )
+  {
+    calcEnergy(asymmetric && n);
+    net_energy & e = subnet_energy[n];
+    e.write = write_energy;
+    e.read = read_energy;
+    e.traversal = traversal_energy;
+    e.arb1 = arb1_energy;
+    e.arb2 = arb2_energy;
+    e.channel = channel_energy;
+    e.ver_channel = ver_channel_energy;
+    e.router_leakage = router_leakage;
+    e.channel_leakage = channel_leakage;
+    e.ver_channel_leakage = ver_channel_leakage;
+  }
+  trace_activity.assign(nets.size(), net_activity());
+  trace_time = 0.0;
+  trace_started = false;
+
   // jgardea
 
   string pfile = config.GetStr("tech_file");
@@ -645,82 +667,44 @@ void Power_Module::runDsent( )
     energy_results = DSENT::DSENT::run(config_dsent);
 }
 
-void Power_Module::calcNetPower(Network *net, int index)
+void Power_Module::gatherActivity(Network *net, net_activity &a)
 {
-    // Variables for hydbrid mesh topology
-    Mesh3D* net_mesh3d;
-    vector<VerticalChannel *> ver_chan;
-    vector<int> verchan_activity;
-    unsigned long verchan_sum = 0;
+    // We are accessing class 0 under the assumption we are only using one class
+    a.inject_sends = a.eject_sends = a.chan_sends = a.ver_chan_sends = 0;
+    a.writes = a.reads = a.traversals = a.arbitrations = 0;
+    a.vertical_channels = 0;
 
-    totalTime = GetSimTime();
-   
-// =======================
+    // Variables for hydbrid mesh topology
     if (topology == "mesh3D")
     {
-        net_mesh3d = (Mesh3D*) net; 
-        ver_chan = net_mesh3d->GetVerticalChannels(); 
-        verchan_activity.resize(ver_chan.size(), 0); 
-
+        vector<VerticalChannel *> ver_chan = ((Mesh3D*) net)->GetVerticalChannels();
         for(unsigned i = 0; i < ver_chan.size(); i++)
         {
-            verchan_activity.push_back(ver_chan[i]->GetActivity()[0]);
-            verchan_sum += ver_chan[i]->GetActivity()[0];
+            a.ver_chan_sends += ver_chan[i]->GetActivity()[0];
         }
+        a.vertical_channels = ver_chan.size();
     }
-    // ================ Calculating Channel Values =====================
-    vector<FlitChannel *> inject = net->GetInject();
-    vector<FlitChannel *> eject = net->GetEject();
-    vector<FlitChannel *> chan = net->GetChannels();
-    
-    vector<int> inject_activity(inject.size(),0);
-    vector<int> eject_activity(eject.size(), 0);
-    vector<int> channel_activity(chan.size(), 0);
-    
-    unsigned long  inject_sum = 0;
-    unsigned long  eject_sum = 0;
-    unsigned long  chan_sum = 0;
-    
-    // We are accessing class 0 under the assumption we are only using one class
-     
+    // ================ Channel Values =====================
+    const vector<FlitChannel *> & inject = net->GetInject();
+    const vector<FlitChannel *> & eject = net->GetEject();
+    const vector<FlitChannel *> & chan = net->GetChannels();
+
     for(unsigned i = 0; i < inject.size(); i++)
     {
-        inject_activity.push_back(inject[i]->GetActivity()[0]);
-        inject_sum += inject[i]->GetActivity()[0];
+        a.inject_sends += inject[i]->GetActivity()[0];
     }
     for(unsigned i = 0; i < eject.size(); i++)
     {
-        eject_activity.push_back(eject[i]->GetActivity()[0]);
-        eject_sum += eject[i]->GetActivity()[0];
+        a.eject_sends += eject[i]->GetActivity()[0];
     }
     for(unsigned i = 0; i < chan.size(); i++)
     {
-        channel_activity.push_back(chan[i]->GetActivity()[0]);
-        chan_sum += chan[i]->GetActivity()[0];
+        a.chan_sends += chan[i]->GetActivity()[0];
     }
-    
-// ================ Calculating Router Values =====================
-
-    vector<Router*> routers = net->GetRouters();
+    a.horizontal_channels = inject.size() + eject.size() + chan.size();
 
-    // having the data saved here might be useful for late stats
-    vector< int > router_writes(routers.size(), 0);     // buffer reads for each router
-    vector< int > router_reads(routers.size(), 0);      // buffer writes for each router
-    vector< int > router_traversals(routers.size(), 0);     // switch traversals for each router
-    vector< int > router_arbitrations(routers.size(), 0);      // switch arbitrations for each router
-    
-    vector<int> writes;                                 // temp values 
-    vector<int> reads;
-    vector<int> traversals;
-    vector<int> arbitration;
-
-    unsigned long total_writes = 0;
-    unsigned long total_reads = 0;
-    unsigned long total_traversals = 0;
-    unsigned long total_arbitrations = 0;
-
-    int inputs;
-   
+    // ================ Router Values =====================
+    const vector<Router*> & routers = net->GetRouters();
     const BufferMonitor * buffermonitor = NULL;
     const SwitchMonitor * switchmonitor = NULL;
 
@@ -730,31 +714,43 @@ void Power_Module::calcNetPower(Network *net, int index)
         assert(buffermonitor && switchmonitor);
 
         // Gathering buffer monitor stats
-        inputs = buffermonitor->NumInputs();
-        writes = buffermonitor->GetWrites();
-        reads = buffermonitor->GetReads();
-
+        int inputs = buffermonitor->NumInputs();
+        const vector<int> & writes = buffermonitor->GetWrites();
+        const vector<int> & reads = buffermonitor->GetReads();
         for ( int j = 0; j < inputs; j++ )
         {
-            router_writes[i] += writes[j];
-            router_reads[i] += reads[j];
-            total_writes += writes[j];
-            total_reads += reads[j];
+            a.writes += writes[j];
+            a.reads += reads[j];
         }
 
         // Gathering switch monitor stats
-        router_arbitrations[i] = switchmonitor->GetArbitration(); 
-        total_arbitrations += switchmonitor->GetArbitration();
-        traversals = switchmonitor->GetActivity();
-        
+        a.arbitrations += switchmonitor->GetArbitration();
+        const vector<int> & traversals = switchmonitor->GetActivity();
         for ( int j = 0; j < (switchmonitor->NumOutputs() * switchmonitor->NumInputs()); j++ )
         {
-            router_traversals[i] += traversals[j];
-            total_traversals += traversals[j];
+            a.traversals += traversals[j];
         }
     }
-    
-    calcEnergy(asymmetric && index); // get the values from dsent result
+    a.routers = routers.size();
+}
+
+void Power_Module::calcNetPower(Network *net, int index)
+{
+    net_activity a;
+    gatherActivity(net, a);
+
+    totalTime = GetSimTime();
+
+    unsigned long total_writes = a.writes;
+    unsigned long total_reads = a.reads;
+    unsigned long total_traversals = a.traversals;
+    unsigned long total_arbitrations = a.arbitrations;
+    unsigned long inject_sum = a.inject_sends;
+    unsigned long eject_sum = a.eject_sends;
+    unsigned long chan_sum = a.chan_sends;
+    unsigned long verchan_sum = a.ver_chan_sends;
+
+    useEnergy(index); // get the values from dsent result
 
 	if (1)
 	{
@@ -779,12 +775,9 @@ void Power_Module::calcNetPower(Network *net, int index)
     double ver_channel_power = (verchan_sum/totalTime) * ver_channel_energy * frequency;
     double router_power = write_power + read_power + traversal_power + arb1_power + arb2_power;
 
-    int horizontal_channels = inject.size() + eject.size() + chan.size();
-    int vertical_channels = ver_chan.size();
-
-    channel_leakage *= horizontal_channels;
-    ver_channel_leakage *= vertical_channels;
-    router_leakage *= routers.size();
+    channel_leakage *= a.horizontal_channels;
+    ver_channel_leakage *= a.vertical_channels;
+    router_leakage *= a.routers;
     
     double total_dynamic = router_power + channel_power + ver_channel_power;
     double total_leakage = router_leakage + channel_leakage + ver_channel_leakage;
@@ -858,6 +851,75 @@ void Power_Module::getMonitors(const SwitchMonitor * &sm, const BufferMonitor *
     assert(bm && sm);
 }
 
+void Power_Module::useEnergy(int index)
+{
+    const net_energy & e = subnet_energy[index];
+    write_energy = e.write;
+    read_energy = e.read;
+    traversal_energy = e.traversal;
+    arb1_energy = e.arb1;
+    arb2_energy = e.arb2;
+    channel_energy = e.channel;
+    ver_channel_energy = e.ver_channel;
+    router_leakage = e.router_leakage;
+    channel_leakage = e.channel_leakage;
+    ver_channel_leakage = e.ver_channel_leakage;
+}
+
+// One line per call: the GPU cycle, the interconnect cycle, then dynamic and 
+// leakage power (W) of every subnet and the totals, with the dynamic power 
+// averaged over the interconnect cycles since the previous line
+void Power_Module::powerTrace(FILE *fp, unsigned long long gpu_cycle)
+{
+    if (!trace_started)
+    {
+        fprintf(fp, "gpu_cycle,icnt_cycle");
+        for (unsigned n = 0; n < nets.size(); n++ )
+        {
+            fprintf(fp, ",subnet%u_dynamic,subnet%u_leakage", n, n);
+        }
+        fprintf(fp, ",total_dynamic,total_leakage,total\n");
+        trace_started = true;
+    }
+
+    double now = GetSimTime();
+    double interval = now - trace_time;
+    double dynamic_sum = 0.0;
+    double leakage_sum = 0.0;
+
+    fprintf(fp, "%llu,%.0f", gpu_cycle, now);
+    for (unsigned n = 0; n < nets.size(); n++ )
+    {
+        net_activity a;
+        gatherActivity(nets[n], a);
+        const net_activity & last = trace_activity[n];
+        const net_energy & e = subnet_energy[n];
+
+        double dynamic = 0.0;
+        if (interval > 0)
+        {
+            double energy = (a.writes - last.writes) * e.write
+                          + (a.reads - last.reads) * e.read
+                          + (a.traversals - last.traversals) * e.traversal
+                          + (a.arbitrations - last.arbitrations) * (e.arb1 + e.arb2)
+                          + ((a.inject_sends - last.inject_sends) + (a.eject_sends - last.eject_sends) 
+                             + (a.chan_sends - last.chan_sends)) * e.channel
+                          + (a.ver_chan_sends - last.ver_chan_sends) * e.ver_channel;
+            dynamic = (energy / interval) * frequency;
+        }
+        double leakage = e.router_leakage * a.routers 
+                       + e.channel_leakage * a.horizontal_channels 
+                       + e.ver_channel_leakage * a.vertical_channels;
+
+        fprintf(fp, ",%g,%g", dynamic, leakage);
+        dynamic_sum += dynamic;
+        leakage_sum += leakage;
+        trace_activity[n] = a;
+    }
+    fprintf(fp, ",%g,%g,%g\n", dynamic_sum, leakage_sum, dynamic_sum + leakage_sum);
+    trace_time = now;
+}
+
 void Power_Module::calcEnergy(bool asymmetric )
 {
     // Buffer elements
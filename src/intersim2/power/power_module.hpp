@@ -30,6 +30,7 @@
 
 #include <map>
 #include <vector>
+#include <cstdio>
 #include "module.hpp"
 #include "network.hpp"
 #include "config_utils.hpp"
@@ -80,6 +81,24 @@ protected:
   double total_leakage;
   // .. jgardea
 
+  // energy per event of each subnet, read once from the DSENT results
+  struct net_energy {
+    double write, read, traversal, arb1, arb2, channel, ver_channel;
+    double router_leakage, channel_leakage, ver_channel_leakage;
+  };
+  vector<net_energy> subnet_energy;
+
+  // activity counters of a subnet, and its component counts
+  struct net_activity {
+    unsigned long writes, reads, traversals, arbitrations;
+    unsigned long inject_sends, eject_sends, chan_sends, ver_chan_sends;
+    int routers, horizontal_channels, vertical_channels;
+  };
+  // counters at the previous power trace sample
+  vector<net_activity> trace_activity;
+  double trace_time;
+  bool trace_started;
+
   int classes;
   //all channels are this width
   double channel_width;
@@ -181,6 +200,8 @@ protected:
   void runDsent( ); 
   void getMonitors(const SwitchMonitor * &sm, const BufferMonitor * &bm, Router* router);
   void calcEnergy(bool asym );
+  void useEnergy(int index);
+  void gatherActivity(Network* net, net_activity &a);
   void calcNetPower(Network* net, int index);
 
   //channels
@@ -220,6 +241,8 @@ public:
 
   void run();
   void dsent(); // jgardea
+  // appends the NoC power since the previous call to a trace
+  void powerTrace(FILE *fp, unsigned long long gpu_cycle);
 
 
 };
@@ -34,6 +34,10 @@ long   ran_next( );
 void   ranf_start(long seed);
 double ranf_next( );
 
+// set while GPUTrafficManager steps subnets on several threads; the RNG 
+// must not be used then
+extern bool gParallelSubnetStep;
+
 inline void RandomSeed( long seed ) {
   ran_start( seed );
   ranf_start( seed );
@@ -28,7 +28,15 @@
 #define main rng_double_main
 #include "rng-double.c"
 
+#include <cstdio>
+#include <cstdlib>
+#include "random_utils.hpp"
+
 double ranf_next( )
 {
+  if ( gParallelSubnetStep ) {
+    fprintf( stderr, "Error: a router, allocator or routing function of this network uses the random number generator, subnet_threads must be 1\n" );
+    exit(-1);
+  }
   return ranf_arr_next( );
 }
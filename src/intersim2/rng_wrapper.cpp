@@ -28,7 +28,16 @@
 #define main rng_main
 #include "rng.c"
 
+#include <cstdio>
+#include <cstdlib>
+
+bool gParallelSubnetStep = false;
+
 long ran_next( )
 {
+  if ( gParallelSubnetStep ) {
+    fprintf( stderr, "Error: a router, allocator or routing function of this network uses the random number generator, subnet_threads must be 1\n" );
+    exit(-1);
+  }
   return ran_arr_next( );
 }
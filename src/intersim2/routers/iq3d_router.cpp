@@ -312,6 +312,45 @@ void IQ3DRouter::WriteOutputs( )
   _SendCredits( );
 }
 
+bool IQ3DRouter::IsIdle( ) const
+{
+  if(_active) {
+    return false;
+  }
+  for(int output = 0; output < _outputs; ++output) {
+    if(!_output_buffer[output].empty()) {
+      return false;
+    }
+  }
+  for(int input = 0; input < _inputs; ++input) {
+    if(!_credit_buffer[input].empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void IQ3DRouter::SkipCycles( int cycles )
+{
+  // replay the bookkeeping of Evaluate() and Evaluate_AfterSA() for an
+  // inactive router, both advance the partial internal cycles
+  if((_internal_speedup == 1.0) && (_partial_internal_cycles == 0.0)) {
+    _cycles += cycles;
+    return;
+  }
+  for(int c = 0; c < cycles; ++c) {
+    _partial_internal_cycles += _internal_speedup;
+    while( _partial_internal_cycles >= 1.0 ) {
+      _cycles++;
+      _partial_internal_cycles -= 1.0;
+    }
+    _partial_internal_cycles += _internal_speedup;
+    while( _partial_internal_cycles >= 1.0 ) {
+      _partial_internal_cycles -= 1.0;
+    }
+  }
+}
+
 
 //------------------------------------------------------------------------------
 // read inputs
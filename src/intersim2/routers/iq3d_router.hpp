@@ -194,6 +194,9 @@ public:
   virtual void ReadInputs( );
   virtual void WriteOutputs( );
 
+  virtual bool IsIdle( ) const;
+  virtual void SkipCycles( int cycles );
+
   void Evaluate_AfterSA( ); // jgardea
 
   inline long NumberCycles( ) // jgardea
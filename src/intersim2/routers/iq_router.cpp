@@ -289,6 +289,40 @@ void IQRouter::WriteOutputs( )
   _SendCredits( );
 }
 
+bool IQRouter::IsIdle( ) const
+{
+  if(_active) {
+    return false;
+  }
+  for(int output = 0; output < _outputs; ++output) {
+    if(!_output_buffer[output].empty()) {
+      return false;
+    }
+  }
+  for(int input = 0; input < _inputs; ++input) {
+    if(!_credit_buffer[input].empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void IQRouter::SkipCycles( int cycles )
+{
+  // replay the bookkeeping Evaluate() does for an inactive router
+  if((_internal_speedup == 1.0) && (_partial_internal_cycles == 0.0)) {
+    _cycles += cycles;
+    return;
+  }
+  for(int c = 0; c < cycles; ++c) {
+    _partial_internal_cycles += _internal_speedup;
+    while( _partial_internal_cycles >= 1.0 ) {
+      _cycles++;
+      _partial_internal_cycles -= 1.0;
+    }
+  }
+}
+
 
 //------------------------------------------------------------------------------
 // read inputs
@@ -162,6 +162,9 @@ public:
 
   virtual void ReadInputs( );
   virtual void WriteOutputs( );
+
+  virtual bool IsIdle( ) const;
+  virtual void SkipCycles( int cycles );
   
   void Display( ostream & os = cout ) const;
 
@@ -93,6 +93,7 @@ void Router::AddInputChannel( FlitChannel *channel, CreditChannel *backchannel,
 {
   _input_channels.push_back( channel );
   _input_credits.push_back( backchannel );
+  channel->AddSinkModule( this );
 
   if ( isVertical  ) //jgardea
   {
@@ -109,6 +110,7 @@ void Router::AddOutputChannel( FlitChannel *channel, CreditChannel *backchannel,
 {
   _output_channels.push_back( channel );
   _output_credits.push_back( backchannel );
+  backchannel->AddSinkModule( this );
 
   if ( isVertical ) //jgardea
   {
@@ -28,17 +28,69 @@
 #ifndef _TIMED_MODULE_HPP_
 #define _TIMED_MODULE_HPP_
 
+#include <vector>
+
 #include "module.hpp"
 
+// Timed modules that received new work (a flit or credit) since the owning
+// network last rebuilt its list of modules to step; see Network::ReadInputs.
+class ModuleWorklist {
+
+public:
+  void Resize(int modules) { _pending_flag.assign(modules, false); }
+
+  inline void Activate(int id) {
+    if(!_pending_flag[id]) {
+      _pending_flag[id] = true;
+      _pending.push_back(id);
+    }
+  }
+  inline bool IsPending(int id) const { return _pending_flag[id]; }
+  inline vector<int> const & Pending() const { return _pending; }
+
+  void Clear() {
+    for(size_t i = 0; i < _pending.size(); ++i) {
+      _pending_flag[_pending[i]] = false;
+    }
+    _pending.clear();
+  }
+
+private:
+  vector<int> _pending;
+  vector<bool> _pending_flag;
+};
+
 class TimedModule : public Module {
 
 public:
-  TimedModule(Module * parent, string const & name) : Module(parent, name) {}
+  TimedModule(Module * parent, string const & name)
+    : Module(parent, name), _worklist(0), _worklist_id(-1) {}
   virtual ~TimedModule() {}
   
   virtual void ReadInputs() = 0;
   virtual void Evaluate() = 0;
   virtual void WriteOutputs() = 0;
+
+  // An idle module has no buffered work: all three phases are no-ops until
+  // it is activated again, so the network may stop stepping it.
+  virtual bool IsIdle() const { return false; }
+  // Accounts for cycles the module spent off the worklist.
+  virtual void SkipCycles(int cycles) {}
+
+  void SetWorklist(ModuleWorklist * worklist, int id) {
+    _worklist = worklist;
+    _worklist_id = id;
+  }
+  inline int GetWorklistId() const { return _worklist_id; }
+  inline void Activate() {
+    if(_worklist) {
+      _worklist->Activate(_worklist_id);
+    }
+  }
+
+private:
+  ModuleWorklist * _worklist;
+  int _worklist_id;
 };
 
 #endif
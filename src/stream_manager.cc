@@ -154,7 +154,16 @@ void stream_operation::do_operation( gpgpu_sim *gpu )
         if( gpu->can_start_kernel() ) {
         	gpu->set_cache_config(m_kernel->name());
         	//printf("kernel \'%s\' transfer to GPU hardware scheduler\n", m_kernel->name().c_str() ); // jgardea
-            if( m_sim_mode )
+            if( gpu->resume_skips_kernel(*m_kernel) ) {
+                // its effect on memory is part of the checkpoint restored later
+                printf("GPGPU-Sim: skipping kernel %u \'%s\' (-resume_kernel)\n", m_kernel->get_uid(), m_kernel->name().c_str() );
+                gpu->mark_skipped_kernel(m_kernel->get_uid());
+                extern stream_manager *g_stream_manager;
+                g_stream_manager->register_finished_kernel(m_kernel->get_uid());
+                break;
+            }
+            gpu->checkpoint_kernel_launch(*m_kernel);
+            if( m_sim_mode || gpu->fast_forward_kernel(*m_kernel) )
                 gpgpu_cuda_ptx_sim_main_func( *m_kernel );
             else
                 gpu->launch( m_kernel );